@@ -7,6 +7,8 @@
 #include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
 #include "Bots/ShooterBot.h"
 #include "Bots/ShooterAIController.h"
+#include "Bots/ShooterBotBrain.h"
+#include "Bots/ShooterBotPerception.h"
 #include "Online/ShooterPlayerState.h"
 
 UBTDecorator_HasLoSTo::UBTDecorator_HasLoSTo(const FObjectInitializer& ObjectInitializer)
@@ -60,6 +62,8 @@ bool UBTDecorator_HasLoSTo::CalculateRawConditionValue(class UBehaviorTreeCompon
 
 bool UBTDecorator_HasLoSTo::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
 {
+	SCOPE_CYCLE_COUNTER(STAT_ShooterBots_TreeDecisions);
+
 	const UBlackboardComponent* MyBlackboard = OwnerComp.GetBlackboardComponent();
 	AAIController* MyController = OwnerComp.GetAIOwner();
 	bool HasLOS = false;
@@ -105,6 +109,14 @@ bool UBTDecorator_HasLoSTo::LOSTrace(AActor* InActor, AActor* InEnemyActor, cons
 	AShooterAIController* MyController = Cast<AShooterAIController>(InActor);
 	AShooterBot* MyBot = MyController ? Cast<AShooterBot>(MyController->GetPawn()) : NULL; 
 
+	// Pawn targets share traces with other bots, see UShooterBotPerception
+	const APawn* EnemyPawn = Cast<APawn>(InEnemyActor);
+	UShooterBotPerception* Perception = UShooterBotPerception::Get(GetWorld());
+	if (MyBot && EnemyPawn && Perception)
+	{
+		return Perception->HasLineOfSight(MyBot, EnemyPawn, true);
+	}
+
 	bool bHasLOS = false;
 	{
 		if (MyBot != NULL)
@@ -7,10 +7,14 @@
 #include "BehaviorTree/Blackboard/BlackboardKeyAllTypes.h"
 #include "Bots/ShooterAIController.h"
 #include "Bots/ShooterBot.h"
+#include "Bots/ShooterBotNavQueries.h"
 #include "Pickups/ShooterPickup_Ammo.h"
+#include "Pickups/ShooterPickupRegistry.h"
 #include "Weapons/ShooterWeapon_Instant.h"
+#include "ShooterDeterministicMode.h"
+#include "NavigationSystem.h"
 
-UBTTask_FindPickup::UBTTask_FindPickup(const FObjectInitializer& ObjectInitializer) 
+UBTTask_FindPickup::UBTTask_FindPickup(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 }
@@ -24,35 +28,122 @@ EBTNodeResult::Type UBTTask_FindPickup::ExecuteTask(UBehaviorTreeComponent& Owne
 		return EBTNodeResult::Failed;
 	}
 
-	AShooterGameMode* GameMode = MyBot->GetWorld()->GetAuthGameMode<AShooterGameMode>();
-	if (GameMode == NULL)
+	const UShooterPickupRegistry* Registry = UShooterPickupRegistry::Get(MyBot->GetWorld());
+	if (Registry == NULL)
 	{
 		return EBTNodeResult::Failed;
 	}
 
-	const FVector MyLoc = MyBot->GetActorLocation();
-	AShooterPickup_Ammo* BestPickup = NULL;
-	float BestDistSq = MAX_FLT;
+	AShooterPickup_Ammo* BestPickup = Registry->FindNearestAvailable<AShooterPickup_Ammo>(MyBot->GetActorLocation(), [MyBot](AShooterPickup_Ammo* AmmoPickup)
+	{
+		return AmmoPickup->IsForWeapon(AShooterWeapon_Instant::StaticClass()) && AmmoPickup->CanBePickedUp(MyBot);
+	});
 
-	for (int32 i = 0; i < GameMode->LevelPickups.Num(); ++i)
+	if (BestPickup == NULL)
 	{
-		AShooterPickup_Ammo* AmmoPickup = Cast<AShooterPickup_Ammo>(GameMode->LevelPickups[i]);
-		if (AmmoPickup && AmmoPickup->IsForWeapon(AShooterWeapon_Instant::StaticClass()) && AmmoPickup->CanBePickedUp(MyBot))
-		{
-			const float DistSq = (AmmoPickup->GetActorLocation() - MyLoc).SizeSquared();
-			if (BestDistSq == -1 || DistSq < BestDistSq)
-			{
-				BestDistSq = DistSq;
-				BestPickup = AmmoPickup;
-			}
-		}
+		return EBTNodeResult::Failed;
 	}
 
-	if (BestPickup)
+	UShooterBotNavQueries* NavQueries = UShooterBotNavQueries::Get(MyBot->GetWorld());
+	if (NavQueries == NULL)
 	{
 		OwnerComp.GetBlackboardComponent()->SetValue<UBlackboardKeyType_Vector>(BlackboardKey.GetSelectedKeyID(), BestPickup->GetActorLocation());
 		return EBTNodeResult::Succeeded;
 	}
 
-	return EBTNodeResult::Failed;
+	// only go for it if there's a path, asked when the budget allows
+	FShooterNavQueryTaskMemory* Memory = reinterpret_cast<FShooterNavQueryTaskMemory*>(NodeMemory);
+	Memory->Goal = BestPickup->GetActorLocation();
+	Memory->PathQueryId = 0;
+	Memory->QueryId = NavQueries->QueueQuery([this, WeakOwnerComp = TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp)](uint32 QueryId)
+	{
+		RequestPath(WeakOwnerComp, QueryId);
+	});
+
+	return EBTNodeResult::InProgress;
+}
+
+EBTNodeResult::Type UBTTask_FindPickup::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FShooterNavQueryTaskMemory* Memory = reinterpret_cast<FShooterNavQueryTaskMemory*>(NodeMemory);
+	UShooterBotNavQueries* NavQueries = UShooterBotNavQueries::Get(OwnerComp.GetWorld());
+	if (NavQueries && Memory->QueryId)
+	{
+		NavQueries->CancelQuery(Memory->QueryId);
+	}
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(OwnerComp.GetWorld());
+	if (NavSys && Memory->PathQueryId)
+	{
+		NavSys->AbortAsyncFindPathRequest(Memory->PathQueryId);
+	}
+
+	Memory->QueryId = 0;
+	Memory->PathQueryId = 0;
+
+	return EBTNodeResult::Aborted;
+}
+
+uint16 UBTTask_FindPickup::GetInstanceMemorySize() const
+{
+	return sizeof(FShooterNavQueryTaskMemory);
+}
+
+void UBTTask_FindPickup::RequestPath(TWeakObjectPtr<UBehaviorTreeComponent> WeakOwnerComp, uint32 QueryId)
+{
+	UBehaviorTreeComponent* OwnerComp = WeakOwnerComp.Get();
+	FShooterNavQueryTaskMemory* Memory = OwnerComp ? UShooterBotNavQueries::GetTaskMemory(*OwnerComp, this, QueryId) : NULL;
+	if (Memory == NULL)
+	{
+		return;
+	}
+
+	AAIController* MyController = OwnerComp->GetAIOwner();
+	APawn* MyBot = MyController ? MyController->GetPawn() : NULL;
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(OwnerComp->GetWorld());
+	const ANavigationData* NavData = (NavSys && MyController) ? NavSys->GetNavDataForProps(MyController->GetNavAgentPropertiesRef()) : NULL;
+	if (MyBot == NULL || NavData == NULL)
+	{
+		Memory->QueryId = 0;
+		FinishLatentTask(*OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	// a partial path still gets the bot closer, only a pickup it can't path toward at all is skipped
+	FPathFindingQuery Query(MyController, *NavData, MyBot->GetNavAgentLocation(), Memory->Goal);
+	Query.SetAllowPartialPaths(true);
+
+	// async results land on a frame that depends on worker thread timing
+	if (FShooterDeterministicMode::IsEnabled())
+	{
+		const FPathFindingResult PathResult = NavSys->FindPathSync(MyController->GetNavAgentPropertiesRef(), Query);
+		OnPathFound(0, PathResult.Result, PathResult.Path, WeakOwnerComp, QueryId);
+		return;
+	}
+
+	Memory->PathQueryId = NavSys->FindPathAsync(MyController->GetNavAgentPropertiesRef(), Query,
+		FNavPathQueryDelegate::CreateUObject(this, &UBTTask_FindPickup::OnPathFound, WeakOwnerComp, QueryId));
+}
+
+void UBTTask_FindPickup::OnPathFound(uint32 PathQueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path, TWeakObjectPtr<UBehaviorTreeComponent> WeakOwnerComp, uint32 QueryId)
+{
+	UBehaviorTreeComponent* OwnerComp = WeakOwnerComp.Get();
+	FShooterNavQueryTaskMemory* Memory = OwnerComp ? UShooterBotNavQueries::GetTaskMemory(*OwnerComp, this, QueryId) : NULL;
+	if (Memory == NULL || Memory->PathQueryId != PathQueryId)
+	{
+		return;
+	}
+
+	Memory->QueryId = 0;
+	Memory->PathQueryId = 0;
+
+	if (Result == ENavigationQueryResult::Success && Path.IsValid())
+	{
+		OwnerComp->GetBlackboardComponent()->SetValue<UBlackboardKeyType_Vector>(BlackboardKey.GetSelectedKeyID(), Memory->Goal);
+		FinishLatentTask(*OwnerComp, EBTNodeResult::Succeeded);
+	}
+	else
+	{
+		FinishLatentTask(*OwnerComp, EBTNodeResult::Failed);
+	}
 }
@@ -3,13 +3,14 @@
 #include "ShooterGame.h"
 #include "Bots/BTTask_FindPointNearEnemy.h"
 #include "Bots/ShooterAIController.h"
+#include "Bots/ShooterBotNavQueries.h"
 #include "BehaviorTree/BehaviorTreeComponent.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "BehaviorTree/Blackboard/BlackboardKeyAllTypes.h"
 #include "NavigationSystem.h"
 
 
-UBTTask_FindPointNearEnemy::UBTTask_FindPointNearEnemy(const FObjectInitializer& ObjectInitializer) 
+UBTTask_FindPointNearEnemy::UBTTask_FindPointNearEnemy(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 }
@@ -17,13 +18,57 @@ UBTTask_FindPointNearEnemy::UBTTask_FindPointNearEnemy(const FObjectInitializer&
 EBTNodeResult::Type UBTTask_FindPointNearEnemy::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
 	AShooterAIController* MyController = Cast<AShooterAIController>(OwnerComp.GetAIOwner());
-	if (MyController == NULL)
+	if (MyController == NULL || MyController->GetPawn() == NULL || MyController->GetEnemy() == NULL)
 	{
 		return EBTNodeResult::Failed;
 	}
-	
-	APawn* MyBot = MyController->GetPawn();
-	AShooterCharacter* Enemy = MyController->GetEnemy();
+
+	UShooterBotNavQueries* NavQueries = UShooterBotNavQueries::Get(OwnerComp.GetWorld());
+	if (NavQueries == NULL)
+	{
+		return FindPointNearEnemy(OwnerComp) ? EBTNodeResult::Succeeded : EBTNodeResult::Failed;
+	}
+
+	// wait for our turn, the enemy is looked up again then
+	FShooterNavQueryTaskMemory* Memory = reinterpret_cast<FShooterNavQueryTaskMemory*>(NodeMemory);
+	Memory->PathQueryId = 0;
+	Memory->QueryId = NavQueries->QueueQuery([this, WeakOwnerComp = TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp)](uint32 QueryId)
+	{
+		UBehaviorTreeComponent* QueryOwnerComp = WeakOwnerComp.Get();
+		FShooterNavQueryTaskMemory* QueryMemory = QueryOwnerComp ? UShooterBotNavQueries::GetTaskMemory(*QueryOwnerComp, this, QueryId) : NULL;
+		if (QueryMemory)
+		{
+			QueryMemory->QueryId = 0;
+			FinishLatentTask(*QueryOwnerComp, FindPointNearEnemy(*QueryOwnerComp) ? EBTNodeResult::Succeeded : EBTNodeResult::Failed);
+		}
+	});
+
+	return EBTNodeResult::InProgress;
+}
+
+EBTNodeResult::Type UBTTask_FindPointNearEnemy::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FShooterNavQueryTaskMemory* Memory = reinterpret_cast<FShooterNavQueryTaskMemory*>(NodeMemory);
+	UShooterBotNavQueries* NavQueries = UShooterBotNavQueries::Get(OwnerComp.GetWorld());
+	if (NavQueries && Memory->QueryId)
+	{
+		NavQueries->CancelQuery(Memory->QueryId);
+	}
+	Memory->QueryId = 0;
+
+	return EBTNodeResult::Aborted;
+}
+
+uint16 UBTTask_FindPointNearEnemy::GetInstanceMemorySize() const
+{
+	return sizeof(FShooterNavQueryTaskMemory);
+}
+
+bool UBTTask_FindPointNearEnemy::FindPointNearEnemy(UBehaviorTreeComponent& OwnerComp) const
+{
+	AShooterAIController* MyController = Cast<AShooterAIController>(OwnerComp.GetAIOwner());
+	APawn* MyBot = MyController ? MyController->GetPawn() : NULL;
+	AShooterCharacter* Enemy = MyController ? MyController->GetEnemy() : NULL;
 	if (Enemy && MyBot)
 	{
 		const float SearchRadius = 200.0f;
@@ -33,9 +78,9 @@ EBTNodeResult::Type UBTTask_FindPointNearEnemy::ExecuteTask(UBehaviorTreeCompone
 		if (Loc != FVector::ZeroVector)
 		{
 			OwnerComp.GetBlackboardComponent()->SetValue<UBlackboardKeyType_Vector>(BlackboardKey.GetSelectedKeyID(), Loc);
-			return EBTNodeResult::Succeeded;
+			return true;
 		}
 	}
 
-	return EBTNodeResult::Failed;
+	return false;
 }
@@ -3,7 +3,10 @@
 #include "ShooterGame.h"
 #include "Bots/ShooterAIController.h"
 #include "Bots/ShooterBot.h"
+#include "Bots/ShooterBotBrain.h"
+#include "Bots/ShooterBotPerception.h"
 #include "Online/ShooterPlayerState.h"
+#include "Player/ShooterPawnSpatialIndex.h"
 #include "BehaviorTree/BehaviorTree.h"
 #include "BehaviorTree/BehaviorTreeComponent.h"
 #include "BehaviorTree/BlackboardComponent.h"
@@ -11,6 +14,12 @@
 #include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
 #include "Weapons/ShooterWeapon.h"
 
+namespace ShooterAIController
+{
+	/** Nearest enemies checked for LOS when looking for a new enemy, same as the bot brain */
+	static const int32 MaxEnemyCandidates = 4;
+}
+
 AShooterAIController::AShooterAIController(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
  	BlackboardComp = ObjectInitializer.CreateDefaultSubobject<UBlackboardComponent>(this, TEXT("BlackBoardComp"));
@@ -18,6 +27,7 @@ AShooterAIController::AShooterAIController(const FObjectInitializer& ObjectIniti
 	BrainComponent = BehaviorComp = ObjectInitializer.CreateDefaultSubobject<UBehaviorTreeComponent>(this, TEXT("BehaviorComp"));	
 
 	bWantsPlayerState = true;
+	bBrainEnemyVisible = false;
 }
 
 void AShooterAIController::OnPossess(APawn* InPawn)
@@ -66,65 +76,65 @@ void AShooterAIController::Respawn()
 
 void AShooterAIController::FindClosestEnemy()
 {
-	APawn* MyBot = GetPawn();
-	if (MyBot == NULL)
+	// Targets come from the batched brain when it's enabled
+	if (UShooterBotBrain::Get(GetWorld()))
 	{
 		return;
 	}
 
-	const FVector MyLoc = MyBot->GetActorLocation();
-	float BestDistSq = MAX_FLT;
-	AShooterCharacter* BestPawn = NULL;
+	SCOPE_CYCLE_COUNTER(STAT_ShooterBots_TreeDecisions);
 
-	for (AShooterCharacter* TestPawn : TActorRange<AShooterCharacter>(GetWorld()))
+	APawn* MyBot = GetPawn();
+	const UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(GetWorld());
+	if (MyBot == NULL || PawnIndex == NULL)
 	{
-		if (TestPawn->IsAlive() && TestPawn->IsEnemyFor(this))
-		{
-			const float DistSq = (TestPawn->GetActorLocation() - MyLoc).SizeSquared();
-			if (DistSq < BestDistSq)
-			{
-				BestDistSq = DistSq;
-				BestPawn = TestPawn;
-			}
-		}
+		return;
 	}
 
-	if (BestPawn)
+	// The team filter already rules out teammates, the rest are checked for enemies closest first
+	TArray<APawn*> Candidates;
+	PawnIndex->FindNearestPawns(MyBot->GetActorLocation(), 4, FShooterPawnQueryFilter::MakeEnemyFilter(this), Candidates);
+
+	for (APawn* Candidate : Candidates)
 	{
-		SetEnemy(BestPawn);
+		AShooterCharacter* TestPawn = CastChecked<AShooterCharacter>(Candidate);
+		if (TestPawn->IsEnemyFor(this))
+		{
+			SetEnemy(TestPawn);
+			break;
+		}
 	}
 }
 
 bool AShooterAIController::FindClosestEnemyWithLOS(AShooterCharacter* ExcludeEnemy)
 {
+	if (UShooterBotBrain::Get(GetWorld()))
+	{
+		const AShooterCharacter* Enemy = GetEnemy();
+		return Enemy && Enemy != ExcludeEnemy && bBrainEnemyVisible;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterBots_TreeDecisions);
+
 	bool bGotEnemy = false;
 	APawn* MyBot = GetPawn();
-	if (MyBot != NULL)
+	const UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(GetWorld());
+	if (MyBot != NULL && PawnIndex != NULL)
 	{
-		const FVector MyLoc = MyBot->GetActorLocation();
-		float BestDistSq = MAX_FLT;
-		AShooterCharacter* BestPawn = NULL;
+		// Closest first, so the first enemy in sight is the one and the rest don't need LOS traces
+		TArray<APawn*> Candidates;
+		PawnIndex->FindNearestPawns(MyBot->GetActorLocation(), ShooterAIController::MaxEnemyCandidates, FShooterPawnQueryFilter::MakeEnemyFilter(this), Candidates);
 
-		for (AShooterCharacter* TestPawn : TActorRange<AShooterCharacter>(GetWorld()))
+		for (APawn* Candidate : Candidates)
 		{
-			if (TestPawn != ExcludeEnemy && TestPawn->IsAlive() && TestPawn->IsEnemyFor(this))
+			AShooterCharacter* TestPawn = CastChecked<AShooterCharacter>(Candidate);
+			if (TestPawn != ExcludeEnemy && TestPawn->IsEnemyFor(this) && HasWeaponLOSToEnemy(TestPawn, true) == true)
 			{
-				if (HasWeaponLOSToEnemy(TestPawn, true) == true)
-				{
-					const float DistSq = (TestPawn->GetActorLocation() - MyLoc).SizeSquared();
-					if (DistSq < BestDistSq)
-					{
-						BestDistSq = DistSq;
-						BestPawn = TestPawn;
-					}
-				}
+				SetEnemy(TestPawn);
+				bGotEnemy = true;
+				break;
 			}
 		}
-		if (BestPawn)
-		{
-			SetEnemy(BestPawn);
-			bGotEnemy = true;
-		}
 	}
 	return bGotEnemy;
 }
@@ -134,6 +144,14 @@ bool AShooterAIController::HasWeaponLOSToEnemy(AActor* InEnemyActor, const bool
 	
 	AShooterBot* MyBot = Cast<AShooterBot>(GetPawn());
 
+	// Pawn targets share traces with other bots, see UShooterBotPerception
+	const APawn* EnemyPawn = Cast<APawn>(InEnemyActor);
+	UShooterBotPerception* Perception = UShooterBotPerception::Get(GetWorld());
+	if (MyBot && EnemyPawn && Perception)
+	{
+		return Perception->HasLineOfSight(MyBot, EnemyPawn, bAnyEnemy);
+	}
+
 	bool bHasLOS = false;
 	// Perform trace to retrieve hit info
 	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(AIWeaponLosTrace), true, GetPawn());
@@ -182,6 +200,14 @@ bool AShooterAIController::HasWeaponLOSToEnemy(AActor* InEnemyActor, const bool
 
 void AShooterAIController::ShootEnemy()
 {
+	// Firing is decided by the batched brain when it's enabled
+	if (UShooterBotBrain::Get(GetWorld()))
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterBots_TreeDecisions);
+
 	AShooterBot* MyBot = Cast<AShooterBot>(GetPawn());
 	AShooterWeapon* MyWeapon = MyBot ? MyBot->GetWeapon() : NULL;
 	if (MyWeapon == NULL)
@@ -193,7 +219,8 @@ void AShooterAIController::ShootEnemy()
 	AShooterCharacter* Enemy = GetEnemy();
 	if ( Enemy && ( Enemy->IsAlive() )&& (MyWeapon->GetCurrentAmmo() > 0) && ( MyWeapon->CanFire() == true ) )
 	{
-		if (LineOfSightTo(Enemy, MyBot->GetActorLocation()))
+		UShooterBotPerception* Perception = UShooterBotPerception::Get(GetWorld());
+		if (Perception ? Perception->HasLineOfSight(MyBot, Enemy, true) : LineOfSightTo(Enemy, MyBot->GetActorLocation()))
 		{
 			bCanShoot = true;
 		}
@@ -209,6 +236,34 @@ void AShooterAIController::ShootEnemy()
 	}
 }
 
+void AShooterAIController::ApplyBrainDecision(AShooterCharacter* InEnemy, bool bInEnemyVisible, bool bFire, bool bNeedAmmo)
+{
+	if (InEnemy != GetEnemy())
+	{
+		SetEnemy(InEnemy);
+	}
+
+	bBrainEnemyVisible = bInEnemyVisible;
+
+	if (BlackboardComp)
+	{
+		BlackboardComp->SetValue<UBlackboardKeyType_Bool>(NeedAmmoKeyID, bNeedAmmo);
+	}
+
+	AShooterBot* MyBot = Cast<AShooterBot>(GetPawn());
+	if (MyBot)
+	{
+		if (bFire)
+		{
+			MyBot->StartWeaponFire();
+		}
+		else
+		{
+			MyBot->StopWeaponFire();
+		}
+	}
+}
+
 void AShooterAIController::CheckAmmo(const class AShooterWeapon* CurrentWeapon)
 {
 	if (CurrentWeapon && BlackboardComp)
@@ -0,0 +1,210 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Bots/ShooterBotBrain.h"
+#include "Bots/ShooterAIController.h"
+#include "Bots/ShooterBot.h"
+#include "Bots/ShooterBotPerception.h"
+#include "Player/ShooterPawnSpatialIndex.h"
+#include "Weapons/ShooterWeapon.h"
+#include "Async/ParallelFor.h"
+
+DEFINE_STAT(STAT_ShooterBots_BrainThink);
+DEFINE_STAT(STAT_ShooterBots_TreeDecisions);
+DEFINE_STAT(STAT_ShooterBots_NumThinking);
+
+static int32 ShooterBatchedBotBrain = 0;
+FAutoConsoleVariableRef CVarShooterBatchedBotBrain(
+	TEXT("ShooterGame.BatchedBotBrain"),
+	ShooterBatchedBotBrain,
+	TEXT("Decide bot targets, aim and firing for all bots in one batched pass instead of per bot in the behavior tree.\n")
+	TEXT("0: Disable (behavior tree), 1: Enable"),
+	ECVF_Default);
+
+static float ShooterBotBrainInterval = 0.1f;
+FAutoConsoleVariableRef CVarShooterBotBrainInterval(
+	TEXT("ShooterGame.BotBrainInterval"),
+	ShooterBotBrainInterval,
+	TEXT("Seconds between batched bot decision passes"),
+	ECVF_Default);
+
+static float ShooterBotBrainFireAngle = 20.f;
+FAutoConsoleVariableRef CVarShooterBotBrainFireAngle(
+	TEXT("ShooterGame.BotBrainFireAngle"),
+	ShooterBotBrainFireAngle,
+	TEXT("Degrees a bot's aim can be off its enemy and still fire"),
+	ECVF_Default);
+
+namespace ShooterBotBrain
+{
+	/** Nearest enemies considered per bot */
+	static const int32 MaxCandidates = 4;
+
+	/** Bots decided on one thread below this */
+	static const int32 MinParallelBots = 16;
+
+	/** Same threshold as AShooterAIController::CheckAmmo */
+	static const float NeedAmmoRatio = 0.1f;
+}
+
+void UShooterBotBrain::FBotBatch::Reset()
+{
+	Controllers.Reset();
+	EyeLocations.Reset();
+	AimDirections.Reset();
+	CurrentEnemies.Reset();
+	WeaponReady.Reset();
+	AmmoRatios.Reset();
+	FirstCandidates.Reset();
+	NumCandidates.Reset();
+	Candidates.Reset();
+	Decisions.Reset();
+}
+
+void UShooterBotBrain::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TimeUntilThink = 0.f;
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UShooterBotBrain::OnWorldPostActorTick);
+}
+
+void UShooterBotBrain::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	Batch.Reset();
+
+	Super::Deinitialize();
+}
+
+UShooterBotBrain* UShooterBotBrain::Get(const UWorld* World)
+{
+	return (World && ShooterBatchedBotBrain) ? World->GetSubsystem<UShooterBotBrain>() : nullptr;
+}
+
+void UShooterBotBrain::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || !ShooterBatchedBotBrain || TickType == LEVELTICK_TimeOnly || World->IsPaused())
+	{
+		return;
+	}
+
+	TimeUntilThink -= DeltaSeconds;
+	if (TimeUntilThink <= 0.f)
+	{
+		// don't try to catch up after a hitch
+		TimeUntilThink = FMath::Max(TimeUntilThink + ShooterBotBrainInterval, 0.f);
+		Think(World);
+	}
+}
+
+void UShooterBotBrain::Think(UWorld* World)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterBots_BrainThink);
+
+	const UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(World);
+	UShooterBotPerception* Perception = UShooterBotPerception::Get(World);
+	if (PawnIndex == nullptr)
+	{
+		return;
+	}
+
+	Batch.Reset();
+
+	// Gather on the game thread, this touches actors and the shared line of sight cache
+	TArray<APawn*> NearbyEnemies;
+	for (FConstControllerIterator It = World->GetControllerIterator(); It; ++It)
+	{
+		AShooterAIController* Controller = Cast<AShooterAIController>(It->Get());
+		AShooterBot* Bot = Controller ? Cast<AShooterBot>(Controller->GetPawn()) : nullptr;
+		if (Bot == nullptr || !Bot->IsAlive())
+		{
+			continue;
+		}
+
+		const AShooterWeapon* Weapon = Bot->GetWeapon();
+		Batch.Controllers.Add(Controller);
+		Batch.EyeLocations.Add(Bot->GetPawnViewLocation());
+		Batch.AimDirections.Add(Controller->GetControlRotation().Vector());
+		Batch.CurrentEnemies.Add(Controller->GetEnemy());
+		Batch.WeaponReady.Add(Weapon && Weapon->GetCurrentAmmo() > 0 && Weapon->CanFire());
+		Batch.AmmoRatios.Add((Weapon && Weapon->GetMaxAmmo() > 0) ? (float)Weapon->GetCurrentAmmo() / (float)Weapon->GetMaxAmmo() : 1.f);
+		Batch.FirstCandidates.Add(Batch.Candidates.Num());
+
+		PawnIndex->FindNearestPawns(Bot->GetActorLocation(), ShooterBotBrain::MaxCandidates, FShooterPawnQueryFilter::MakeEnemyFilter(Controller), NearbyEnemies);
+		for (APawn* NearbyEnemy : NearbyEnemies)
+		{
+			AShooterCharacter* Enemy = CastChecked<AShooterCharacter>(NearbyEnemy);
+			if (Enemy->IsEnemyFor(Controller))
+			{
+				FCandidate& Candidate = Batch.Candidates.AddDefaulted_GetRef();
+				Candidate.Pawn = Enemy;
+				Candidate.Location = Enemy->GetActorLocation();
+				Candidate.bVisible = Perception ? Perception->HasLineOfSight(Bot, Enemy, true) : Controller->HasWeaponLOSToEnemy(Enemy, true);
+			}
+		}
+
+		Batch.NumCandidates.Add(Batch.Candidates.Num() - Batch.FirstCandidates.Last());
+	}
+
+	const int32 NumBots = Batch.Controllers.Num();
+	SET_DWORD_STAT(STAT_ShooterBots_NumThinking, NumBots);
+
+	Batch.Decisions.SetNum(NumBots);
+	ParallelFor(NumBots, [this](int32 BotIdx)
+	{
+		Decide(BotIdx);
+	}, NumBots < ShooterBotBrain::MinParallelBots);
+
+	for (int32 BotIdx = 0; BotIdx < NumBots; BotIdx++)
+	{
+		AShooterAIController* Controller = Batch.Controllers[BotIdx].Get();
+		if (Controller)
+		{
+			const FDecision& Decision = Batch.Decisions[BotIdx];
+			Controller->ApplyBrainDecision(Decision.Enemy, Decision.bEnemyVisible, Decision.bFire, Decision.bNeedAmmo);
+		}
+	}
+}
+
+void UShooterBotBrain::Decide(int32 BotIdx)
+{
+	const int32 FirstCandidate = Batch.FirstCandidates[BotIdx];
+	const int32 LastCandidate = FirstCandidate + Batch.NumCandidates[BotIdx];
+
+	// Keep the current enemy while it's in sight, else take the closest one in sight, else hunt the closest one
+	int32 Chosen = INDEX_NONE;
+	for (int32 Idx = FirstCandidate; Idx < LastCandidate && Chosen == INDEX_NONE; Idx++)
+	{
+		if (Batch.Candidates[Idx].bVisible && Batch.Candidates[Idx].Pawn == Batch.CurrentEnemies[BotIdx])
+		{
+			Chosen = Idx;
+		}
+	}
+	for (int32 Idx = FirstCandidate; Idx < LastCandidate && Chosen == INDEX_NONE; Idx++)
+	{
+		if (Batch.Candidates[Idx].bVisible)
+		{
+			Chosen = Idx;
+		}
+	}
+	if (Chosen == INDEX_NONE && LastCandidate > FirstCandidate)
+	{
+		Chosen = FirstCandidate;
+	}
+
+	FDecision& Decision = Batch.Decisions[BotIdx];
+	Decision = FDecision();
+	Decision.bNeedAmmo = Batch.AmmoRatios[BotIdx] <= ShooterBotBrain::NeedAmmoRatio;
+
+	if (Chosen != INDEX_NONE)
+	{
+		const FCandidate& Candidate = Batch.Candidates[Chosen];
+		const FVector ToEnemy = (Candidate.Location - Batch.EyeLocations[BotIdx]).GetSafeNormal();
+		const bool bAimed = FVector::DotProduct(Batch.AimDirections[BotIdx], ToEnemy) >= FMath::Cos(FMath::DegreesToRadians(ShooterBotBrainFireAngle));
+
+		Decision.Enemy = Candidate.Pawn;
+		Decision.bEnemyVisible = Candidate.bVisible;
+		Decision.bFire = Candidate.bVisible && bAimed && Batch.WeaponReady[BotIdx];
+	}
+}
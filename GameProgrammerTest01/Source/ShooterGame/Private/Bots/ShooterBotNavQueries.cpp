@@ -0,0 +1,97 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Bots/ShooterBotNavQueries.h"
+#include "Bots/ShooterBotBrain.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queued nav queries"), STAT_ShooterBots_QueuedNavQueries, STATGROUP_ShooterBots);
+
+static int32 ShooterBotNavQueryBudget = 4;
+FAutoConsoleVariableRef CVarShooterBotNavQueryBudget(
+	TEXT("ShooterGame.BotNavQueryBudget"),
+	ShooterBotNavQueryBudget,
+	TEXT("Maximum number of bot navigation queries run per frame, the rest wait for later frames"),
+	ECVF_Default);
+
+void UShooterBotNavQueries::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	NextQueryId = 1;
+	PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &UShooterBotNavQueries::OnWorldPreActorTick);
+}
+
+void UShooterBotNavQueries::Deinitialize()
+{
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+	QueuedQueries.Empty();
+
+	Super::Deinitialize();
+}
+
+UShooterBotNavQueries* UShooterBotNavQueries::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UShooterBotNavQueries>() : nullptr;
+}
+
+uint32 UShooterBotNavQueries::QueueQuery(TFunction<void(uint32)>&& Query)
+{
+	const uint32 QueryId = NextQueryId++;
+	if (NextQueryId == 0)
+	{
+		// 0 means no query
+		NextQueryId = 1;
+	}
+
+	QueuedQueries.Emplace(QueryId, MoveTemp(Query));
+	return QueryId;
+}
+
+void UShooterBotNavQueries::CancelQuery(uint32 QueryId)
+{
+	const int32 Idx = QueuedQueries.IndexOfByPredicate([QueryId](const TPair<uint32, TFunction<void(uint32)>>& Queued) { return Queued.Key == QueryId; });
+	if (Idx != INDEX_NONE)
+	{
+		QueuedQueries.RemoveAt(Idx);
+	}
+}
+
+FShooterNavQueryTaskMemory* UShooterBotNavQueries::GetTaskMemory(UBehaviorTreeComponent& OwnerComp, const UBTTaskNode* Task, uint32 QueryId)
+{
+	if (OwnerComp.GetTaskStatus(Task) != EBTTaskStatus::Active)
+	{
+		return nullptr;
+	}
+
+	const int32 InstanceIdx = OwnerComp.FindInstanceContainingNode(Task);
+	FShooterNavQueryTaskMemory* Memory = InstanceIdx != INDEX_NONE ? reinterpret_cast<FShooterNavQueryTaskMemory*>(OwnerComp.GetNodeMemory(const_cast<UBTTaskNode*>(Task), InstanceIdx)) : nullptr;
+
+	// the task may have been aborted and run again since
+	return (Memory && Memory->QueryId == QueryId) ? Memory : nullptr;
+}
+
+void UShooterBotNavQueries::OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	SET_DWORD_STAT(STAT_ShooterBots_QueuedNavQueries, QueuedQueries.Num());
+
+	if (QueuedQueries.Num() == 0)
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_ShooterBotNavQueries_Run);
+
+	for (int32 NumRun = 0; NumRun < ShooterBotNavQueryBudget && QueuedQueries.Num() > 0; NumRun++)
+	{
+		// finishing a task can queue the next one's query
+		TPair<uint32, TFunction<void(uint32)>> Query = MoveTemp(QueuedQueries[0]);
+		QueuedQueries.RemoveAt(0, 1, false);
+		Query.Value(Query.Key);
+	}
+}
@@ -0,0 +1,226 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Bots/ShooterBotPerception.h"
+#include "Online/ShooterPlayerState.h"
+
+static int32 ShooterBotLOSCache = 1;
+FAutoConsoleVariableRef CVarShooterBotLOSCache(
+	TEXT("ShooterGame.BotLOSCache"),
+	ShooterBotLOSCache,
+	TEXT("Share bot line of sight checks through a per viewer and target cache refreshed with async traces.\n")
+	TEXT("0: Disable (every check traces), 1: Enable"),
+	ECVF_Default);
+
+static float ShooterBotLOSCacheTTL = 0.2f;
+FAutoConsoleVariableRef CVarShooterBotLOSCacheTTL(
+	TEXT("ShooterGame.BotLOSCacheTTL"),
+	ShooterBotLOSCacheTTL,
+	TEXT("Seconds a cached line of sight result is fresh for, older pairs get refreshed"),
+	ECVF_Default);
+
+static int32 ShooterBotLOSTraceBudget = 32;
+FAutoConsoleVariableRef CVarShooterBotLOSTraceBudget(
+	TEXT("ShooterGame.BotLOSTraceBudget"),
+	ShooterBotLOSTraceBudget,
+	TEXT("Maximum number of async line of sight refreshes issued per frame"),
+	ECVF_Default);
+
+static int32 ShooterBotLOSSyncTraceBudget = 8;
+FAutoConsoleVariableRef CVarShooterBotLOSSyncTraceBudget(
+	TEXT("ShooterGame.BotLOSSyncTraceBudget"),
+	ShooterBotLOSSyncTraceBudget,
+	TEXT("Maximum number of synchronous traces per frame for pairs not in the cache yet.\n")
+	TEXT("Pairs over it are reported not visible and traced with the async refreshes at the end of the frame"),
+	ECVF_Default);
+
+namespace ShooterBotPerception
+{
+	/** Pairs not asked about for this long are dropped */
+	static const float EvictAfterSeconds = 2.0f;
+}
+
+void UShooterBotPerception::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	NextTraceId = 0;
+	SyncTraceFrame = 0;
+	NumSyncTraces = 0;
+	TraceDelegate = FTraceDelegate::CreateUObject(this, &UShooterBotPerception::OnTraceDone);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UShooterBotPerception::OnWorldPostActorTick);
+}
+
+void UShooterBotPerception::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	Cache.Empty();
+	PendingTraces.Empty();
+
+	Super::Deinitialize();
+}
+
+UShooterBotPerception* UShooterBotPerception::Get(const UWorld* World)
+{
+	return (World && ShooterBotLOSCache) ? World->GetSubsystem<UShooterBotPerception>() : nullptr;
+}
+
+void UShooterBotPerception::GetTraceParams(const APawn* Viewer, const APawn* Target, FVector& OutStart, FVector& OutEnd, FCollisionQueryParams& OutParams) const
+{
+	OutStart = Viewer->GetPawnViewLocation();
+	OutEnd = Target->GetPawnViewLocation();
+
+	// the target isn't ignored, reaching it is what makes it visible
+	OutParams = FCollisionQueryParams(SCENE_QUERY_STAT(ShooterBotLOS), true, Viewer);
+}
+
+void UShooterBotPerception::SetTraceResult(FLineOfSight& Entry, const FHitResult* Hit)
+{
+	Entry.bBlockingHit = Hit && Hit->bBlockingHit;
+	Entry.HitActor = Entry.bBlockingHit ? Hit->GetActor() : nullptr;
+}
+
+bool UShooterBotPerception::IsVisible(const FLineOfSight& Entry, const APawn* Viewer, const APawn* Target, bool bAnyEnemy)
+{
+	const AActor* HitActor = Entry.HitActor.Get();
+	if (!Entry.bBlockingHit || HitActor == nullptr)
+	{
+		return false;
+	}
+
+	if (HitActor == Target)
+	{
+		return true;
+	}
+
+	// not our target, maybe it's still an enemy
+	const ACharacter* HitChar = bAnyEnemy ? Cast<ACharacter>(HitActor) : nullptr;
+	const AShooterPlayerState* HitPlayerState = HitChar ? HitChar->GetPlayerState<AShooterPlayerState>() : nullptr;
+	const AShooterPlayerState* MyPlayerState = Viewer->GetPlayerState<AShooterPlayerState>();
+	return HitPlayerState && MyPlayerState && HitPlayerState->GetTeamNum() != MyPlayerState->GetTeamNum();
+}
+
+bool UShooterBotPerception::HasLineOfSight(const APawn* Viewer, const APawn* Target, bool bAnyEnemy)
+{
+	if (Viewer == nullptr || Target == nullptr)
+	{
+		return false;
+	}
+
+	UWorld* World = GetWorld();
+	const float Now = World->GetTimeSeconds();
+	const FPairKey Key(FObjectKey(Viewer), FObjectKey(Target));
+
+	if (FLineOfSight* Found = Cache.Find(Key))
+	{
+		// served even when stale, the end of frame refresh picks it up
+		Found->RequestTime = Now;
+		return IsVisible(*Found, Viewer, Target, bAnyEnemy);
+	}
+
+	FLineOfSight& Entry = Cache.Add(Key);
+	Entry.Viewer = Viewer;
+	Entry.Target = Target;
+	Entry.RequestTime = Now;
+
+	if (SyncTraceFrame != GFrameCounter)
+	{
+		SyncTraceFrame = GFrameCounter;
+		NumSyncTraces = 0;
+	}
+
+	if (NumSyncTraces >= ShooterBotLOSSyncTraceBudget)
+	{
+		// out of sync traces this frame: not visible until the end of frame refresh, which takes it first
+		Entry.TraceTime = -MAX_flt;
+		return false;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_ShooterBotPerception_SyncTrace);
+
+	// first time this pair is asked about, nothing to serve yet
+	NumSyncTraces++;
+
+	FVector Start, End;
+	FCollisionQueryParams TraceParams;
+	GetTraceParams(Viewer, Target, Start, End, TraceParams);
+
+	FHitResult Hit(ForceInit);
+	World->LineTraceSingleByChannel(Hit, Start, End, COLLISION_WEAPON, TraceParams);
+
+	SetTraceResult(Entry, &Hit);
+	Entry.TraceTime = Now;
+
+	return IsVisible(Entry, Viewer, Target, bAnyEnemy);
+}
+
+void UShooterBotPerception::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || Cache.Num() == 0)
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_ShooterBotPerception_IssueRefreshes);
+
+	const float Now = World->GetTimeSeconds();
+
+	// Pairs asked about since they were last traced, and stale by now
+	TArray<TPair<float, FPairKey>> StalePairs;
+	for (auto It = Cache.CreateIterator(); It; ++It)
+	{
+		FLineOfSight& Entry = It.Value();
+		if (!Entry.Viewer.IsValid() || !Entry.Target.IsValid() || Now - Entry.RequestTime > ShooterBotPerception::EvictAfterSeconds)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		if (!Entry.bTracePending && Entry.RequestTime >= Entry.TraceTime && Now - Entry.TraceTime >= ShooterBotLOSCacheTTL)
+		{
+			StalePairs.Emplace(Entry.TraceTime, It.Key());
+		}
+	}
+
+	if (StalePairs.Num() > ShooterBotLOSTraceBudget)
+	{
+		StalePairs.Sort([](const TPair<float, FPairKey>& A, const TPair<float, FPairKey>& B) { return A.Key < B.Key; });
+		StalePairs.SetNum(FMath::Max(ShooterBotLOSTraceBudget, 0), false);
+	}
+
+	for (const TPair<float, FPairKey>& StalePair : StalePairs)
+	{
+		FLineOfSight& Entry = Cache.FindChecked(StalePair.Value);
+
+		FVector Start, End;
+		FCollisionQueryParams TraceParams;
+		GetTraceParams(Entry.Viewer.Get(), Entry.Target.Get(), Start, End, TraceParams);
+
+		const uint32 TraceId = NextTraceId++;
+		PendingTraces.Add(TraceId, StalePair.Value);
+		Entry.bTracePending = true;
+
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, COLLISION_WEAPON, TraceParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, TraceId);
+	}
+}
+
+void UShooterBotPerception::OnTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	FPairKey Key;
+	if (!PendingTraces.RemoveAndCopyValue(Datum.UserData, Key))
+	{
+		return;
+	}
+
+	FLineOfSight* Entry = Cache.Find(Key);
+	if (Entry == nullptr)
+	{
+		// evicted while in flight
+		return;
+	}
+
+	const UWorld* World = GetWorld();
+	Entry->bTracePending = false;
+	SetTraceResult(*Entry, Datum.OutHits.Num() > 0 ? &Datum.OutHits[0] : nullptr);
+	Entry->TraceTime = World ? World->GetTimeSeconds() : Entry->TraceTime;
+}
@@ -9,7 +9,10 @@
 #include "Online/ShooterPlayerState.h"
 #include "Online/ShooterGameSession.h"
 #include "Bots/ShooterAIController.h"
+#include "Player/ShooterPawnSpatialIndex.h"
 #include "ShooterTeamStart.h"
+#include "ShooterDeterministicMode.h"
+#include "ShooterStartupTimer.h"
 
 
 AShooterGameMode::AShooterGameMode(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
@@ -29,8 +32,16 @@ AShooterGameMode::AShooterGameMode(const FObjectInitializer& ObjectInitializer)
 
 	MinRespawnDelay = 5.0f;
 
+	SpawnSafeEnemyDistance = 3000.0f;
+	SpawnRecentDeathRadius = 1500.0f;
+	SpawnRecentDeathTime = 10.0f;
+	SpawnRecentDeathWeight = 0.5f;
+	SpawnRandomWeight = 0.25f;
+
 	bAllowBots = true;	
 	bNeedsBotCreation = true;
+	bWaitingForTravellingPlayers = false;
+	bSpawnPointsDirty = false;
 	bUseSeamlessTravel = FParse::Param(FCommandLine::Get(), TEXT("NoSeamlessTravel")) ? false : true;
 }
 
@@ -54,6 +65,11 @@ void AShooterGameMode::InitGame(const FString& MapName, const FString& Options,
 	SetAllowBots(BotsCountOptionValue > 0 ? true : false, BotsCountOptionValue);	
 	Super::InitGame(MapName, Options, ErrorMessage);
 
+	FShooterDeterministicMode::BeginMatch();
+	CacheSpawnPoints();
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &AShooterGameMode::OnLevelChanged);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &AShooterGameMode::OnLevelChanged);
+
 	const UGameInstance* GameInstance = GetGameInstance();
 	if (GameInstance && Cast<UShooterGameInstance>(GameInstance)->GetOnlineMode() != EOnlineMode::Offline)
 	{
@@ -61,6 +77,14 @@ void AShooterGameMode::InitGame(const FString& MapName, const FString& Options,
 	}
 }
 
+void AShooterGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AShooterGameMode::SetAllowBots(bool bInAllowBots, int32 InMaxBots)
 {
 	bAllowBots = bInAllowBots;
@@ -96,7 +120,7 @@ void AShooterGameMode::DefaultTimer()
 	AShooterGameState* const MyGameState = Cast<AShooterGameState>(GameState);
 	if (MyGameState && MyGameState->RemainingTime > 0 && !MyGameState->bTimerPaused)
 	{
-		MyGameState->RemainingTime--;
+		MyGameState->SetRemainingTime(MyGameState->RemainingTime - 1);
 		
 		if (MyGameState->RemainingTime <= 0)
 		{
@@ -149,11 +173,11 @@ void AShooterGameMode::HandleMatchIsWaitingToStart()
 			const bool bWantsMatchWarmup = !GetWorld()->IsPlayInEditor();
 			if (bWantsMatchWarmup && WarmupTime > 0)
 			{
-				MyGameState->RemainingTime = WarmupTime;
+				MyGameState->SetRemainingTime(WarmupTime);
 			}
 			else
 			{
-				MyGameState->RemainingTime = 0.0f;
+				MyGameState->SetRemainingTime(0);
 			}
 		}
 	}
@@ -165,7 +189,7 @@ void AShooterGameMode::HandleMatchHasStarted()
 	Super::HandleMatchHasStarted();
 
 	AShooterGameState* const MyGameState = Cast<AShooterGameState>(GameState);
-	MyGameState->RemainingTime = RoundTime;	
+	MyGameState->SetRemainingTime(RoundTime);	
 	StartBots();	
 
 	// notify players
@@ -210,7 +234,7 @@ void AShooterGameMode::FinishMatch()
 		}
 
 		// set up to restart the match
-		MyGameState->RemainingTime = TimeBetweenMatches;
+		MyGameState->SetRemainingTime(TimeBetweenMatches);
 	}
 }
 
@@ -313,6 +337,23 @@ void AShooterGameMode::Killed(AController* Killer, AController* KilledPlayer, AP
 		VictimPlayerState->ScoreDeath(KillerPlayerState, DeathScore);
 		VictimPlayerState->BroadcastDeath(KillerPlayerState, DamageType, VictimPlayerState);
 	}
+
+	FShooterDeterministicMode::LogKill(GetWorld(), KillerPlayerState, VictimPlayerState);
+
+	if (KilledPawn)
+	{
+		const float Now = GetWorld()->GetTimeSeconds();
+		int32 NumExpired = 0;
+		while (NumExpired < RecentDeaths.Num() && Now - RecentDeaths[NumExpired].Time > SpawnRecentDeathTime)
+		{
+			NumExpired++;
+		}
+		RecentDeaths.RemoveAt(0, NumExpired, false);
+
+		FRecentDeath& Death = RecentDeaths.AddDefaulted_GetRef();
+		Death.Location = KilledPawn->GetActorLocation();
+		Death.Time = Now;
+	}
 }
 
 float AShooterGameMode::ModifyDamage(float Damage, AActor* DamagedActor, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) const
@@ -384,108 +425,185 @@ void AShooterGameMode::RestartPlayer(AController* NewPlayer)
 	}
 }
 
-AActor* AShooterGameMode::ChoosePlayerStart_Implementation(AController* Player)
+void AShooterGameMode::CacheSpawnPoints()
 {
-	TArray<APlayerStart*> PreferredSpawns;
-	TArray<APlayerStart*> FallbackSpawns;
+	bSpawnPointsDirty = false;
+	SpawnPoints.Reset();
+	PIEStart.Reset();
 
-	APlayerStart* BestStart = NULL;
 	for (TActorIterator<APlayerStart> It(GetWorld()); It; ++It)
 	{
 		APlayerStart* TestSpawn = *It;
 		if (TestSpawn->IsA<APlayerStartPIE>())
 		{
 			// Always prefer the first "Play from Here" PlayerStart, if we find one while in PIE mode
-			BestStart = TestSpawn;
-			break;
-		}
-		else
-		{
-			if (IsSpawnpointAllowed(TestSpawn, Player))
+			if (!PIEStart.IsValid())
 			{
-				if (IsSpawnpointPreferred(TestSpawn, Player))
-				{
-					PreferredSpawns.Add(TestSpawn);
-				}
-				else
-				{
-					FallbackSpawns.Add(TestSpawn);
-				}
+				PIEStart = TestSpawn;
 			}
+			continue;
+		}
+
+		FShooterSpawnPoint& SpawnPoint = SpawnPoints.AddDefaulted_GetRef();
+		SpawnPoint.PlayerStart = TestSpawn;
+		SpawnPoint.Location = TestSpawn->GetActorLocation();
+
+		const AShooterTeamStart* TeamStart = Cast<AShooterTeamStart>(TestSpawn);
+		if (TeamStart)
+		{
+			SpawnPoint.bIsTeamStart = true;
+			SpawnPoint.SpawnTeam = TeamStart->SpawnTeam;
+			SpawnPoint.bAllowPlayers = !TeamStart->bNotForPlayers;
+			SpawnPoint.bAllowBots = !TeamStart->bNotForBots;
 		}
 	}
 
-	
-	if (BestStart == NULL)
+	auto GetCapsule = [](UClass* PawnClass)
 	{
-		if (PreferredSpawns.Num() > 0)
+		FSpawnCapsule Capsule;
+		const ACharacter* DefaultCharacter = PawnClass ? Cast<ACharacter>(PawnClass->GetDefaultObject()) : nullptr;
+		if (DefaultCharacter)
 		{
-			BestStart = PreferredSpawns[FMath::RandHelper(PreferredSpawns.Num())];
+			Capsule.Radius = DefaultCharacter->GetCapsuleComponent()->GetScaledCapsuleRadius();
+			Capsule.HalfHeight = DefaultCharacter->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
 		}
-		else if (FallbackSpawns.Num() > 0)
+		return Capsule;
+	};
+	PlayerSpawnCapsule = GetCapsule(DefaultPawnClass);
+	BotSpawnCapsule = GetCapsule(BotPawnClass);
+}
+
+void AShooterGameMode::OnLevelChanged(ULevel* Level, UWorld* World)
+{
+	if (World == GetWorld())
+	{
+		bSpawnPointsDirty = true;
+	}
+}
+
+AActor* AShooterGameMode::ChoosePlayerStart_Implementation(AController* Player)
+{
+	if (PIEStart.IsValid())
+	{
+		return PIEStart.Get();
+	}
+
+	if (bSpawnPointsDirty || SpawnPoints.Num() == 0)
+	{
+		CacheSpawnPoints();
+	}
+
+	const bool bForBot = Cast<AShooterAIController>(Player) != nullptr;
+	const FShooterPawnQueryFilter EnemyFilter = FShooterPawnQueryFilter::MakeEnemyFilter(Player);
+
+	// Highest score wins, but free spawn points always beat occupied ones
+	APlayerStart* BestStart = NULL;
+	float BestScore = -MAX_FLT;
+	bool bBestOccupied = true;
+	for (const FShooterSpawnPoint& SpawnPoint : SpawnPoints)
+	{
+		APlayerStart* TestSpawn = SpawnPoint.PlayerStart.Get();
+		if (TestSpawn == NULL || !IsSpawnpointAllowed(SpawnPoint, Player))
+		{
+			continue;
+		}
+
+		const bool bOccupied = IsSpawnpointOccupied(SpawnPoint, bForBot);
+		if (bOccupied && !bBestOccupied)
+		{
+			continue;
+		}
+
+		const float Score = ScoreSpawnpoint(SpawnPoint, Player, EnemyFilter);
+		if ((bBestOccupied && !bOccupied) || Score > BestScore)
 		{
-			BestStart = FallbackSpawns[FMath::RandHelper(FallbackSpawns.Num())];
+			BestStart = TestSpawn;
+			BestScore = Score;
+			bBestOccupied = bOccupied;
 		}
 	}
 
 	return BestStart ? BestStart : Super::ChoosePlayerStart_Implementation(Player);
 }
 
-bool AShooterGameMode::IsSpawnpointAllowed(APlayerStart* SpawnPoint, AController* Player) const
+bool AShooterGameMode::IsSpawnpointAllowed(const FShooterSpawnPoint& SpawnPoint, AController* Player) const
 {
-	AShooterTeamStart* ShooterSpawnPoint = Cast<AShooterTeamStart>(SpawnPoint);
-	if (ShooterSpawnPoint)
+	if (SpawnPoint.bIsTeamStart)
 	{
-		AShooterAIController* AIController = Cast<AShooterAIController>(Player);
-		if (ShooterSpawnPoint->bNotForBots && AIController)
-		{
-			return false;
-		}
+		const bool bForBot = Cast<AShooterAIController>(Player) != nullptr;
+		return bForBot ? SpawnPoint.bAllowBots : SpawnPoint.bAllowPlayers;
+	}
 
-		if (ShooterSpawnPoint->bNotForPlayers && AIController == NULL)
+	return false;
+}
+
+bool AShooterGameMode::IsSpawnpointOccupied(const FShooterSpawnPoint& SpawnPoint, bool bForBot) const
+{
+	const FSpawnCapsule& MyCapsule = bForBot ? BotSpawnCapsule : PlayerSpawnCapsule;
+	const UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(GetWorld());
+	if (PawnIndex == nullptr)
+	{
+		return false;
+	}
+
+	// Any pawn overlapping the spawn point is within this distance of it
+	const float MaxCombinedHeight = (MyCapsule.HalfHeight + PawnIndex->GetMaxPawnHalfHeight()) * 2.0f;
+	const float MaxCombinedRadius = MyCapsule.Radius + PawnIndex->GetMaxPawnRadius();
+	const float QueryRadius = FVector2D(MaxCombinedRadius, MaxCombinedHeight).Size();
+
+	FShooterPawnQueryFilter Filter;
+	Filter.PawnClass = ACharacter::StaticClass();
+	TArray<APawn*> NearbyPawns;
+	PawnIndex->FindPawnsInRadius(SpawnPoint.Location, QueryRadius, Filter, NearbyPawns);
+
+	for (APawn* NearbyPawn : NearbyPawns)
+	{
+		const UCapsuleComponent* OtherCapsule = CastChecked<ACharacter>(NearbyPawn)->GetCapsuleComponent();
+		const float CombinedHeight = (MyCapsule.HalfHeight + OtherCapsule->GetScaledCapsuleHalfHeight()) * 2.0f;
+		const float CombinedRadius = MyCapsule.Radius + OtherCapsule->GetScaledCapsuleRadius();
+		const FVector OtherLocation = NearbyPawn->GetActorLocation();
+
+		// check if player start overlaps this pawn
+		if (FMath::Abs(SpawnPoint.Location.Z - OtherLocation.Z) < CombinedHeight && (SpawnPoint.Location - OtherLocation).Size2D() < CombinedRadius)
 		{
-			return false;
+			return true;
 		}
-		return true;
 	}
 
 	return false;
 }
 
-bool AShooterGameMode::IsSpawnpointPreferred(APlayerStart* SpawnPoint, AController* Player) const
+float AShooterGameMode::ScoreSpawnpoint(const FShooterSpawnPoint& SpawnPoint, AController* Player, const FShooterPawnQueryFilter& EnemyFilter) const
 {
-	ACharacter* MyPawn = Cast<ACharacter>((*DefaultPawnClass)->GetDefaultObject<ACharacter>());	
-	AShooterAIController* AIController = Cast<AShooterAIController>(Player);
-	if( AIController != nullptr )
+	float Score = FShooterDeterministicMode::FRand() * SpawnRandomWeight;
+
+	// up to 1 for the nearest enemy being SpawnSafeEnemyDistance or more away
+	const UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(GetWorld());
+	if (PawnIndex && SpawnSafeEnemyDistance > 0.0f)
 	{
-		MyPawn = Cast<ACharacter>(BotPawnClass->GetDefaultObject<ACharacter>());
+		TArray<APawn*> NearestEnemy;
+		PawnIndex->FindNearestPawns(SpawnPoint.Location, 1, EnemyFilter, NearestEnemy, SpawnSafeEnemyDistance);
+
+		const float EnemyDistance = NearestEnemy.Num() > 0 ? FVector::Dist(NearestEnemy[0]->GetActorLocation(), SpawnPoint.Location) : SpawnSafeEnemyDistance;
+		Score += FMath::Min(EnemyDistance / SpawnSafeEnemyDistance, 1.0f);
 	}
-	
-	if (MyPawn)
+
+	// minus recent deaths nearby, weighed by how close and how recent they are
+	if (SpawnRecentDeathRadius > 0.0f && SpawnRecentDeathTime > 0.0f)
 	{
-		const FVector SpawnLocation = SpawnPoint->GetActorLocation();
-		for (ACharacter* OtherPawn : TActorRange<ACharacter>(GetWorld()))
+		const float Now = GetWorld()->GetTimeSeconds();
+		for (const FRecentDeath& Death : RecentDeaths)
 		{
-			if (OtherPawn != MyPawn)
+			const float Age = Now - Death.Time;
+			const float Distance = FVector::Dist(Death.Location, SpawnPoint.Location);
+			if (Age < SpawnRecentDeathTime && Distance < SpawnRecentDeathRadius)
 			{
-				const float CombinedHeight = (MyPawn->GetCapsuleComponent()->GetScaledCapsuleHalfHeight() + OtherPawn->GetCapsuleComponent()->GetScaledCapsuleHalfHeight()) * 2.0f;
-				const float CombinedRadius = MyPawn->GetCapsuleComponent()->GetScaledCapsuleRadius() + OtherPawn->GetCapsuleComponent()->GetScaledCapsuleRadius();
-				const FVector OtherLocation = OtherPawn->GetActorLocation();
-
-				// check if player start overlaps this pawn
-				if (FMath::Abs(SpawnLocation.Z - OtherLocation.Z) < CombinedHeight && (SpawnLocation - OtherLocation).Size2D() < CombinedRadius)
-				{
-					return false;
-				}
+				Score -= SpawnRecentDeathWeight * (1.0f - Age / SpawnRecentDeathTime) * (1.0f - Distance / SpawnRecentDeathRadius);
 			}
 		}
 	}
-	else
-	{
-		return false;
-	}
-	
-	return true;
+
+	return Score;
 }
 
 void AShooterGameMode::CreateBotControllers()
@@ -569,3 +687,62 @@ void AShooterGameMode::RestartGame()
 	Super::RestartGame();
 }
 
+void AShooterGameMode::GetSeamlessTravelActorList(bool bToTransition, TArray<AActor*>& ActorList)
+{
+	Super::GetSeamlessTravelActorList(bToTransition, ActorList);
+
+	// bots stay like players do, CreateBotControllers only tops them up to MaxBots
+	for (APlayerState* PlayerState : GameState->PlayerArray)
+	{
+		AShooterAIController* AIC = PlayerState ? Cast<AShooterAIController>(PlayerState->GetOwner()) : nullptr;
+		if (AIC)
+		{
+			ActorList.Add(AIC);
+		}
+	}
+}
+
+void AShooterGameMode::ProcessServerTravel(const FString& URL, bool bAbsolute)
+{
+	Super::ProcessServerTravel(URL, bAbsolute);
+
+	// bot pawns stay behind with the old world, their controllers travel. Done once here as the travel actor list is
+	// gathered twice, for the transition map and for the destination
+	if (GetWorld()->IsInSeamlessTravel())
+	{
+		for (APlayerState* PlayerState : GameState->PlayerArray)
+		{
+			AShooterAIController* AIC = PlayerState ? Cast<AShooterAIController>(PlayerState->GetOwner()) : nullptr;
+			if (AIC && AIC->GetPawn())
+			{
+				AIC->UnPossess();
+			}
+		}
+	}
+}
+
+void AShooterGameMode::PostSeamlessTravel()
+{
+	Super::PostSeamlessTravel();
+
+	bWaitingForTravellingPlayers = true;
+	CheckTravellingPlayersArrived();
+}
+
+void AShooterGameMode::HandleSeamlessTravelPlayer(AController*& C)
+{
+	Super::HandleSeamlessTravelPlayer(C);
+
+	CheckTravellingPlayersArrived();
+}
+
+void AShooterGameMode::CheckTravellingPlayersArrived()
+{
+	if (bWaitingForTravellingPlayers && NumTravellingPlayers <= 0)
+	{
+		bWaitingForTravellingPlayers = false;
+		UE_LOG(LogShooter, Log, TEXT("All players arrived from the previous match"));
+		FShooterStartupTimer::Playable(TEXT("players arrived"));
+	}
+}
+
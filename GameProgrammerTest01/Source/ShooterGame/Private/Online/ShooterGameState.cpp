@@ -21,10 +21,42 @@ void AShooterGameState::GetLifetimeReplicatedProps( TArray< FLifetimeProperty >
 {
 	Super::GetLifetimeReplicatedProps( OutLifetimeProps );
 
-	DOREPLIFETIME( AShooterGameState, NumTeams );
-	DOREPLIFETIME( AShooterGameState, RemainingTime );
-	DOREPLIFETIME( AShooterGameState, bTimerPaused );
-	DOREPLIFETIME( AShooterGameState, TeamScores );
+	FDoRepLifetimeParams SharedParams;
+	SharedParams.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST( AShooterGameState, NumTeams, SharedParams );
+	DOREPLIFETIME_WITH_PARAMS_FAST( AShooterGameState, RemainingTime, SharedParams );
+	DOREPLIFETIME_WITH_PARAMS_FAST( AShooterGameState, bTimerPaused, SharedParams );
+	DOREPLIFETIME_WITH_PARAMS_FAST( AShooterGameState, TeamScores, SharedParams );
+}
+
+void AShooterGameState::SetNumTeams(int32 InNumTeams)
+{
+	NumTeams = InNumTeams;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, NumTeams, this);
+}
+
+void AShooterGameState::AddTeamScore(int32 TeamIndex, int32 Points)
+{
+	if (TeamIndex >= TeamScores.Num())
+	{
+		TeamScores.AddZeroed(TeamIndex - TeamScores.Num() + 1);
+	}
+
+	TeamScores[TeamIndex] += Points;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, TeamScores, this);
+}
+
+void AShooterGameState::SetRemainingTime(int32 InRemainingTime)
+{
+	RemainingTime = InRemainingTime;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, RemainingTime, this);
+}
+
+void AShooterGameState::SetTimerPaused(bool bInTimerPaused)
+{
+	bTimerPaused = bInTimerPaused;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, bTimerPaused, this);
 }
 
 void AShooterGameState::GetRankedMap(int32 TeamIndex, RankedPlayerMap& OutRankedMap) const
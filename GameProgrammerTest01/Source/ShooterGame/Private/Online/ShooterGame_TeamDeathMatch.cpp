@@ -1,10 +1,10 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "ShooterGame.h"
-#include "ShooterTeamStart.h"
 #include "Online/ShooterGame_TeamDeathMatch.h"
 #include "Online/ShooterPlayerState.h"
 #include "Bots/ShooterAIController.h"
+#include "ShooterDeterministicMode.h"
 
 AShooterGame_TeamDeathMatch::AShooterGame_TeamDeathMatch(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -29,7 +29,7 @@ void AShooterGame_TeamDeathMatch::InitGameState()
 	AShooterGameState* const MyGameState = Cast<AShooterGameState>(GameState);
 	if (MyGameState)
 	{
-		MyGameState->NumTeams = NumTeams;
+		MyGameState->SetNumTeams(NumTeams);
 	}
 }
 
@@ -74,7 +74,7 @@ int32 AShooterGame_TeamDeathMatch::ChooseTeam(AShooterPlayerState* ForPlayerStat
 	}
 
 	// get random from best list
-	const int32 RandomBestTeam = BestTeams[FMath::RandHelper(BestTeams.Num())];
+	const int32 RandomBestTeam = BestTeams[FShooterDeterministicMode::RandHelper(BestTeams.Num())];
 	return RandomBestTeam;
 }
 
@@ -108,14 +108,13 @@ bool AShooterGame_TeamDeathMatch::IsWinner(AShooterPlayerState* PlayerState) con
 	return PlayerState && !PlayerState->IsQuitter() && PlayerState->GetTeamNum() == WinnerTeam;
 }
 
-bool AShooterGame_TeamDeathMatch::IsSpawnpointAllowed(APlayerStart* SpawnPoint, AController* Player) const
+bool AShooterGame_TeamDeathMatch::IsSpawnpointAllowed(const FShooterSpawnPoint& SpawnPoint, AController* Player) const
 {
 	if (Player)
 	{
-		AShooterTeamStart* TeamStart = Cast<AShooterTeamStart>(SpawnPoint);
 		AShooterPlayerState* PlayerState = Cast<AShooterPlayerState>(Player->PlayerState);
 
-		if (PlayerState && TeamStart && TeamStart->SpawnTeam != PlayerState->GetTeamNum())
+		if (PlayerState && SpawnPoint.bIsTeamStart && SpawnPoint.SpawnTeam != PlayerState->GetTeamNum())
 		{
 			return false;
 		}
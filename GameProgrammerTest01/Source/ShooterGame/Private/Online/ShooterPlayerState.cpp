@@ -4,6 +4,9 @@
 #include "ShooterPlayerState.h"
 #include "Net/OnlineEngineInterface.h"
 
+FOnShooterPlayerStateScoreChanged AShooterPlayerState::NotifyScoreChanged;
+FOnShooterPlayerStateTeamChanged AShooterPlayerState::NotifyTeamChanged;
+
 AShooterPlayerState::AShooterPlayerState(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
 	TeamNumber = 0;
@@ -21,10 +24,14 @@ void AShooterPlayerState::Reset()
 	//PlayerStates persist across seamless travel.  Keep the same teams as previous match.
 	//SetTeamNum(0);
 	NumKills = 0;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterPlayerState, NumKills, this);
 	NumDeaths = 0;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterPlayerState, NumDeaths, this);
 	NumBulletsFired = 0;
 	NumRocketsFired = 0;
 	bQuitter = false;
+
+	NotifyScoreChanged.Broadcast(this);
 }
 
 void AShooterPlayerState::RegisterPlayerWithSession(bool bWasFromInvite)
@@ -52,9 +59,17 @@ void AShooterPlayerState::ClientInitialize(AController* InController)
 
 void AShooterPlayerState::SetTeamNum(int32 NewTeamNumber)
 {
+	const bool bTeamChanged = TeamNumber != NewTeamNumber;
+
 	TeamNumber = NewTeamNumber;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterPlayerState, TeamNumber, this);
 
 	UpdateTeamColors();
+
+	if (bTeamChanged)
+	{
+		NotifyTeamChanged.Broadcast(this);
+	}
 }
 
 void AShooterPlayerState::OnRep_TeamColor()
@@ -80,6 +95,7 @@ void AShooterPlayerState::SetQuitter(bool bInQuitter)
 void AShooterPlayerState::SetMatchId(const FString& CurrentMatchId)
 {
 	MatchId = CurrentMatchId;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterPlayerState, MatchId, this);
 }
 
 void AShooterPlayerState::CopyProperties(APlayerState* PlayerState)
@@ -90,6 +106,7 @@ void AShooterPlayerState::CopyProperties(APlayerState* PlayerState)
 	if (ShooterPlayer)
 	{
 		ShooterPlayer->TeamNumber = TeamNumber;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterPlayerState, TeamNumber, ShooterPlayer);
 	}	
 }
 
@@ -144,12 +161,14 @@ FString AShooterPlayerState::GetMatchId() const
 void AShooterPlayerState::ScoreKill(AShooterPlayerState* Victim, int32 Points)
 {
 	NumKills++;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterPlayerState, NumKills, this);
 	ScorePoints(Points);
 }
 
 void AShooterPlayerState::ScoreDeath(AShooterPlayerState* KilledBy, int32 Points)
 {
 	NumDeaths++;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterPlayerState, NumDeaths, this);
 	ScorePoints(Points);
 }
 
@@ -158,15 +177,12 @@ void AShooterPlayerState::ScorePoints(int32 Points)
 	AShooterGameState* const MyGameState = GetWorld()->GetGameState<AShooterGameState>();
 	if (MyGameState && TeamNumber >= 0)
 	{
-		if (TeamNumber >= MyGameState->TeamScores.Num())
-		{
-			MyGameState->TeamScores.AddZeroed(TeamNumber - MyGameState->TeamScores.Num() + 1);
-		}
-
-		MyGameState->TeamScores[TeamNumber] += Points;
+		MyGameState->AddTeamScore(TeamNumber, Points);
 	}
 
 	SetScore(GetScore() + Points);
+
+	NotifyScoreChanged.Broadcast(this);
 }
 
 void AShooterPlayerState::InformAboutKill_Implementation(class AShooterPlayerState* KillerPlayerState, const UDamageType* KillerDamageType, class AShooterPlayerState* KilledPlayerState)
@@ -209,10 +225,13 @@ void AShooterPlayerState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>&
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(AShooterPlayerState, TeamNumber);
-	DOREPLIFETIME(AShooterPlayerState, NumKills);
-	DOREPLIFETIME(AShooterPlayerState, NumDeaths);
-	DOREPLIFETIME(AShooterPlayerState, MatchId);
+	FDoRepLifetimeParams SharedParams;
+	SharedParams.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterPlayerState, TeamNumber, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterPlayerState, NumKills, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterPlayerState, NumDeaths, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterPlayerState, MatchId, SharedParams);
 }
 
 FString AShooterPlayerState::GetShortPlayerName() const
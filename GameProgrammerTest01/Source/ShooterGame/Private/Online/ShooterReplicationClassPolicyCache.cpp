@@ -0,0 +1,123 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "ShooterReplicationClassPolicyCache.h"
+#include "ShooterReplicationGraph.h"
+#include "Misc/FileHelper.h"
+#include "Misc/EngineVersion.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+namespace ShooterClassPolicyCache
+{
+	static const uint32 FileMagic = 0x53435043;		// 'SCPC'
+	static const int32 FileVersion = 1;
+}
+
+void FShooterRepClassPolicyCache::Reset()
+{
+	Hash = 0;
+	Entries.Empty();
+}
+
+bool FShooterRepClassPolicyCache::Load()
+{
+	Reset();
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *GetFilename(), FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	Reader << *this;
+
+	if (Reader.IsError())
+	{
+		Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FShooterRepClassPolicyCache::Save() const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	Writer << const_cast<FShooterRepClassPolicyCache&>(*this);
+
+	return FFileHelper::SaveArrayToFile(Bytes, *GetFilename());
+}
+
+FString FShooterRepClassPolicyCache::GetFilename()
+{
+	return FPaths::ProjectSavedDir() / TEXT("ShooterRepGraph") / TEXT("ClassPolicies.bin");
+}
+
+uint32 FShooterRepClassPolicyCache::ComputeHash(float ServerMaxTickRate)
+{
+	uint32 Result = GetTypeHash(ServerMaxTickRate);
+	Result = HashCombine(Result, ShooterClassPolicyCache::FileVersion);
+	Result = HashCombine(Result, FCrc::StrCrc32(FApp::GetBuildVersion()));
+	Result = HashCombine(Result, FEngineVersion::Current().GetChangelist());
+
+	// Native class defaults only change with the binary
+	IFileManager& FileManager = IFileManager::Get();
+	Result = HashCombine(Result, GetTypeHash(FileManager.GetTimeStamp(FPlatformProcess::ExecutablePath()).GetTicks()));
+
+	// Blueprint classes only change with a new cook, which rewrites the asset registry
+	const FString AssetRegistryFilename = FPaths::ProjectDir() / TEXT("AssetRegistry.bin");
+	Result = HashCombine(Result, GetTypeHash(FileManager.GetTimeStamp(*AssetRegistryFilename).GetTicks()));
+	Result = HashCombine(Result, GetTypeHash(FileManager.FileSize(*AssetRegistryFilename)));
+
+	return Result;
+}
+
+FArchive& operator<<(FArchive& Ar, FShooterRepClassPolicyCache& Cache)
+{
+	uint32 Magic = ShooterClassPolicyCache::FileMagic;
+	int32 Version = ShooterClassPolicyCache::FileVersion;
+	Ar << Magic;
+	Ar << Version;
+
+	if (Ar.IsLoading() && (Magic != ShooterClassPolicyCache::FileMagic || Version != ShooterClassPolicyCache::FileVersion))
+	{
+		Ar.SetError();
+		return Ar;
+	}
+
+	Ar << Cache.Hash;
+
+	int32 NumEntries = Cache.Entries.Num();
+	Ar << NumEntries;
+
+	if (Ar.IsLoading())
+	{
+		if (NumEntries < 0 || NumEntries > Ar.TotalSize())
+		{
+			Ar.SetError();
+			return Ar;
+		}
+
+		Cache.Entries.SetNum(NumEntries);
+	}
+
+	for (FShooterRepClassPolicyCache::FEntry& Entry : Cache.Entries)
+	{
+		uint32 Mapping = static_cast<uint32>(Entry.Mapping);
+
+		Ar << Entry.ClassPath;
+		Ar << Entry.bHasMapping;
+		Ar << Mapping;
+		Ar << Entry.bNonSpatializedChild;
+		Ar << Entry.bHasClassInfo;
+		Ar << Entry.CullDistanceSquared;
+		Ar << Entry.ReplicationPeriodFrame;
+
+		Entry.Mapping = static_cast<EClassRepNodeMapping>(Mapping);
+	}
+
+	return Ar;
+}
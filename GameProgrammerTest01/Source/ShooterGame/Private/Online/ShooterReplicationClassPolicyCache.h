@@ -0,0 +1,56 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EClassRepNodeMapping : uint32;
+
+/**
+ * Result of UShooterReplicationGraph's scan of replicated actor classes: the routing policy and legacy FClassReplicationInfo settings it derived
+ * for each class. Deriving them creates and compares every actor CDO, so the result is saved to Saved/ShooterRepGraph/ClassPolicies.bin and kept
+ * in memory across travels. It is reused as long as ComputeHash matches, i.e. the same binary and cook. Only used in cooked builds, where content
+ * can't change without a new cook. Replicated classes loaded after it was built (e.g. Blueprints only another map uses) are scanned when first
+ * seen and appended.
+ *
+ * Init time is logged as "Loaded/Built class policies for N/M classes in X ms" (LogShooterReplicationGraph); compare a server started with
+ * -ini:Engine:[ConsoleVariables]:ShooterRepGraph.ClassPolicyCache=0 against a second start with the cache enabled.
+ */
+struct FShooterRepClassPolicyCache
+{
+	struct FEntry
+	{
+		FString ClassPath;
+
+		bool bHasMapping = false;
+
+		EClassRepNodeMapping Mapping{};
+
+		bool bNonSpatializedChild = false;
+
+		bool bHasClassInfo = false;
+
+		float CullDistanceSquared = 0.f;
+
+		uint32 ReplicationPeriodFrame = 1;
+	};
+
+	/** ComputeHash at the time the entries were built */
+	uint32 Hash = 0;
+
+	TArray<FEntry> Entries;
+
+	void Reset();
+
+	/** Loads the cache file, returns false if there is none or it is from another version */
+	bool Load();
+
+	bool Save() const;
+
+	static FString GetFilename();
+
+	/** Hash of the binary, the cooked asset registry and the server tick rate. Cheap, doesn't look at the loaded classes */
+	static uint32 ComputeHash(float ServerMaxTickRate);
+
+	friend FArchive& operator<<(FArchive& Ar, FShooterRepClassPolicyCache& Cache);
+};
@@ -31,17 +31,38 @@
 *		This is an actor list node that contains the always relevant actors. These actors are always relevant to every connection.
 *		
 *		UShooterReplicationGraphNode_AlwaysRelevant_ForConnection
-*		This is the node for connection specific always relevant actors. This node does not maintain a persistent list but builds it each frame. This is possible because (currently)
-*		these actors are all easily accessed from the PlayerController. A persistent list would require notifications to be broadcast when these actors change, which would be possible
-*		but currently not necessary.
+*		This is the node for connection specific always relevant actors. These actors are all easily accessed from the PlayerController, so rather than relying on notifications the
+*		node keeps a cheap snapshot of the viewers, pawn, player state and inventory size it last built its list from, and only rebuilds when that snapshot changes. Gathering is
+*		otherwise just returning the cached lists.
 *		
 *		UShooterReplicationGraphNode_PlayerStateFrequencyLimiter
-*		A custom node for handling player state replication. This replicates a small rolling set of player states (currently 2/frame). This is so player states replicate
-*		to simulated connections at a low, steady frequency, and to take advantage of serialization sharing. Auto proxy player states are replicated at higher frequency (to the
-*		owning connection only) via UShooterReplicationGraphNode_AlwaysRelevant_ForConnection.
+*		A custom node for handling player state replication. This replicates a small rolling set of player states (2/frame, up to 16/frame for connections with spare bandwidth).
+*		This is so player states replicate to simulated connections at a low, steady frequency, and to take advantage of serialization sharing. Player states whose score changed
+*		are returned ahead of the rolling set until the connection received them. Auto proxy player states are replicated at higher frequency (to the owning connection only) via
+*		UShooterReplicationGraphNode_AlwaysRelevant_ForConnection.
+*		
+*		UShooterReplicationGraphNode_PVS
+*		Pawns are routed here instead of the GridNode when the map has a precomputed visibility set (Content/PVS/<MapName>.pvs, built with ShooterRepGraph.BuildPVS).
+*		Each frame pawns are bucketed by PVS cell, and a connection only gathers the cells its viewer's cell can see. This replaces the per connection line traces of
+*		AShooterCharacter::IsReplicationPausedForConnection on maps that have a PVS.
+*		
+*		UShooterReplicationGraphNode_TeamRelevancy
+*		In team games, pawns are also added to this node. It returns a viewer's teammates regardless of distance (per connection cull distance 0), at a lower
+*		replication frequency when they are far away. Enemies are only gathered through the GridNode / PVS node.
+*		
+*		UShooterReplicationGraphNode_WeaponFireInterest
+*		Weapons only replicate cosmetic fire state (BurstCounter, HitNotify) to non owners. This node raises the per connection replication period of a character's
+*		current weapon when the character is far from the viewer, so far away connections don't receive muzzle flash and tracer updates they can't see.
 *		
 *		UReplicationGraphNode_TearOff_ForConnection
-*		Connection specific node for handling tear off actors. This is created and managed in the base implementation of Replication Graph.
+*		Connection specific node for handling tear off actors. This is created and managed in the base implementation of Replication Graph. Torn off actors (dead pawns)
+*		are removed from all other nodes as soon as they tear off, see UShooterReplicationGraph::NotifyActorTearOff.
+*		
+*	Dormancy (AShooterPickup, AShooterWeapon)
+*		
+*		Pickups are DORM_DormantAll and routed as Spatialize_Dormancy, so once a pickup went dormant on a connection the grid's dormancy nodes stop gathering it. They only
+*		flush dormancy when their state changes (AShooterPickup::PickupOnTouch / RespawnPickup). Weapons go dormant while they sit unequipped in an inventory and wake up
+*		when equipped; giving them ammo flushes them.
 *		
 *	Dependent Actors (AShooterWeapon)
 *		
@@ -73,16 +94,28 @@
 *		Net.RepGraph.PrintAllActorInfo <ActorMatchString> - will print the class, global, and connection replication info associated with an actor/class. If MatchString is empty will print everything. Call directly from client.
 *		
 *		ShooterRepGraph.PrintRouting - will print the EClassRepNodeMapping for each class. That is, how a given actor class is routed (or not) in the Replication Graph.
+*		
+*		ShooterRepGraph.PrintGridOccupancy - will print the size of the spatialization grid(s) and a histogram of how many actors each cell holds.
+*	
+*	How To Profile
+*	
+*		"stat ShooterRepGraph" shows the time spent in each custom node and the saturated connection / starved actor counts. The same timings and counts are written to the
+*		ShooterRepGraph CSV profiler category, and per class time and bytes to the engine's replication graph CSV categories (see CSVTracker in InitGlobalActorClassSettings).
+*		
+*		ShooterRepGraph.PrintProfile <TopN> <"reset"> - will print average node costs, the TopN classes by replications / starvation and the TopN connections by bandwidth,
+*		with how often they were saturated. Collection is cheap and on by default, see ShooterRepGraph.Profile and ShooterRepGraph.ProfileSampleFrames.
 *	
 */
 
 #include "ShooterGame.h"
 #include "ShooterReplicationGraph.h"
+#include "ShooterReplicationClassPolicyCache.h"
 
 #include "Net/UnrealNetwork.h"
 #include "Engine/LevelStreaming.h"
 #include "EngineUtils.h"
 #include "CoreGlobals.h"
+#include "Async/ParallelFor.h"
 
 #if WITH_GAMEPLAY_DEBUGGER
 #include "GameplayDebuggerCategoryReplicator.h"
@@ -92,11 +125,13 @@
 #include "GameFramework/GameState.h"
 #include "GameFramework/PlayerState.h"
 #include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerStart.h"
 #include "Engine/LevelScriptActor.h"
 #include "Player/ShooterCharacter.h"
 #include "Online/ShooterPlayerState.h"
 #include "Weapons/ShooterWeapon.h"
 #include "Pickups/ShooterPickup.h"
+#include "Weapons/ShooterProjectile.h"
 
 DEFINE_LOG_CATEGORY( LogShooterReplicationGraph );
 
@@ -124,8 +159,80 @@ static FAutoConsoleVariableRef CVarShooterRepDynamicActorFrequencyBuckets(TEXT("
 int32 CVar_ShooterRepGraph_DisableSpatialRebuilds = 1;
 static FAutoConsoleVariableRef CVarShooterRepDisableSpatialRebuilds(TEXT("ShooterRepGraph.DisableSpatialRebuilds"), CVar_ShooterRepGraph_DisableSpatialRebuilds, TEXT(""), ECVF_Default );
 
+// Visible streaming levels whose always relevant actors all went dormant stop being gathered. This is how often (in frames) that is re-checked per connection.
+int32 CVar_ShooterRepGraph_StreamingLevelDormancyCheckFrames = 30;
+static FAutoConsoleVariableRef CVarShooterRepStreamingLevelDormancyCheckFrames(TEXT("ShooterRepGraph.StreamingLevelDormancyCheckFrames"), CVar_ShooterRepGraph_StreamingLevelDormancyCheckFrames, TEXT(""), ECVF_Default );
+
+// Per connection work of the PVS, PlayerState and weapon fire nodes is done for all connections on worker threads ahead of the gather
+int32 CVar_ShooterRepGraph_ParallelGather = 1;
+static FAutoConsoleVariableRef CVarShooterRepParallelGather(TEXT("ShooterRepGraph.ParallelGather"), CVar_ShooterRepGraph_ParallelGather, TEXT("0: Disable, 1: Enable"), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_ParallelGatherMinConnections = 8;
+static FAutoConsoleVariableRef CVarShooterRepParallelGatherMinConnections(TEXT("ShooterRepGraph.ParallelGatherMinConnections"), CVar_ShooterRepGraph_ParallelGatherMinConnections, TEXT("Below this many connections the pre-gather runs on the game thread"), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_ClassPolicyCache = 1;
+static FAutoConsoleVariableRef CVarShooterRepClassPolicyCache(TEXT("ShooterRepGraph.ClassPolicyCache"), CVar_ShooterRepGraph_ClassPolicyCache, TEXT("Reuse class routing / replication settings across server starts of the same cooked build, only scanning classes missing from them. 0: Disable, 1: Enable"), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_UsePVS = 1;
+static FAutoConsoleVariableRef CVarShooterRepUsePVS(TEXT("ShooterRepGraph.UsePVS"), CVar_ShooterRepGraph_UsePVS, TEXT("Cull pawns with the map's precomputed visibility set when it has one. Read at map load"), ECVF_Default );
+
+float CVar_ShooterRepGraph_TeamFarDistance = 5000.f;
+static FAutoConsoleVariableRef CVarShooterRepTeamFarDistance(TEXT("ShooterRepGraph.TeamFarDistance"), CVar_ShooterRepGraph_TeamFarDistance, TEXT("Teammates farther than this from the viewer replicate at ShooterRepGraph.TeamFarReplicationPeriodFrame"), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_TeamFarReplicationPeriodFrame = 6;
+static FAutoConsoleVariableRef CVarShooterRepTeamFarReplicationPeriodFrame(TEXT("ShooterRepGraph.TeamFarReplicationPeriodFrame"), CVar_ShooterRepGraph_TeamFarReplicationPeriodFrame, TEXT("Replication period (in frames) of far away teammates"), ECVF_Default );
+
+float CVar_ShooterRepGraph_WeaponFireCullDistance = 8000.f;
+static FAutoConsoleVariableRef CVarShooterRepWeaponFireCullDistance(TEXT("ShooterRepGraph.WeaponFireCullDistance"), CVar_ShooterRepGraph_WeaponFireCullDistance, TEXT("Distance beyond which weapon fire replicates to other players at ShooterRepGraph.WeaponFireCulledPeriodFrame. Half rate from half this distance"), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_WeaponFireCulledPeriodFrame = 30;
+static FAutoConsoleVariableRef CVarShooterRepWeaponFireCulledPeriodFrame(TEXT("ShooterRepGraph.WeaponFireCulledPeriodFrame"), CVar_ShooterRepGraph_WeaponFireCulledPeriodFrame, TEXT("Replication period (in frames) of weapons beyond ShooterRepGraph.WeaponFireCullDistance"), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_PlayerStateMinPerFrame = 2;
+static FAutoConsoleVariableRef CVarShooterRepPlayerStateMinPerFrame(TEXT("ShooterRepGraph.PlayerStateMinPerFrame"), CVar_ShooterRepGraph_PlayerStateMinPerFrame, TEXT("Player states replicated per frame to a connection with no bandwidth to spare"), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_PlayerStateMaxPerFrame = 16;
+static FAutoConsoleVariableRef CVarShooterRepPlayerStateMaxPerFrame(TEXT("ShooterRepGraph.PlayerStateMaxPerFrame"), CVar_ShooterRepGraph_PlayerStateMaxPerFrame, TEXT("Player states replicated per frame to a connection that is using none of its bandwidth"), ECVF_Default );
+
+// When enabled, CellSize and SpatialBias above are only used until a world is loaded. The grid is then sized from the bounds and actor density of that world.
+int32 CVar_ShooterRepGraph_AutoSizeGrid = 1;
+static FAutoConsoleVariableRef CVarShooterRepAutoSizeGrid(TEXT("ShooterRepGraph.AutoSizeGrid"), CVar_ShooterRepGraph_AutoSizeGrid, TEXT("Size the spatialization grid from the world bounds at map load"), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_TargetActorsPerCell = 8;
+static FAutoConsoleVariableRef CVarShooterRepTargetActorsPerCell(TEXT("ShooterRepGraph.TargetActorsPerCell"), CVar_ShooterRepGraph_TargetActorsPerCell, TEXT("Average number of spatialized actors per cell the auto sized grid aims for"), ECVF_Default );
+
+float CVar_ShooterRepGraph_MinCellSize = 2500.f;
+static FAutoConsoleVariableRef CVarShooterRepMinCellSize(TEXT("ShooterRepGraph.MinCellSize"), CVar_ShooterRepGraph_MinCellSize, TEXT("Smallest cell size the auto sized grid may use"), ECVF_Default );
+
+float CVar_ShooterRepGraph_MaxCellSize = 20000.f;
+static FAutoConsoleVariableRef CVarShooterRepMaxCellSize(TEXT("ShooterRepGraph.MaxCellSize"), CVar_ShooterRepGraph_MaxCellSize, TEXT("Largest cell size the auto sized grid may use"), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_MaxCellsPerAxis = 64;
+static FAutoConsoleVariableRef CVarShooterRepMaxCellsPerAxis(TEXT("ShooterRepGraph.MaxCellsPerAxis"), CVar_ShooterRepGraph_MaxCellsPerAxis, TEXT("Upper bound on cells along each axis of the auto sized grid, limits memory spent on empty cells"), ECVF_Default );
+
+// 0: single grid. 1: always add a coarse grid level. 2: add a coarse grid level only on maps larger than LargeMapExtent. Read when the graph is created.
+int32 CVar_ShooterRepGraph_HierarchicalGrid = 0;
+static FAutoConsoleVariableRef CVarShooterRepHierarchicalGrid(TEXT("ShooterRepGraph.HierarchicalGrid"), CVar_ShooterRepGraph_HierarchicalGrid, TEXT("0: Disable, 1: Enable, 2: Enable on large maps only"), ECVF_Default );
+
+float CVar_ShooterRepGraph_LargeMapExtent = 200000.f;
+static FAutoConsoleVariableRef CVarShooterRepLargeMapExtent(TEXT("ShooterRepGraph.LargeMapExtent"), CVar_ShooterRepGraph_LargeMapExtent, TEXT("World extent (X or Y) from which a map counts as large for ShooterRepGraph.HierarchicalGrid 2"), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_CoarseCellScale = 4;
+static FAutoConsoleVariableRef CVarShooterRepCoarseCellScale(TEXT("ShooterRepGraph.CoarseCellScale"), CVar_ShooterRepGraph_CoarseCellScale, TEXT("Cell size of the coarse grid level, in fine cells"), ECVF_Default );
+
 // ----------------------------------------------------------------------------------------------------------
 
+/** Profiler of the graph that created the node, so several graphs (net drivers, PIE servers) keep separate costs */
+static FShooterRepGraphProfiler& GetGraphProfiler(UReplicationGraphNode* Node)
+{
+	return CastChecked<UShooterReplicationGraph>(Node->GetOuter())->GetProfiler();
+}
+
+const FShooterRepGraphProfiler* FShooterRepGraphProfiler::Get(UNetDriver* NetDriver)
+{
+	UShooterReplicationGraph* Graph = NetDriver ? Cast<UShooterReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+	return Graph ? &Graph->GetProfiler() : nullptr;
+}
 
 UShooterReplicationGraph::UShooterReplicationGraph()
 {
@@ -137,7 +244,7 @@ void InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool b
 	if (bSpatialize)
 	{
 		Info.SetCullDistanceSquared(CDO->NetCullDistanceSquared);
-		UE_LOG(LogShooterReplicationGraph, Log, TEXT("Setting cull distance for %s to %f (%f)"), *Class->GetName(), Info.GetCullDistanceSquared(), Info.GetCullDistance());
+		UE_LOG(LogShooterReplicationGraph, Verbose, TEXT("Setting cull distance for %s to %f (%f)"), *Class->GetName(), Info.GetCullDistanceSquared(), Info.GetCullDistance());
 	}
 
 	Info.ReplicationPeriodFrame = FMath::Max<uint32>( (uint32)FMath::RoundToFloat(ServerMaxTickRate / CDO->NetUpdateFrequency), 1);
@@ -148,7 +255,7 @@ void InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool b
 		NativeClass = NativeClass->GetSuperClass();
 	}
 
-	UE_LOG(LogShooterReplicationGraph, Log, TEXT("Setting replication period for %s (%s) to %d frames (%.2f)"), *Class->GetName(), *NativeClass->GetName(), Info.ReplicationPeriodFrame, CDO->NetUpdateFrequency);
+	UE_LOG(LogShooterReplicationGraph, Verbose, TEXT("Setting replication period for %s (%s) to %d frames (%.2f)"), *Class->GetName(), *NativeClass->GetName(), Info.ReplicationPeriodFrame, CDO->NetUpdateFrequency);
 }
 
 void UShooterReplicationGraph::ResetGameWorldState()
@@ -156,6 +263,8 @@ void UShooterReplicationGraph::ResetGameWorldState()
 	Super::ResetGameWorldState();
 
 	AlwaysRelevantStreamingLevelActors.Empty();
+	CoarseGridActors.Empty();
+	TornOffActors.Empty();
 
 	for (UNetReplicationGraphConnection* ConnManager : Connections)
 	{
@@ -195,12 +304,165 @@ void UShooterReplicationGraph::InitGlobalActorClassSettings()
 	AddInfo( APlayerState::StaticClass(),							EClassRepNodeMapping::NotRouted);				// Special cased via UShooterReplicationGraphNode_PlayerStateFrequencyLimiter
 	AddInfo( AReplicationGraphDebugActor::StaticClass(),			EClassRepNodeMapping::NotRouted);				// Not needed. Replicated special case inside RepGraph
 	AddInfo( AInfo::StaticClass(),									EClassRepNodeMapping::RelevantAllConnections);	// Non spatialized, relevant to all
-	AddInfo( AShooterPickup::StaticClass(),							EClassRepNodeMapping::Spatialize_Static);		// Spatialized and never moves. Routes to GridNode.
+	AddInfo( AShooterPickup::StaticClass(),							EClassRepNodeMapping::Spatialize_Dormancy);		// Spatialized, never moves and dormant between pickup/respawn. Routes to GridNode.
+
+	// Per class replication time and bytes in CSV captures
+	CSVTracker.SetExplicitClassTracking(AShooterCharacter::StaticClass(), TEXT("Character"));
+	CSVTracker.SetExplicitClassTracking(AShooterWeapon::StaticClass(), TEXT("Weapon"));
+	CSVTracker.SetExplicitClassTracking(AShooterProjectile::StaticClass(), TEXT("Projectile"));
+	CSVTracker.SetExplicitClassTracking(AShooterPickup::StaticClass(), TEXT("Pickup"));
+	CSVTracker.SetExplicitClassTracking(APlayerState::StaticClass(), TEXT("PlayerState"));
 
 #if WITH_GAMEPLAY_DEBUGGER
 	AddInfo( AGameplayDebuggerCategoryReplicator::StaticClass(),	EClassRepNodeMapping::NotRouted);				// Replicated via UShooterReplicationGraphNode_AlwaysRelevant_ForConnection
 #endif
 
+	// -----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+	// Setup FClassReplicationInfo. This is essentially the per class replication settings. Some we set explicitly, the rest we are setting via looking at the legacy settings on AActor.
+	// -----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+	
+	TArray<UClass*> ExplicitlySetClasses;
+	auto SetClassInfo = [&](UClass* Class, const FClassReplicationInfo& Info) { GlobalActorReplicationInfoMap.SetClassInfo(Class, Info); ExplicitlySetClasses.Add(Class); };
+
+	FClassReplicationInfo PawnClassRepInfo;
+	PawnClassRepInfo.DistancePriorityScale = 1.f;
+	PawnClassRepInfo.StarvationPriorityScale = 1.f;
+	PawnClassRepInfo.ActorChannelFrameTimeout = 4;
+	PawnClassRepInfo.SetCullDistanceSquared(15000.f * 15000.f); // Yuck
+	SetClassInfo( APawn::StaticClass(), PawnClassRepInfo );
+
+	FClassReplicationInfo PlayerStateRepInfo;
+	PlayerStateRepInfo.DistancePriorityScale = 0.f;
+	PlayerStateRepInfo.ActorChannelFrameTimeout = 0;
+	SetClassInfo( APlayerState::StaticClass(), PlayerStateRepInfo );
+	
+	UReplicationGraphNode_ActorListFrequencyBuckets::DefaultSettings.ListSize = 12;
+
+	// -----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+	// Everything else is derived from the CDOs of all replicated classes. That only changes with the binary or the cook, so reuse the last result until it does.
+	// -----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Kept across travels
+	static FShooterRepClassPolicyCache ClassPolicyCache;
+
+	const bool bUseCache = !GIsEditor && FPlatformProperties::RequiresCookedData() && CVar_ShooterRepGraph_ClassPolicyCache > 0;
+	const uint32 ClassPolicyHash = bUseCache ? FShooterRepClassPolicyCache::ComputeHash(NetDriver->NetServerMaxTickRate) : 0;
+
+	TSet<UClass*> CachedClasses;
+	bool bFromCache = false;
+	if (bUseCache)
+	{
+		if (ClassPolicyCache.Hash != ClassPolicyHash)
+		{
+			ClassPolicyCache.Load();
+		}
+
+		bFromCache = ClassPolicyCache.Hash == ClassPolicyHash && ApplyClassPolicyCache(ClassPolicyCache, CachedClasses);
+	}
+
+	if (!bFromCache)
+	{
+		ClassPolicyCache.Reset();
+		CachedClasses.Reset();
+	}
+
+	// Builds everything without a cache. With one, only classes it has no entry for, e.g. a Blueprint first loaded by this map
+	const int32 NumCachedEntries = ClassPolicyCache.Entries.Num();
+	BuildClassPolicies(ExplicitlySetClasses, CachedClasses, ClassPolicyCache);
+	const int32 NumBuiltEntries = ClassPolicyCache.Entries.Num() - NumCachedEntries;
+
+	if (bUseCache && NumBuiltEntries > 0)
+	{
+		ClassPolicyCache.Hash = ClassPolicyHash;
+		if (!ClassPolicyCache.Save())
+		{
+			UE_LOG(LogShooterReplicationGraph, Warning, TEXT("Failed to save class policy cache to %s"), *FShooterRepClassPolicyCache::GetFilename());
+		}
+	}
+
+	UE_LOG(LogShooterReplicationGraph, Log, TEXT("Loaded/Built class policies for %d/%d classes in %.1f ms"), CachedClasses.Num(), NumBuiltEntries, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	// Print out what we came up with. Use 'log LogShooterReplicationGraph Verbose' to see it
+	if (UE_LOG_ACTIVE(LogShooterReplicationGraph, Verbose))
+	{
+		UE_LOG(LogShooterReplicationGraph, Verbose, TEXT(""));
+		UE_LOG(LogShooterReplicationGraph, Verbose, TEXT("Class Routing Map: "));
+		UEnum* Enum = StaticEnum<EClassRepNodeMapping>();
+		for (auto ClassMapIt = ClassRepNodePolicies.CreateIterator(); ClassMapIt; ++ClassMapIt)
+		{		
+			UClass* Class = CastChecked<UClass>(ClassMapIt.Key().ResolveObjectPtr());
+			const EClassRepNodeMapping Mapping = ClassMapIt.Value();
+
+			// Only print if different than native class
+			UClass* ParentNativeClass = GetParentNativeClass(Class);
+			const EClassRepNodeMapping* ParentMapping = ClassRepNodePolicies.Get(ParentNativeClass);
+			if (ParentMapping && Class != ParentNativeClass && Mapping == *ParentMapping)
+			{
+				continue;
+			}
+
+			UE_LOG(LogShooterReplicationGraph, Verbose, TEXT("  %s (%s) -> %s"), *Class->GetName(), *GetNameSafe(ParentNativeClass), *Enum->GetNameStringByValue(static_cast<uint32>(Mapping)));
+		}
+
+		UE_LOG(LogShooterReplicationGraph, Verbose, TEXT(""));
+		UE_LOG(LogShooterReplicationGraph, Verbose, TEXT("Class Settings Map: "));
+		for (auto ClassRepInfoIt = GlobalActorReplicationInfoMap.CreateClassMapIterator(); ClassRepInfoIt; ++ClassRepInfoIt)
+		{
+			UClass* Class = CastChecked<UClass>(ClassRepInfoIt.Key().ResolveObjectPtr());
+			const FClassReplicationInfo& ClassInfo = ClassRepInfoIt.Value();
+			UE_LOG(LogShooterReplicationGraph, Verbose, TEXT("  %s (%s) -> %s"), *Class->GetName(), *GetNameSafe(GetParentNativeClass(Class)), *ClassInfo.BuildDebugStringDelta());
+		}
+	}
+
+
+	// Rep destruct infos based on CVar value
+	DestructInfoMaxDistanceSquared = CVar_ShooterRepGraph_DestructionInfoMaxDist * CVar_ShooterRepGraph_DestructionInfoMaxDist;
+
+	// -------------------------------------------------------
+	//	Register for game code callbacks.
+	//	This could have been done the other way: E.g, AMyGameActor could do GetNetDriver()->GetReplicationDriver<UShooterReplicationGraph>()->OnMyGameEvent etc.
+	//	This way at least keeps the rep graph out of game code directly and allows rep graph to exist in its own module
+	//	So for now, erring on the side of a cleaning dependencies between classes.
+	// -------------------------------------------------------
+	
+	AShooterCharacter::NotifyEquipWeapon.AddUObject(this, &UShooterReplicationGraph::OnCharacterEquipWeapon);
+	AShooterCharacter::NotifyUnEquipWeapon.AddUObject(this, &UShooterReplicationGraph::OnCharacterUnEquipWeapon);
+	AShooterPlayerState::NotifyScoreChanged.AddUObject(this, &UShooterReplicationGraph::OnPlayerStateScoreChanged);
+	AShooterPlayerState::NotifyTeamChanged.AddUObject(this, &UShooterReplicationGraph::OnPlayerStateTeamChanged);
+
+#if WITH_GAMEPLAY_DEBUGGER
+	AGameplayDebuggerCategoryReplicator::NotifyDebuggerOwnerChange.AddUObject(this, &UShooterReplicationGraph::OnGameplayDebuggerOwnerChange);
+#endif
+}
+
+void UShooterReplicationGraph::BuildClassPolicies(const TArray<UClass*>& ExplicitlySetClasses, const TSet<UClass*>& KnownClasses, FShooterRepClassPolicyCache& OutCache)
+{
+	QUICK_SCOPE_CYCLE_COUNTER( UShooterReplicationGraph_BuildClassPolicies );
+
+	// Everything added here is recorded so the next init can skip the scan
+	TMap<UClass*, int32> EntryIndices;
+	auto FindOrAddEntry = [&](UClass* Class) -> FShooterRepClassPolicyCache::FEntry&
+	{
+		int32& EntryIdx = EntryIndices.FindOrAdd(Class, INDEX_NONE);
+		if (EntryIdx == INDEX_NONE)
+		{
+			EntryIdx = OutCache.Entries.AddDefaulted();
+			OutCache.Entries[EntryIdx].ClassPath = Class->GetPathName();
+		}
+		return OutCache.Entries[EntryIdx];
+	};
+
+	auto AddInfo = [&]( UClass* Class, EClassRepNodeMapping Mapping)
+	{
+		ClassRepNodePolicies.Set(Class, Mapping);
+
+		FShooterRepClassPolicyCache::FEntry& Entry = FindOrAddEntry(Class);
+		Entry.bHasMapping = true;
+		Entry.Mapping = Mapping;
+	};
+
 	TArray<UClass*> AllReplicatedClasses;
 
 	for (TObjectIterator<UClass> It; It; ++It)
@@ -218,6 +480,12 @@ void UShooterReplicationGraph::InitGlobalActorClassSettings()
 			continue;
 		}
 
+		// Already applied from the cache
+		if (KnownClasses.Contains(Class))
+		{
+			continue;
+		}
+
 		// --------------------------------------------------------------------
 		// This is a replicated class. Save this off for the second pass below
 		// --------------------------------------------------------------------
@@ -255,8 +523,9 @@ void UShooterReplicationGraph::InitGlobalActorClassSettings()
 
 			if (ShouldSpatialize(ActorCDO) == false && ShouldSpatialize(SuperCDO) == true)
 			{
-				UE_LOG(LogShooterReplicationGraph, Log, TEXT("Adding %s to NonSpatializedChildClasses. (Parent: %s)"), *GetLegacyDebugStr(ActorCDO), *GetLegacyDebugStr(SuperCDO));
+				UE_LOG(LogShooterReplicationGraph, Verbose, TEXT("Adding %s to NonSpatializedChildClasses. (Parent: %s)"), *GetLegacyDebugStr(ActorCDO), *GetLegacyDebugStr(SuperCDO));
 				NonSpatializedChildClasses.Add(Class);
+				FindOrAddEntry(Class).bNonSpatializedChild = true;
 			}
 		}
 			
@@ -270,30 +539,12 @@ void UShooterReplicationGraph::InitGlobalActorClassSettings()
 		}
 	}
 
-	// -----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-	// Setup FClassReplicationInfo. This is essentially the per class replication settings. Some we set explicitly, the rest we are setting via looking at the legacy settings on AActor.
-	// -----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-	
-	TArray<UClass*> ExplicitlySetClasses;
-	auto SetClassInfo = [&](UClass* Class, const FClassReplicationInfo& Info) { GlobalActorReplicationInfoMap.SetClassInfo(Class, Info); ExplicitlySetClasses.Add(Class); };
-
-	FClassReplicationInfo PawnClassRepInfo;
-	PawnClassRepInfo.DistancePriorityScale = 1.f;
-	PawnClassRepInfo.StarvationPriorityScale = 1.f;
-	PawnClassRepInfo.ActorChannelFrameTimeout = 4;
-	PawnClassRepInfo.SetCullDistanceSquared(15000.f * 15000.f); // Yuck
-	SetClassInfo( APawn::StaticClass(), PawnClassRepInfo );
-
-	FClassReplicationInfo PlayerStateRepInfo;
-	PlayerStateRepInfo.DistancePriorityScale = 0.f;
-	PlayerStateRepInfo.ActorChannelFrameTimeout = 0;
-	SetClassInfo( APlayerState::StaticClass(), PlayerStateRepInfo );
-	
-	UReplicationGraphNode_ActorListFrequencyBuckets::DefaultSettings.ListSize = 12;
-
 	// Set FClassReplicationInfo based on legacy settings from all replicated classes
 	for (UClass* ReplicatedClass : AllReplicatedClasses)
 	{
+		// Every scanned class gets an entry, even one with nothing to record, so it isn't scanned again with the cache
+		FShooterRepClassPolicyCache::FEntry& Entry = FindOrAddEntry(ReplicatedClass);
+
 		if (ExplicitlySetClasses.FindByPredicate([&](const UClass* SetClass) { return ReplicatedClass->IsChildOf(SetClass); }) != nullptr)
 		{
 			continue;
@@ -304,56 +555,48 @@ void UShooterReplicationGraph::InitGlobalActorClassSettings()
 		FClassReplicationInfo ClassInfo;
 		InitClassReplicationInfo(ClassInfo, ReplicatedClass, bClassIsSpatialized, NetDriver->NetServerMaxTickRate);
 		GlobalActorReplicationInfoMap.SetClassInfo( ReplicatedClass, ClassInfo );
-	}
 
+		Entry.bHasClassInfo = true;
+		Entry.CullDistanceSquared = ClassInfo.GetCullDistanceSquared();
+		Entry.ReplicationPeriodFrame = ClassInfo.ReplicationPeriodFrame;
+	}
+}
 
-	// Print out what we came up with
-	UE_LOG(LogShooterReplicationGraph, Log, TEXT(""));
-	UE_LOG(LogShooterReplicationGraph, Log, TEXT("Class Routing Map: "));
-	UEnum* Enum = StaticEnum<EClassRepNodeMapping>();
-	for (auto ClassMapIt = ClassRepNodePolicies.CreateIterator(); ClassMapIt; ++ClassMapIt)
-	{		
-		UClass* Class = CastChecked<UClass>(ClassMapIt.Key().ResolveObjectPtr());
-		const EClassRepNodeMapping Mapping = ClassMapIt.Value();
+bool UShooterReplicationGraph::ApplyClassPolicyCache(const FShooterRepClassPolicyCache& Cache, TSet<UClass*>& OutAppliedClasses)
+{
+	QUICK_SCOPE_CYCLE_COUNTER( UShooterReplicationGraph_ApplyClassPolicyCache );
 
-		// Only print if different than native class
-		UClass* ParentNativeClass = GetParentNativeClass(Class);
-		const EClassRepNodeMapping* ParentMapping = ClassRepNodePolicies.Get(ParentNativeClass);
-		if (ParentMapping && Class != ParentNativeClass && Mapping == *ParentMapping)
+	for (const FShooterRepClassPolicyCache::FEntry& Entry : Cache.Entries)
+	{
+		// Classes this map doesn't load keep their entry for the maps that do
+		UClass* Class = FindObject<UClass>(nullptr, *Entry.ClassPath);
+		if (Class == nullptr)
 		{
 			continue;
 		}
 
-		UE_LOG(LogShooterReplicationGraph, Log, TEXT("  %s (%s) -> %s"), *Class->GetName(), *GetNameSafe(ParentNativeClass), *Enum->GetNameStringByValue(static_cast<uint32>(Mapping)));
-	}
-
-	UE_LOG(LogShooterReplicationGraph, Log, TEXT(""));
-	UE_LOG(LogShooterReplicationGraph, Log, TEXT("Class Settings Map: "));
-	FClassReplicationInfo DefaultValues;
-	for (auto ClassRepInfoIt = GlobalActorReplicationInfoMap.CreateClassMapIterator(); ClassRepInfoIt; ++ClassRepInfoIt)
-	{
-		UClass* Class = CastChecked<UClass>(ClassRepInfoIt.Key().ResolveObjectPtr());
-		const FClassReplicationInfo& ClassInfo = ClassRepInfoIt.Value();
-		UE_LOG(LogShooterReplicationGraph, Log, TEXT("  %s (%s) -> %s"), *Class->GetName(), *GetNameSafe(GetParentNativeClass(Class)), *ClassInfo.BuildDebugStringDelta());
-	}
+		OutAppliedClasses.Add(Class);
 
+		if (Entry.bHasMapping)
+		{
+			ClassRepNodePolicies.Set(Class, Entry.Mapping);
+		}
 
-	// Rep destruct infos based on CVar value
-	DestructInfoMaxDistanceSquared = CVar_ShooterRepGraph_DestructionInfoMaxDist * CVar_ShooterRepGraph_DestructionInfoMaxDist;
+		if (Entry.bNonSpatializedChild)
+		{
+			NonSpatializedChildClasses.Add(Class);
+		}
 
-	// -------------------------------------------------------
-	//	Register for game code callbacks.
-	//	This could have been done the other way: E.g, AMyGameActor could do GetNetDriver()->GetReplicationDriver<UShooterReplicationGraph>()->OnMyGameEvent etc.
-	//	This way at least keeps the rep graph out of game code directly and allows rep graph to exist in its own module
-	//	So for now, erring on the side of a cleaning dependencies between classes.
-	// -------------------------------------------------------
-	
-	AShooterCharacter::NotifyEquipWeapon.AddUObject(this, &UShooterReplicationGraph::OnCharacterEquipWeapon);
-	AShooterCharacter::NotifyUnEquipWeapon.AddUObject(this, &UShooterReplicationGraph::OnCharacterUnEquipWeapon);
+		if (Entry.bHasClassInfo)
+		{
+			FClassReplicationInfo ClassInfo;
+			ClassInfo.SetCullDistanceSquared(Entry.CullDistanceSquared);
+			ClassInfo.ReplicationPeriodFrame = Entry.ReplicationPeriodFrame;
+			GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+		}
+	}
 
-#if WITH_GAMEPLAY_DEBUGGER
-	AGameplayDebuggerCategoryReplicator::NotifyDebuggerOwnerChange.AddUObject(this, &UShooterReplicationGraph::OnGameplayDebuggerOwnerChange);
-#endif
+	return Cache.Entries.Num() > 0;
 }
 
 void UShooterReplicationGraph::InitGlobalGraphNodes()
@@ -373,6 +616,20 @@ void UShooterReplicationGraph::InitGlobalGraphNodes()
 	
 	AddGlobalGraphNode(GridNode);
 
+	if (CVar_ShooterRepGraph_HierarchicalGrid > 0)
+	{
+		CoarseGridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+		CoarseGridNode->CellSize = CVar_ShooterRepGraph_CellSize * CVar_ShooterRepGraph_CoarseCellScale;
+		CoarseGridNode->SpatialBias = GridNode->SpatialBias;
+
+		if (CVar_ShooterRepGraph_DisableSpatialRebuilds)
+		{
+			CoarseGridNode->AddSpatialRebuildBlacklistClass(AActor::StaticClass());
+		}
+
+		AddGlobalGraphNode(CoarseGridNode);
+	}
+
 	// -----------------------------------------------
 	//	Always Relevant (to everyone) Actors
 	// -----------------------------------------------
@@ -382,8 +639,32 @@ void UShooterReplicationGraph::InitGlobalGraphNodes()
 	// -----------------------------------------------
 	//	Player State specialization. This will return a rolling subset of the player states to replicate
 	// -----------------------------------------------
-	UShooterReplicationGraphNode_PlayerStateFrequencyLimiter* PlayerStateNode = CreateNewNode<UShooterReplicationGraphNode_PlayerStateFrequencyLimiter>();
+	PlayerStateNode = CreateNewNode<UShooterReplicationGraphNode_PlayerStateFrequencyLimiter>();
+	PlayerStateNode->MinActorsPerFrame = FMath::Max(CVar_ShooterRepGraph_PlayerStateMinPerFrame, 1);
+	PlayerStateNode->MaxActorsPerFrame = FMath::Max(CVar_ShooterRepGraph_PlayerStateMaxPerFrame, PlayerStateNode->MinActorsPerFrame);
 	AddGlobalGraphNode(PlayerStateNode);
+
+	// -----------------------------------------------
+	//	Pawns culled by precomputed visibility. Inactive until a map with a PVS is loaded
+	// -----------------------------------------------
+	PVSNode = CreateNewNode<UShooterReplicationGraphNode_PVS>();
+	AddGlobalGraphNode(PVSNode);
+
+	// -----------------------------------------------
+	//	Teammates, always relevant to each other in team games
+	// -----------------------------------------------
+	TeamNode = CreateNewNode<UShooterReplicationGraphNode_TeamRelevancy>();
+	TeamNode->FarDistance = CVar_ShooterRepGraph_TeamFarDistance;
+	TeamNode->FarReplicationPeriodFrame = FMath::Max(CVar_ShooterRepGraph_TeamFarReplicationPeriodFrame, 1);
+	AddGlobalGraphNode(TeamNode);
+
+	// -----------------------------------------------
+	//	Cosmetic weapon fire, throttled by distance
+	// -----------------------------------------------
+	WeaponFireNode = CreateNewNode<UShooterReplicationGraphNode_WeaponFireInterest>();
+	WeaponFireNode->FireCullDistance = CVar_ShooterRepGraph_WeaponFireCullDistance;
+	WeaponFireNode->CulledReplicationPeriodFrame = FMath::Max(CVar_ShooterRepGraph_WeaponFireCulledPeriodFrame, 1);
+	AddGlobalGraphNode(WeaponFireNode);
 }
 
 void UShooterReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
@@ -406,6 +687,132 @@ EClassRepNodeMapping UShooterReplicationGraph::GetMappingPolicy(UClass* Class)
 	return Policy;
 }
 
+void UShooterReplicationGraph::InitializeActorsInWorld(UWorld* InWorld)
+{
+	// Size the grid and load the PVS before the world's actors get routed into them
+	ConfigureGridForWorld(InWorld);
+	InitPVSForWorld(InWorld);
+
+	Super::InitializeActorsInWorld(InWorld);
+}
+
+void UShooterReplicationGraph::ConfigureGridForWorld(UWorld* World)
+{
+	CoarseGridMinCullDistance = 0.f;
+
+	const bool bAutoSize = CVar_ShooterRepGraph_AutoSizeGrid != 0;
+	if (World == nullptr || (!bAutoSize && CoarseGridNode == nullptr))
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER( UShooterReplicationGraph_ConfigureGridForWorld );
+
+	// Bound everything that gets spatialized at load time, plus the player starts pawns will spawn at
+	FBox WorldBounds(ForceInit);
+	int32 NumSpatializedActors = 0;
+	for (AActor* Actor : TActorRange<AActor>(World))
+	{
+		if (Actor->IsA<APlayerStart>() || (Actor->GetIsReplicated() && IsSpatialized(GetMappingPolicy(Actor->GetClass()))))
+		{
+			WorldBounds += Actor->GetActorLocation();
+			NumSpatializedActors++;
+		}
+	}
+
+	const FVector WorldSize = WorldBounds.IsValid ? WorldBounds.GetSize() : FVector::ZeroVector;
+	const float MaxExtent = FMath::Max(WorldSize.X, WorldSize.Y);
+
+	if (!bAutoSize)
+	{
+		UE_LOG(LogShooterReplicationGraph, Display, TEXT("Grid auto sizing disabled, keeping CellSize %.0f and SpatialBias %s"), GridNode->CellSize, *GridNode->SpatialBias.ToString());
+	}
+	else if (!WorldBounds.IsValid)
+	{
+		UE_LOG(LogShooterReplicationGraph, Display, TEXT("No spatialized actors in %s, keeping grid CellSize %.0f and SpatialBias %s"), *World->GetName(), GridNode->CellSize, *GridNode->SpatialBias.ToString());
+	}
+	else
+	{
+		const float Area = FMath::Max(WorldSize.X * WorldSize.Y, 1.f);
+
+		// Cell area that holds TargetActorsPerCell actors on average, without exceeding MaxCellsPerAxis cells along the longest axis
+		float CellSize = FMath::Sqrt(Area * CVar_ShooterRepGraph_TargetActorsPerCell / NumSpatializedActors);
+		CellSize = FMath::Max(CellSize, MaxExtent / FMath::Max(CVar_ShooterRepGraph_MaxCellsPerAxis, 1));
+		CellSize = FMath::Clamp(CellSize, CVar_ShooterRepGraph_MinCellSize, CVar_ShooterRepGraph_MaxCellSize);
+
+		// Keep one cell of slack below the bounds so actors spawned slightly outside still land in a valid cell
+		GridNode->CellSize = CellSize;
+		GridNode->SpatialBias = FVector2D(WorldBounds.Min.X - CellSize, WorldBounds.Min.Y - CellSize);
+
+		UE_LOG(LogShooterReplicationGraph, Display, TEXT("Sized grid for %s: Bounds %s, %d spatialized actors, CellSize %.0f, SpatialBias %s"),
+			*World->GetName(), *WorldBounds.ToString(), NumSpatializedActors, GridNode->CellSize, *GridNode->SpatialBias.ToString());
+	}
+
+	// The coarse level follows the fine grid, whether it was sized here or configured
+	const bool bUseCoarseGrid = CoarseGridNode && (CVar_ShooterRepGraph_HierarchicalGrid == 1 || MaxExtent >= CVar_ShooterRepGraph_LargeMapExtent);
+	if (bUseCoarseGrid)
+	{
+		const float CellSize = GridNode->CellSize;
+		const float CoarseCellSize = CellSize * FMath::Max(CVar_ShooterRepGraph_CoarseCellScale, 1);
+		CoarseGridNode->CellSize = CoarseCellSize;
+		CoarseGridNode->SpatialBias = bAutoSize && WorldBounds.IsValid ? FVector2D(WorldBounds.Min.X - CoarseCellSize, WorldBounds.Min.Y - CoarseCellSize) : GridNode->SpatialBias;
+
+		// Spatialized actors are added to every cell within their cull distance. Past a couple of fine cells that's cheaper to do on the coarse level.
+		CoarseGridMinCullDistance = CellSize * 2.f;
+
+		UE_LOG(LogShooterReplicationGraph, Display, TEXT("Coarse grid for %s: CoarseCellSize %.0f for cull distances above %.0f"), *World->GetName(), CoarseGridNode->CellSize, CoarseGridMinCullDistance);
+	}
+}
+
+void UShooterReplicationGraph::InitPVSForWorld(UWorld* World)
+{
+	PVSNode->InitForWorld(World);
+
+	// Pawns routed before this PVS was loaded, or before it was dropped, move to the node that now handles them
+	const bool bUsePVS = PVSNode->IsActive();
+	for (TActorIterator<APawn> It(World); It; ++It)
+	{
+		APawn* Pawn = *It;
+		FGlobalActorReplicationInfo* GlobalInfo = GlobalActorReplicationInfoMap.Find(Pawn);
+		if (GlobalInfo == nullptr || TornOffActors.Contains(Pawn) || GetMappingPolicy(Pawn->GetClass()) != EClassRepNodeMapping::Spatialize_Dynamic)
+		{
+			continue;
+		}
+
+		FNewReplicatedActorInfo ActorInfo(Pawn);
+		const bool bWasInPVS = PVSNode->NotifyRemoveNetworkActor(ActorInfo, false);
+		if (bUsePVS)
+		{
+			if (!bWasInPVS)
+			{
+				UReplicationGraphNode_GridSpatialization2D* ActorGridNode = CoarseGridActors.Remove(Pawn) > 0 ? CoarseGridNode : GridNode;
+				ActorGridNode->RemoveActor_Dynamic(ActorInfo);
+			}
+			PVSNode->NotifyAddNetworkActor(ActorInfo);
+		}
+		else if (bWasInPVS)
+		{
+			GetGridNodeForActor(ActorInfo, *GlobalInfo)->AddActor_Dynamic(ActorInfo, *GlobalInfo);
+		}
+
+		if (AShooterCharacter* Character = Cast<AShooterCharacter>(Pawn))
+		{
+			Character->SetReplicationCulledByPVS(bUsePVS);
+		}
+	}
+}
+
+UReplicationGraphNode_GridSpatialization2D* UShooterReplicationGraph::GetGridNodeForActor(const FNewReplicatedActorInfo& ActorInfo, const FGlobalActorReplicationInfo& GlobalInfo)
+{
+	if (CoarseGridMinCullDistance > 0.f && GlobalInfo.Settings.GetCullDistanceSquared() > FMath::Square(CoarseGridMinCullDistance))
+	{
+		CoarseGridActors.Add(ActorInfo.Actor);
+		return CoarseGridNode;
+	}
+
+	return GridNode;
+}
+
 void UShooterReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
 {
 	EClassRepNodeMapping Policy = GetMappingPolicy(ActorInfo.Class);
@@ -413,6 +820,10 @@ void UShooterReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedA
 	{
 		case EClassRepNodeMapping::NotRouted:
 		{
+			if (ActorInfo.Class->IsChildOf(APlayerState::StaticClass()))
+			{
+				PlayerStateNode->NotifyAddNetworkActor(ActorInfo);
+			}
 			break;
 		}
 		
@@ -432,19 +843,43 @@ void UShooterReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedA
 
 		case EClassRepNodeMapping::Spatialize_Static:
 		{
-			GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+			GetGridNodeForActor(ActorInfo, GlobalInfo)->AddActor_Static(ActorInfo, GlobalInfo);
 			break;
 		}
 		
 		case EClassRepNodeMapping::Spatialize_Dynamic:
 		{
-			GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
-			break;
-		}
-		
-		case EClassRepNodeMapping::Spatialize_Dormancy:
-		{
-			GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+			const bool bIsPawn = ActorInfo.Class->IsChildOf(APawn::StaticClass());
+			if (bIsPawn)
+			{
+				TeamNode->NotifyAddNetworkActor(ActorInfo);
+			}
+
+			if (ActorInfo.Class->IsChildOf(AShooterCharacter::StaticClass()))
+			{
+				WeaponFireNode->NotifyAddNetworkActor(ActorInfo);
+			}
+
+			const bool bUsePVS = bIsPawn && PVSNode->IsActive();
+			if (bUsePVS)
+			{
+				PVSNode->NotifyAddNetworkActor(ActorInfo);
+			}
+			else
+			{
+				GetGridNodeForActor(ActorInfo, GlobalInfo)->AddActor_Dynamic(ActorInfo, GlobalInfo);
+			}
+
+			if (AShooterCharacter* Character = Cast<AShooterCharacter>(ActorInfo.Actor))
+			{
+				Character->SetReplicationCulledByPVS(bUsePVS);
+			}
+			break;
+		}
+		
+		case EClassRepNodeMapping::Spatialize_Dormancy:
+		{
+			GetGridNodeForActor(ActorInfo, GlobalInfo)->AddActor_Dormancy(ActorInfo, GlobalInfo);
 			break;
 		}
 	};
@@ -452,11 +887,22 @@ void UShooterReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedA
 
 void UShooterReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
 {
+	if (TornOffActors.Remove(ActorInfo.Actor) > 0)
+	{
+		return;
+	}
+
+	UReplicationGraphNode_GridSpatialization2D* ActorGridNode = CoarseGridActors.Remove(ActorInfo.Actor) > 0 ? CoarseGridNode : GridNode;
+
 	EClassRepNodeMapping Policy = GetMappingPolicy(ActorInfo.Class);
 	switch(Policy)
 	{
 		case EClassRepNodeMapping::NotRouted:
 		{
+			if (ActorInfo.Class->IsChildOf(APlayerState::StaticClass()))
+			{
+				PlayerStateNode->NotifyRemoveNetworkActor(ActorInfo);
+			}
 			break;
 		}
 		
@@ -479,24 +925,104 @@ void UShooterReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicat
 
 		case EClassRepNodeMapping::Spatialize_Static:
 		{
-			GridNode->RemoveActor_Static(ActorInfo);
+			ActorGridNode->RemoveActor_Static(ActorInfo);
 			break;
 		}
 		
 		case EClassRepNodeMapping::Spatialize_Dynamic:
 		{
-			GridNode->RemoveActor_Dynamic(ActorInfo);
+			TeamNode->NotifyRemoveNetworkActor(ActorInfo, false);
+			WeaponFireNode->NotifyRemoveNetworkActor(ActorInfo, false);
+
+			if (!PVSNode->NotifyRemoveNetworkActor(ActorInfo, false))
+			{
+				ActorGridNode->RemoveActor_Dynamic(ActorInfo);
+			}
 			break;
 		}
 		
 		case EClassRepNodeMapping::Spatialize_Dormancy:
 		{
-			GridNode->RemoveActor_Dormancy(ActorInfo);
+			ActorGridNode->RemoveActor_Dormancy(ActorInfo);
 			break;
 		}
 	};
 }
 
+int32 UShooterReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	int32 Result = 0;
+	{
+		SHOOTER_REPGRAPH_PROFILE_SCOPE(Profiler, ServerReplicateActors);
+		PreGather();
+		Result = Super::ServerReplicateActors(DeltaSeconds);
+	}
+
+	Profiler.PostServerReplicateActors(Connections, GetReplicationGraphFrame());
+	return Result;
+}
+
+void UShooterReplicationGraph::PreGather()
+{
+	// These don't ask Super::ServerReplicateActors to prepare them, their lists have to be final before the pre-gather reads them
+	PlayerStateNode->PrepareForReplication();
+	PVSNode->PrepareForReplication();
+
+	if (CVar_ShooterRepGraph_ParallelGather == 0)
+	{
+		return;
+	}
+
+	SHOOTER_REPGRAPH_PROFILE_SCOPE(Profiler, PreGather);
+
+	// Viewers are read from game objects, so they are collected here rather than on the workers
+	PreGatherConnections.Reset();
+	for (UNetReplicationGraphConnection* ConnectionManager : Connections)
+	{
+		UNetConnection* NetConnection = ConnectionManager->NetConnection;
+		if (NetConnection == nullptr || NetConnection->ViewTarget == nullptr || NetConnection->GetConnectionState() == USOCK_Closed)
+		{
+			continue;
+		}
+
+		FShooterPreGatherConnection& PreGatherConnection = PreGatherConnections.AddDefaulted_GetRef();
+		PreGatherConnection.ConnectionManager = ConnectionManager;
+		PreGatherConnection.Viewers.Emplace(NetConnection, 0.f);
+		for (UNetConnection* Child : NetConnection->Children)
+		{
+			if (Child->ViewTarget != nullptr)
+			{
+				PreGatherConnection.Viewers.Emplace(Child, 0.f);
+			}
+		}
+	}
+
+	PlayerStateNode->BeginPreGather(PreGatherConnections);
+	PVSNode->BeginPreGather(PreGatherConnections);
+	WeaponFireNode->BeginPreGather(PreGatherConnections, GetReplicationGraphFrame());
+
+	// Each worker only writes the results of its own connection. Everything else is read only until the gather
+	ParallelFor(PreGatherConnections.Num(), [this](int32 Idx)
+	{
+		const FShooterPreGatherConnection& PreGatherConnection = PreGatherConnections[Idx];
+		PlayerStateNode->PreGatherForConnection(PreGatherConnection);
+		PVSNode->PreGatherForConnection(PreGatherConnection);
+		WeaponFireNode->PreGatherForConnection(PreGatherConnection);
+	}, PreGatherConnections.Num() < CVar_ShooterRepGraph_ParallelGatherMinConnections);
+}
+
+void UShooterReplicationGraph::NotifyActorTearOff(AActor* Actor)
+{
+	Super::NotifyActorTearOff(Actor);
+
+	// The TearOff_ForConnection nodes replicate the actor to each connection one last time. Stop considering it anywhere else now rather than when it gets destroyed.
+	if (Actor && !TornOffActors.Contains(Actor))
+	{
+		RouteRemoveNetworkActorToNodes(FNewReplicatedActorInfo(Actor));
+		TornOffActors.Add(Actor);
+	}
+}
+
 // Since we listen to global (static) events, we need to watch out for cross world broadcasts (PIE)
 #if WITH_EDITOR
 #define CHECK_WORLDS(X) if(X->GetWorld() != GetWorld()) return;
@@ -524,6 +1050,26 @@ void UShooterReplicationGraph::OnCharacterUnEquipWeapon(AShooterCharacter* Chara
 	}
 }
 
+void UShooterReplicationGraph::OnPlayerStateScoreChanged(AShooterPlayerState* PlayerState)
+{
+	if (PlayerState && PlayerStateNode)
+	{
+		CHECK_WORLDS(PlayerState);
+
+		PlayerStateNode->NotifyScoreChanged(PlayerState);
+	}
+}
+
+void UShooterReplicationGraph::OnPlayerStateTeamChanged(AShooterPlayerState* PlayerState)
+{
+	if (PlayerState && TeamNode)
+	{
+		CHECK_WORLDS(PlayerState);
+
+		TeamNode->NotifyTeamChanged();
+	}
+}
+
 #if WITH_GAMEPLAY_DEBUGGER
 void UShooterReplicationGraph::OnGameplayDebuggerOwnerChange(AGameplayDebuggerCategoryReplicator* Debugger, APlayerController* OldOwner)
 {
@@ -567,15 +1113,66 @@ void UShooterReplicationGraph::OnGameplayDebuggerOwnerChange(AGameplayDebuggerCa
 void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::ResetGameWorldState()
 {
 	AlwaysRelevantStreamingLevelsNeedingReplication.Empty();
+	NotifyResetAllNetworkActors();
 }
 
-void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::NotifyResetAllNetworkActors()
 {
-	QUICK_SCOPE_CYCLE_COUNTER( UShooterReplicationGraphNode_AlwaysRelevant_ForConnection_GatherActorListsForConnection );
+	// Forces a rebuild on the next gather
+	CachedViewerStates.Reset();
+	ReplicationActorList.Reset();
+	PlayerStateActorList.Reset();
+}
 
-	UShooterReplicationGraph* ShooterGraph = CastChecked<UShooterReplicationGraph>(GetOuter());
+bool UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::UpdateCachedViewerStates(const FConnectionGatherActorListParameters& Params)
+{
+	bool bChanged = CachedViewerStates.Num() != Params.Viewers.Num();
+	CachedViewerStates.SetNum(Params.Viewers.Num());
+
+	for (int32 ViewerIdx = 0; ViewerIdx < Params.Viewers.Num(); ++ViewerIdx)
+	{
+		const FNetViewer& CurViewer = Params.Viewers[ViewerIdx];
+
+		FCachedViewerState ViewerState;
+		ViewerState.InViewer = CurViewer.InViewer;
+		ViewerState.ViewTarget = CurViewer.ViewTarget;
+
+		if (AShooterPlayerController* PC = Cast<AShooterPlayerController>(CurViewer.InViewer))
+		{
+			ViewerState.PlayerState = PC->PlayerState;
+
+			// Inventory only changes wholesale (spawn, death), so its size is enough to notice it
+			if (AShooterCharacter* Pawn = Cast<AShooterCharacter>(PC->GetPawn()))
+			{
+				ViewerState.Pawn = Pawn;
+				ViewerState.InventoryCount = Pawn->GetInventoryCount();
+			}
+		}
+
+		if (!(ViewerState == CachedViewerStates[ViewerIdx]))
+		{
+			CachedViewerStates[ViewerIdx] = ViewerState;
+			bChanged = true;
+		}
+	}
+
+#if WITH_GAMEPLAY_DEBUGGER
+	if (CachedGameplayDebugger != GameplayDebugger)
+	{
+		CachedGameplayDebugger = GameplayDebugger;
+		bChanged = true;
+	}
+#endif
+
+	return bChanged;
+}
+
+void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::RebuildActorLists(const FConnectionGatherActorListParameters& Params)
+{
+	QUICK_SCOPE_CYCLE_COUNTER( UShooterReplicationGraphNode_AlwaysRelevant_ForConnection_RebuildActorLists );
 
 	ReplicationActorList.Reset();
+	PlayerStateActorList.Reset();
 
 	auto ResetActorCullDistance = [&](AActor* ActorToSet, AActor*& LastActor) {
 
@@ -596,22 +1193,13 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorLists
 
 		if (AShooterPlayerController* PC = Cast<AShooterPlayerController>(CurViewer.InViewer))
 		{
-			// 50% throttling of PlayerStates.
-			const bool bReplicatePS = (Params.ConnectionManager.ConnectionOrderNum % 2) == (Params.ReplicationFrameNum % 2);
-			if (bReplicatePS)
+			// Always return the player state to the owning player. Simulated proxy player states are handled by UShooterReplicationGraphNode_PlayerStateFrequencyLimiter
+			if (APlayerState* PS = PC->PlayerState)
 			{
-				// Always return the player state to the owning player. Simulated proxy player states are handled by UShooterReplicationGraphNode_PlayerStateFrequencyLimiter
-				if (APlayerState* PS = PC->PlayerState)
-				{
-					if (!bInitializedPlayerState)
-					{
-						bInitializedPlayerState = true;
-						FConnectionReplicationActorInfo& ConnectionActorInfo = Params.ConnectionManager.ActorInfoMap.FindOrAdd(PS);
-						ConnectionActorInfo.ReplicationPeriodFrame = 1;
-					}
+				FConnectionReplicationActorInfo& ConnectionActorInfo = Params.ConnectionManager.ActorInfoMap.FindOrAdd(PS);
+				ConnectionActorInfo.ReplicationPeriodFrame = 1;
 
-					ReplicationActorList.ConditionalAdd(PS);
-				}
+				PlayerStateActorList.ConditionalAdd(PS);
 			}
 
 			FAlwaysRelevantActorInfo* LastData = PastRelevantActors.FindByKey<UNetConnection*>(CurViewer.Connection);
@@ -657,11 +1245,49 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorLists
 		return RelActorInfo.Connection == nullptr;
 	});
 
-	Params.OutGatheredReplicationLists.AddReplicationActorList(ReplicationActorList);
+#if WITH_GAMEPLAY_DEBUGGER
+	if (GameplayDebugger)
+	{
+		ReplicationActorList.ConditionalAdd(GameplayDebugger);
+	}
+#endif
+}
+
+void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	SHOOTER_REPGRAPH_PROFILE_SCOPE(GetGraphProfiler(this), AlwaysRelevant);
+
+	if (UpdateCachedViewerStates(Params))
+	{
+		RebuildActorLists(Params);
+	}
+
+	if (ReplicationActorList.Num() > 0)
+	{
+		Params.OutGatheredReplicationLists.AddReplicationActorList(ReplicationActorList);
+	}
+
+	// 50% throttling of PlayerStates.
+	const bool bReplicatePS = (Params.ConnectionManager.ConnectionOrderNum % 2) == (Params.ReplicationFrameNum % 2);
+	if (bReplicatePS && PlayerStateActorList.Num() > 0)
+	{
+		Params.OutGatheredReplicationLists.AddReplicationActorList(PlayerStateActorList);
+	}
+
+	// Newly visible levels are checked right away, the rest at a staggered interval
+	const int32 DormancyCheckFrames = FMath::Max(CVar_ShooterRepGraph_StreamingLevelDormancyCheckFrames, 1);
+	const bool bCheckDormancy = bStreamingLevelsAdded || ((Params.ReplicationFrameNum + Params.ConnectionManager.ConnectionOrderNum) % DormancyCheckFrames) == 0;
+	bStreamingLevelsAdded = false;
 
+	GatherStreamingLevelActorLists(Params, bCheckDormancy);
+}
+
+void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherStreamingLevelActorLists(const FConnectionGatherActorListParameters& Params, bool bCheckDormancy)
+{
 	// Always relevant streaming level actors.
 	FPerConnectionActorInfoMap& ConnectionActorInfoMap = Params.ConnectionManager.ActorInfoMap;
 	
+	UShooterReplicationGraph* ShooterGraph = CastChecked<UShooterReplicationGraph>(GetOuter());
 	TMap<FName, FActorRepListRefView>& AlwaysRelevantStreamingLevelActors = ShooterGraph->AlwaysRelevantStreamingLevelActors;
 
 	for (int32 Idx=AlwaysRelevantStreamingLevelsNeedingReplication.Num()-1; Idx >= 0; --Idx)
@@ -681,14 +1307,17 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorLists
 
 		if (RepList.Num() > 0)
 		{
-			bool bAllDormant = true;
-			for (FActorRepListType Actor : RepList)
+			bool bAllDormant = bCheckDormancy;
+			if (bCheckDormancy)
 			{
-				FConnectionReplicationActorInfo& ConnectionActorInfo = ConnectionActorInfoMap.FindOrAdd(Actor);
-				if (ConnectionActorInfo.bDormantOnConnection == false)
+				for (FActorRepListType Actor : RepList)
 				{
-					bAllDormant = false;
-					break;
+					FConnectionReplicationActorInfo& ConnectionActorInfo = ConnectionActorInfoMap.FindOrAdd(Actor);
+					if (ConnectionActorInfo.bDormantOnConnection == false)
+					{
+						bAllDormant = false;
+						break;
+					}
 				}
 			}
 
@@ -709,19 +1338,13 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorLists
 		}
 
 	}
-
-#if WITH_GAMEPLAY_DEBUGGER
-	if (GameplayDebugger)
-	{
-		ReplicationActorList.ConditionalAdd(GameplayDebugger);
-	}
-#endif
 }
 
 void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::OnClientLevelVisibilityAdd(FName LevelName, UWorld* StreamingWorld)
 {
 	UE_CLOG(CVar_ShooterRepGraph_DisplayClientLevelStreaming > 0, LogShooterReplicationGraph, Display, TEXT("CLIENTSTREAMING ::OnClientLevelVisibilityAdd - %s"), *LevelName.ToString());
 	AlwaysRelevantStreamingLevelsNeedingReplication.Add(LevelName);
+	bStreamingLevelsAdded = true;
 }
 
 void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::OnClientLevelVisibilityRemove(FName LevelName)
@@ -735,6 +1358,7 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::LogNode(FReplica
 	DebugInfo.Log(NodeName);
 	DebugInfo.PushIndent();
 	LogActorRepList(DebugInfo, NodeName, ReplicationActorList);
+	LogActorRepList(DebugInfo, TEXT("PlayerStates"), PlayerStateActorList);
 
 	for (const FName& LevelName : AlwaysRelevantStreamingLevelsNeedingReplication)
 	{
@@ -752,44 +1376,184 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::LogNode(FReplica
 
 UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::UShooterReplicationGraphNode_PlayerStateFrequencyLimiter()
 {
-	bRequiresPrepareForReplicationCall = true;
+	// Prepared by UShooterReplicationGraph::PreGather
+	bRequiresPrepareForReplicationCall = false;
+}
+
+void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo)
+{
+	PlayerStates.ConditionalAdd(ActorInfo.Actor);
+}
+
+bool UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound)
+{
+	ScoreChangedFrames.Remove(ActorInfo.Actor);
+
+	// Order doesn't matter, the rolling set just continues from wherever it is
+	const bool bRemoved = PlayerStates.RemoveFast(ActorInfo.Actor);
+	if (!bRemoved && bWarnIfNotFound)
+	{
+		UE_LOG(LogShooterReplicationGraph, Warning, TEXT("Attempted to remove %s from PlayerStateFrequencyLimiter but it was not found."), *GetActorRepListTypeDebugString(ActorInfo.Actor));
+	}
+
+	return bRemoved;
+}
+
+void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::NotifyResetAllNetworkActors()
+{
+	Super::NotifyResetAllNetworkActors();
+
+	PlayerStates.Reset();
+	ScoreChangedFrames.Reset();
+	ConnectionActorLists.Reset();
+	PreGatheredActors.Reset();
+	RollingStartIdx = 0;
+}
+
+void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::NotifyScoreChanged(APlayerState* PlayerState)
+{
+	ScoreChangedFrames.Add(PlayerState, GraphGlobals->ReplicationGraph->GetReplicationGraphFrame());
+}
+
+float UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::GetBandwidthHeadroom(const UNetConnection* NetConnection)
+{
+	if (NetConnection == nullptr || NetConnection->Driver == nullptr || NetConnection->CurrentNetSpeed <= 0)
+	{
+		return 0.f;
+	}
+
+	// QueuedBits goes negative as bandwidth goes unused, down to two frames worth of credit (see UNetConnection::Tick)
+	const float BitsPerFrame = NetConnection->CurrentNetSpeed * 8.f / FMath::Max(NetConnection->Driver->NetServerMaxTickRate, 1);
+	return FMath::Clamp(-NetConnection->QueuedBits / (2.f * BitsPerFrame), 0.f, 1.f);
 }
 
 void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::PrepareForReplication()
 {
-	QUICK_SCOPE_CYCLE_COUNTER( UShooterReplicationGraphNode_PlayerStateFrequencyLimiter_GlobalPrepareForReplication );
+	SHOOTER_REPGRAPH_PROFILE_SCOPE(GetGraphProfiler(this), PlayerStateLimiter);
 
-	ReplicationActorLists.Reset();
 	ForceNetUpdateReplicationActorList.Reset();
 
-	ReplicationActorLists.AddDefaulted();
-	FActorRepListRefView* CurrentList = &ReplicationActorLists[0];
+	const int32 NumPlayerStates = PlayerStates.Num();
+	if (NumPlayerStates == 0)
+	{
+		ScoreChangedFrames.Reset();
+		ConnectionActorLists.Reset();
+		RollingStartIdx = 0;
+		return;
+	}
 
-	// We rebuild our lists of player states each frame. This is not as efficient as it could be but its the simplest way
-	// to handle players disconnecting and keeping the lists compact. If the lists were persistent we would need to defrag them as players left.
+	RollingStartIdx = (RollingStartIdx + MinActorsPerFrame) % NumPlayerStates;
 
-	for (TActorIterator<APlayerState> It(GetWorld()); It; ++It)
+	// Once the rolling set passed over a player state, every connection has been handed its change at least once
+	const uint32 FrameNum = GraphGlobals->ReplicationGraph->GetReplicationGraphFrame();
+	const uint32 FramesPerRollingPass = FMath::DivideAndRoundUp(NumPlayerStates, MinActorsPerFrame);
+	for (auto It = ScoreChangedFrames.CreateIterator(); It; ++It)
 	{
-		APlayerState* PS = *It;
-		if (IsActorValidForReplicationGather(PS) == false)
+		if (FrameNum - It.Value() > FramesPerRollingPass)
 		{
-			continue;
+			It.RemoveCurrent();
 		}
+	}
 
-		if (CurrentList->Num() >= TargetActorsPerFrame)
+	for (auto It = ConnectionActorLists.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
 		{
-			ReplicationActorLists.AddDefaulted();
-			CurrentList = &ReplicationActorLists.Last(); 
+			It.RemoveCurrent();
 		}
-		
-		CurrentList->Add(PS);
-	}	
+	}
+}
+
+void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::BeginPreGather(const TArray<FShooterPreGatherConnection>& Connections)
+{
+	PreGatherFrame = GFrameCounter;
+	PreGatheredActors.Reset();
+
+	if (PlayerStates.Num() > 0)
+	{
+		for (const FShooterPreGatherConnection& Connection : Connections)
+		{
+			PreGatheredActors.Add(Connection.ConnectionManager);
+		}
+	}
+}
+
+void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::PreGatherForConnection(const FShooterPreGatherConnection& Connection)
+{
+	if (TArray<FActorRepListType>* Actors = PreGatheredActors.Find(Connection.ConnectionManager))
+	{
+		BuildActorListForConnection(*Connection.ConnectionManager, *Actors);
+	}
+}
+
+void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::BuildActorListForConnection(const UNetReplicationGraphConnection& ConnectionManager, TArray<FActorRepListType>& OutActors) const
+{
+	OutActors.Reset();
+
+	const int32 NumPlayerStates = PlayerStates.Num();
+	const float Headroom = GetBandwidthHeadroom(ConnectionManager.NetConnection);
+	const int32 TargetActorsPerFrame = FMath::Min(FMath::RoundToInt(FMath::Lerp((float)MinActorsPerFrame, (float)MaxActorsPerFrame, Headroom)), NumPlayerStates);
+
+	// Changed since this connection last received it
+	auto IsChangePending = [&ConnectionManager](const FActorRepListType& PS, uint32 ChangedFrame)
+	{
+		const FConnectionReplicationActorInfo* ConnectionActorInfo = ConnectionManager.ActorInfoMap.Find(PS);
+		return ConnectionActorInfo == nullptr || ConnectionActorInfo->LastRepFrameNum <= ChangedFrame;
+	};
+
+	// Pending changes go first
+	for (const TPair<FActorRepListType, uint32>& ChangedPair : ScoreChangedFrames)
+	{
+		if (OutActors.Num() >= TargetActorsPerFrame)
+		{
+			break;
+		}
+
+		if (IsChangePending(ChangedPair.Key, ChangedPair.Value) && IsActorValidForReplicationGather(ChangedPair.Key))
+		{
+			OutActors.Add(ChangedPair.Key);
+		}
+	}
+
+	// Fill the rest of the budget from the rolling set, skipping the pending changes handled above
+	for (int32 Offset = 0; Offset < NumPlayerStates && OutActors.Num() < TargetActorsPerFrame; ++Offset)
+	{
+		FActorRepListType PS = PlayerStates[(RollingStartIdx + Offset) % NumPlayerStates];
+		const uint32* ChangedFrame = ScoreChangedFrames.Find(PS);
+		if ((ChangedFrame == nullptr || !IsChangePending(PS, *ChangedFrame)) && IsActorValidForReplicationGather(PS))
+		{
+			OutActors.Add(PS);
+		}
+	}
 }
 
 void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
 {
-	const int32 ListIdx = Params.ReplicationFrameNum % ReplicationActorLists.Num();
-	Params.OutGatheredReplicationLists.AddReplicationActorList(ReplicationActorLists[ListIdx]);
+	SHOOTER_REPGRAPH_PROFILE_SCOPE(GetGraphProfiler(this), PlayerStateLimiter);
+
+	if (PlayerStates.Num() > 0)
+	{
+		// Built by the pre-gather, unless it is off or the connection wasn't ready then
+		const TArray<FActorRepListType>* Actors = (PreGatherFrame == GFrameCounter) ? PreGatheredActors.Find(&Params.ConnectionManager) : nullptr;
+		TArray<FActorRepListType> GatheredActors;
+		if (Actors == nullptr)
+		{
+			BuildActorListForConnection(Params.ConnectionManager, GatheredActors);
+			Actors = &GatheredActors;
+		}
+
+		FActorRepListRefView& ReplicationActorList = ConnectionActorLists.FindOrAdd(&Params.ConnectionManager);
+		ReplicationActorList.Reset();
+		for (FActorRepListType Actor : *Actors)
+		{
+			ReplicationActorList.Add(Actor);
+		}
+
+		if (ReplicationActorList.Num() > 0)
+		{
+			Params.OutGatheredReplicationLists.AddReplicationActorList(ReplicationActorList);
+		}
+	}
 
 	if (ForceNetUpdateReplicationActorList.Num() > 0)
 	{
@@ -802,39 +1566,666 @@ void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::LogNode(FReplicat
 	DebugInfo.Log(NodeName);
 	DebugInfo.PushIndent();	
 
-	int32 i=0;
-	for (const FActorRepListRefView& List : ReplicationActorLists)
-	{
-		LogActorRepList(DebugInfo, FString::Printf(TEXT("Bucket[%d]"), i++), List);
-	}
+	DebugInfo.Log(FString::Printf(TEXT("%d-%d per frame, rolling set starts at %d, %d with changed score"), MinActorsPerFrame, MaxActorsPerFrame, RollingStartIdx, ScoreChangedFrames.Num()));
+	LogActorRepList(DebugInfo, TEXT("PlayerStates"), PlayerStates);
 
 	DebugInfo.PopIndent();
 }
 
 // ------------------------------------------------------------------------------
 
-void UShooterReplicationGraph::PrintRepNodePolicies()
+UShooterReplicationGraphNode_PVS::UShooterReplicationGraphNode_PVS()
 {
-	UEnum* Enum = StaticEnum<EClassRepNodeMapping>();
-	if (!Enum)
+	// Prepared by UShooterReplicationGraph::PreGather
+	bRequiresPrepareForReplicationCall = false;
+}
+
+void UShooterReplicationGraphNode_PVS::InitForWorld(UWorld* World)
+{
+	PVSData.Reset();
+
+	if (World == nullptr || CVar_ShooterRepGraph_UsePVS == 0)
 	{
 		return;
 	}
 
-	GLog->Logf(TEXT("===================================="));
-	GLog->Logf(TEXT("Shooter Replication Routing Policies"));
-	GLog->Logf(TEXT("===================================="));
-
-	for (auto It = ClassRepNodePolicies.CreateIterator(); It; ++It)
+	const FString MapName = FShooterPVSData::GetMapName(World);
+	if (PVSData.Load(MapName))
 	{
-		FObjectKey ObjKey = It.Key();
-		
-		EClassRepNodeMapping Mapping = It.Value();
+		UE_LOG(LogShooterReplicationGraph, Display, TEXT("Loaded PVS for %s: %dx%d cells of %.0f"), *MapName, PVSData.NumCellsX, PVSData.NumCellsY, PVSData.CellSize);
+	}
+	else
+	{
+		UE_LOG(LogShooterReplicationGraph, Log, TEXT("No PVS for %s (%s), pawns use the spatialization grid"), *MapName, *FShooterPVSData::GetFilename(MapName));
+	}
+}
 
-		GLog->Logf(TEXT("%-40s --> %s"), *GetNameSafe(ObjKey.ResolveObjectPtr()), *Enum->GetNameStringByValue(static_cast<uint32>(Mapping)));
+void UShooterReplicationGraphNode_PVS::NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo)
+{
+	Actors.ConditionalAdd(ActorInfo.Actor);
+}
+
+bool UShooterReplicationGraphNode_PVS::NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound)
+{
+	const bool bRemoved = Actors.RemoveFast(ActorInfo.Actor);
+	if (!bRemoved && bWarnIfNotFound)
+	{
+		UE_LOG(LogShooterReplicationGraph, Warning, TEXT("Attempted to remove %s from PVS node but it was not found."), *GetActorRepListTypeDebugString(ActorInfo.Actor));
 	}
+
+	return bRemoved;
+}
+
+void UShooterReplicationGraphNode_PVS::NotifyResetAllNetworkActors()
+{
+	Super::NotifyResetAllNetworkActors();
+
+	Actors.Reset();
+	CellActorLists.Reset();
+	OccupiedCells.Reset();
+	OutsideActors.Reset();
+	PreGatheredCells.Reset();
 }
 
+void UShooterReplicationGraphNode_PVS::PrepareForReplication()
+{
+	SHOOTER_REPGRAPH_PROFILE_SCOPE(GetGraphProfiler(this), PVS);
+
+	for (int32 CellIdx : OccupiedCells)
+	{
+		CellActorLists.FindChecked(CellIdx).Reset();
+	}
+
+	OccupiedCells.Reset();
+	OutsideActors.Reset();
+
+	if (!IsActive())
+	{
+		return;
+	}
+
+	for (FActorRepListType Actor : Actors)
+	{
+		if (!IsActorValidForReplicationGather(Actor))
+		{
+			continue;
+		}
+
+		const int32 CellIdx = PVSData.GetCellIndex(Actor->GetActorLocation());
+		if (CellIdx == INDEX_NONE)
+		{
+			OutsideActors.Add(Actor);
+			continue;
+		}
+
+		FActorRepListRefView& CellActorList = CellActorLists.FindOrAdd(CellIdx);
+		if (CellActorList.Num() == 0)
+		{
+			OccupiedCells.Add(CellIdx);
+		}
+
+		CellActorList.Add(Actor);
+	}
+}
+
+void UShooterReplicationGraphNode_PVS::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	SHOOTER_REPGRAPH_PROFILE_SCOPE(GetGraphProfiler(this), PVS);
+
+	if (!IsActive())
+	{
+		// PVS was dropped while actors were routed here, don't cull them
+		if (Actors.Num() > 0)
+		{
+			Params.OutGatheredReplicationLists.AddReplicationActorList(Actors);
+		}
+		return;
+	}
+
+	if (OutsideActors.Num() > 0)
+	{
+		Params.OutGatheredReplicationLists.AddReplicationActorList(OutsideActors);
+	}
+
+	// Found by the pre-gather, unless it is off or the connection wasn't ready then
+	const TArray<int32>* VisibleCells = (PreGatherFrame == GFrameCounter) ? PreGatheredCells.Find(&Params.ConnectionManager) : nullptr;
+	TArray<int32> GatheredCells;
+	if (VisibleCells == nullptr)
+	{
+		GetVisibleCells(Params.Viewers, GatheredCells);
+		VisibleCells = &GatheredCells;
+	}
+
+	for (int32 CellIdx : *VisibleCells)
+	{
+		Params.OutGatheredReplicationLists.AddReplicationActorList(CellActorLists.FindChecked(CellIdx));
+	}
+}
+
+void UShooterReplicationGraphNode_PVS::BeginPreGather(const TArray<FShooterPreGatherConnection>& Connections)
+{
+	PreGatherFrame = GFrameCounter;
+	PreGatheredCells.Reset();
+
+	if (IsActive())
+	{
+		for (const FShooterPreGatherConnection& Connection : Connections)
+		{
+			PreGatheredCells.Add(Connection.ConnectionManager);
+		}
+	}
+}
+
+void UShooterReplicationGraphNode_PVS::PreGatherForConnection(const FShooterPreGatherConnection& Connection)
+{
+	if (TArray<int32>* VisibleCells = PreGatheredCells.Find(Connection.ConnectionManager))
+	{
+		GetVisibleCells(Connection.Viewers, *VisibleCells);
+	}
+}
+
+void UShooterReplicationGraphNode_PVS::GetVisibleCells(const FNetViewerArray& Viewers, TArray<int32>& OutCells) const
+{
+	OutCells.Reset();
+
+	TArray<int32, TInlineAllocator<4> > ViewerCells;
+	for (const FNetViewer& CurViewer : Viewers)
+	{
+		ViewerCells.AddUnique(PVSData.GetCellIndex(CurViewer.ViewLocation));
+	}
+
+	for (int32 CellIdx : OccupiedCells)
+	{
+		for (int32 ViewerCell : ViewerCells)
+		{
+			// Viewers outside of the grid see everything
+			if (ViewerCell == INDEX_NONE || PVSData.IsVisible(ViewerCell, CellIdx))
+			{
+				OutCells.Add(CellIdx);
+				break;
+			}
+		}
+	}
+}
+
+void UShooterReplicationGraphNode_PVS::LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const
+{
+	DebugInfo.Log(NodeName);
+	DebugInfo.PushIndent();
+
+	if (IsActive())
+	{
+		DebugInfo.Log(FString::Printf(TEXT("%dx%d cells of %.0f, %d occupied"), PVSData.NumCellsX, PVSData.NumCellsY, PVSData.CellSize, OccupiedCells.Num()));
+	}
+	else
+	{
+		DebugInfo.Log(TEXT("Inactive, no PVS for this map"));
+	}
+
+	LogActorRepList(DebugInfo, TEXT("Actors"), Actors);
+	LogActorRepList(DebugInfo, TEXT("Outside"), OutsideActors);
+
+	DebugInfo.PopIndent();
+}
+
+// ------------------------------------------------------------------------------
+
+UShooterReplicationGraphNode_TeamRelevancy::UShooterReplicationGraphNode_TeamRelevancy()
+{
+	bRequiresPrepareForReplicationCall = true;
+}
+
+void UShooterReplicationGraphNode_TeamRelevancy::NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo)
+{
+	Pawns.ConditionalAdd(ActorInfo.Actor);
+}
+
+bool UShooterReplicationGraphNode_TeamRelevancy::NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound)
+{
+	const bool bRemoved = Pawns.RemoveFast(ActorInfo.Actor);
+	if (!bRemoved && bWarnIfNotFound)
+	{
+		UE_LOG(LogShooterReplicationGraph, Warning, TEXT("Attempted to remove %s from team relevancy node but it was not found."), *GetActorRepListTypeDebugString(ActorInfo.Actor));
+	}
+
+	return bRemoved;
+}
+
+void UShooterReplicationGraphNode_TeamRelevancy::NotifyResetAllNetworkActors()
+{
+	Super::NotifyResetAllNetworkActors();
+
+	Pawns.Reset();
+	TeamPawns.Reset();
+	bTeamsChanged = false;
+}
+
+void UShooterReplicationGraphNode_TeamRelevancy::NotifyTeamChanged()
+{
+	bTeamsChanged = true;
+}
+
+void UShooterReplicationGraphNode_TeamRelevancy::RestoreConnectionSettings()
+{
+	QUICK_SCOPE_CYCLE_COUNTER( UShooterReplicationGraphNode_TeamRelevancy_RestoreConnectionSettings );
+
+	UShooterReplicationGraph* ShooterGraph = CastChecked<UShooterReplicationGraph>(GetOuter());
+	for (UNetReplicationGraphConnection* ConnectionManager : ShooterGraph->GetConnections())
+	{
+		UNetConnection* NetConnection = ConnectionManager->NetConnection;
+
+		for (FActorRepListType Pawn : Pawns)
+		{
+			// The connection's own pawn and view target keep the zero cull distance UShooterReplicationGraphNode_AlwaysRelevant_ForConnection gave them
+			if (Pawn->GetNetConnection() == NetConnection || (NetConnection && NetConnection->ViewTarget == Pawn))
+			{
+				continue;
+			}
+
+			FConnectionReplicationActorInfo* ConnectionActorInfo = ConnectionManager->ActorInfoMap.Find(Pawn);
+			FGlobalActorReplicationInfo* GlobalInfo = GraphGlobals->GlobalActorReplicationInfoMap->Find(Pawn);
+			if (ConnectionActorInfo && GlobalInfo)
+			{
+				ConnectionActorInfo->SetCullDistanceSquared(GlobalInfo->Settings.GetCullDistanceSquared());
+				ConnectionActorInfo->ReplicationPeriodFrame = GlobalInfo->Settings.ReplicationPeriodFrame;
+			}
+		}
+	}
+}
+
+void UShooterReplicationGraphNode_TeamRelevancy::PrepareForReplication()
+{
+	SHOOTER_REPGRAPH_PROFILE_SCOPE(GetGraphProfiler(this), TeamRelevancy);
+
+	for (TPair<int32, FActorRepListRefView>& TeamPair : TeamPawns)
+	{
+		TeamPair.Value.Reset();
+	}
+
+	// Former teammates may still have settings from this node on some connections, gather below sets them again for current teammates
+	if (bTeamsChanged)
+	{
+		bTeamsChanged = false;
+		RestoreConnectionSettings();
+	}
+
+	const AShooterGameState* GameState = GetWorld() ? GetWorld()->GetGameState<AShooterGameState>() : nullptr;
+	bTeamGame = GameState && GameState->NumTeams > 1;
+	if (!bTeamGame)
+	{
+		return;
+	}
+
+	// Team comes from the player state, which isn't known yet when the pawn is added, so teams are bucketed each frame
+	for (FActorRepListType Actor : Pawns)
+	{
+		APawn* Pawn = CastChecked<APawn>(Actor);
+		AShooterPlayerState* PlayerState = Cast<AShooterPlayerState>(Pawn->GetPlayerState());
+		if (PlayerState && IsActorValidForReplicationGather(Pawn))
+		{
+			TeamPawns.FindOrAdd(PlayerState->GetTeamNum()).Add(Pawn);
+		}
+	}
+}
+
+void UShooterReplicationGraphNode_TeamRelevancy::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	SHOOTER_REPGRAPH_PROFILE_SCOPE(GetGraphProfiler(this), TeamRelevancy);
+
+	if (!bTeamGame)
+	{
+		return;
+	}
+
+	const float FarDistanceSquared = FMath::Square(FarDistance);
+
+	TArray<int32, TInlineAllocator<2> > GatheredTeams;
+	for (const FNetViewer& CurViewer : Params.Viewers)
+	{
+		APlayerController* PC = Cast<APlayerController>(CurViewer.InViewer);
+		AShooterPlayerState* PlayerState = PC ? Cast<AShooterPlayerState>(PC->PlayerState) : nullptr;
+		if (PlayerState == nullptr || GatheredTeams.Contains(PlayerState->GetTeamNum()))
+		{
+			continue;
+		}
+
+		FActorRepListRefView* Teammates = TeamPawns.Find(PlayerState->GetTeamNum());
+		if (Teammates == nullptr || Teammates->Num() == 0)
+		{
+			continue;
+		}
+
+		GatheredTeams.Add(PlayerState->GetTeamNum());
+
+		for (FActorRepListType Teammate : *Teammates)
+		{
+			const FGlobalActorReplicationInfo* GlobalInfo = GraphGlobals->GlobalActorReplicationInfoMap->Find(Teammate);
+			if (GlobalInfo == nullptr)
+			{
+				continue;
+			}
+
+			const bool bFar = FVector::DistSquared(Teammate->GetActorLocation(), CurViewer.ViewLocation) > FarDistanceSquared;
+			const uint32 ClassPeriodFrame = GlobalInfo->Settings.ReplicationPeriodFrame;
+
+			FConnectionReplicationActorInfo& ConnectionActorInfo = Params.ConnectionManager.ActorInfoMap.FindOrAdd(Teammate);
+			ConnectionActorInfo.SetCullDistanceSquared(0.f);
+			ConnectionActorInfo.ReplicationPeriodFrame = bFar ? FMath::Max<uint32>(FarReplicationPeriodFrame, ClassPeriodFrame) : ClassPeriodFrame;
+		}
+
+		Params.OutGatheredReplicationLists.AddReplicationActorList(*Teammates);
+	}
+}
+
+void UShooterReplicationGraphNode_TeamRelevancy::LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const
+{
+	DebugInfo.Log(NodeName);
+	DebugInfo.PushIndent();
+
+	if (!bTeamGame)
+	{
+		DebugInfo.Log(TEXT("Inactive, not a team game"));
+	}
+
+	for (const TPair<int32, FActorRepListRefView>& TeamPair : TeamPawns)
+	{
+		LogActorRepList(DebugInfo, FString::Printf(TEXT("Team %d"), TeamPair.Key), TeamPair.Value);
+	}
+
+	DebugInfo.PopIndent();
+}
+
+// ------------------------------------------------------------------------------
+
+void UShooterReplicationGraphNode_WeaponFireInterest::NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo)
+{
+	Characters.ConditionalAdd(ActorInfo.Actor);
+}
+
+bool UShooterReplicationGraphNode_WeaponFireInterest::NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound)
+{
+	const bool bRemoved = Characters.RemoveFast(ActorInfo.Actor);
+	if (!bRemoved && bWarnIfNotFound)
+	{
+		UE_LOG(LogShooterReplicationGraph, Warning, TEXT("Attempted to remove %s from weapon fire node but it was not found."), *GetActorRepListTypeDebugString(ActorInfo.Actor));
+	}
+
+	return bRemoved;
+}
+
+void UShooterReplicationGraphNode_WeaponFireInterest::NotifyResetAllNetworkActors()
+{
+	Super::NotifyResetAllNetworkActors();
+
+	Characters.Reset();
+	PreGatheredPeriods.Reset();
+}
+
+void UShooterReplicationGraphNode_WeaponFireInterest::BeginPreGather(const TArray<FShooterPreGatherConnection>& Connections, uint32 FrameNum)
+{
+	PreGatherFrame = GFrameCounter;
+	PreGatherRepFrame = FrameNum;
+	PreGatheredPeriods.Reset();
+
+	for (const FShooterPreGatherConnection& Connection : Connections)
+	{
+		PreGatheredPeriods.Add(Connection.ConnectionManager);
+	}
+}
+
+void UShooterReplicationGraphNode_WeaponFireInterest::PreGatherForConnection(const FShooterPreGatherConnection& Connection)
+{
+	if (FWeaponPeriods* Periods = PreGatheredPeriods.Find(Connection.ConnectionManager))
+	{
+		GetWeaponPeriods(*Connection.ConnectionManager, Connection.Viewers, PreGatherRepFrame, *Periods);
+	}
+}
+
+void UShooterReplicationGraphNode_WeaponFireInterest::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	SHOOTER_REPGRAPH_PROFILE_SCOPE(GetGraphProfiler(this), WeaponFireInterest);
+
+	// Worked out by the pre-gather, unless it is off or the connection wasn't ready then
+	const FWeaponPeriods* Periods = (PreGatherFrame == GFrameCounter) ? PreGatheredPeriods.Find(&Params.ConnectionManager) : nullptr;
+	FWeaponPeriods GatheredPeriods;
+	if (Periods == nullptr)
+	{
+		GetWeaponPeriods(Params.ConnectionManager, Params.Viewers, Params.ReplicationFrameNum, GatheredPeriods);
+		Periods = &GatheredPeriods;
+	}
+
+	// Per connection settings are written here on the game thread, FindOrAdd may have to create them
+	for (const TPair<FActorRepListType, uint32>& WeaponPeriod : *Periods)
+	{
+		Params.ConnectionManager.ActorInfoMap.FindOrAdd(WeaponPeriod.Key).ReplicationPeriodFrame = WeaponPeriod.Value;
+	}
+}
+
+void UShooterReplicationGraphNode_WeaponFireInterest::GetWeaponPeriods(const UNetReplicationGraphConnection& ConnectionManager, const FNetViewerArray& Viewers, uint32 FrameNum, FWeaponPeriods& OutPeriods) const
+{
+	OutPeriods.Reset();
+
+	// Staggered so connections don't all update on the same frame
+	if ((FrameNum + ConnectionManager.ConnectionOrderNum) % FMath::Max(UpdateIntervalFrames, 1) != 0)
+	{
+		return;
+	}
+
+	const float HalfRateDistanceSquared = FMath::Square(FireCullDistance * 0.5f);
+	const float CulledDistanceSquared = FMath::Square(FireCullDistance);
+	const UNetConnection* NetConnection = ConnectionManager.NetConnection;
+
+	for (FActorRepListType Actor : Characters)
+	{
+		AShooterCharacter* Character = CastChecked<AShooterCharacter>(Actor);
+		AShooterWeapon* Weapon = Character->GetWeapon();
+
+		// Owner needs its ammo as is
+		if (Weapon == nullptr || Character->GetNetConnection() == NetConnection)
+		{
+			continue;
+		}
+
+		const FGlobalActorReplicationInfo* GlobalInfo = GraphGlobals->GlobalActorReplicationInfoMap->Find(Weapon);
+		if (GlobalInfo == nullptr)
+		{
+			continue;
+		}
+
+		float ClosestDistanceSquared = MAX_flt;
+		for (const FNetViewer& CurViewer : Viewers)
+		{
+			ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared, FVector::DistSquared(Character->GetActorLocation(), CurViewer.ViewLocation));
+		}
+
+		const uint32 ClassPeriodFrame = GlobalInfo->Settings.ReplicationPeriodFrame;
+		uint32 PeriodFrame = ClassPeriodFrame;
+		if (ClosestDistanceSquared > CulledDistanceSquared)
+		{
+			PeriodFrame = FMath::Max<uint32>(CulledReplicationPeriodFrame, ClassPeriodFrame);
+		}
+		else if (ClosestDistanceSquared > HalfRateDistanceSquared)
+		{
+			PeriodFrame = ClassPeriodFrame * 2;
+		}
+
+		OutPeriods.Emplace(Weapon, PeriodFrame);
+	}
+}
+
+void UShooterReplicationGraphNode_WeaponFireInterest::LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const
+{
+	DebugInfo.Log(NodeName);
+	DebugInfo.PushIndent();
+	DebugInfo.Log(FString::Printf(TEXT("Half rate beyond %.0f, every %d frames beyond %.0f"), FireCullDistance * 0.5f, CulledReplicationPeriodFrame, FireCullDistance));
+	LogActorRepList(DebugInfo, TEXT("Characters"), Characters);
+	DebugInfo.PopIndent();
+}
+
+// ------------------------------------------------------------------------------
+
+void UShooterReplicationGraph::PrintRepNodePolicies()
+{
+	UEnum* Enum = StaticEnum<EClassRepNodeMapping>();
+	if (!Enum)
+	{
+		return;
+	}
+
+	GLog->Logf(TEXT("===================================="));
+	GLog->Logf(TEXT("Shooter Replication Routing Policies"));
+	GLog->Logf(TEXT("===================================="));
+
+	for (auto It = ClassRepNodePolicies.CreateIterator(); It; ++It)
+	{
+		FObjectKey ObjKey = It.Key();
+		
+		EClassRepNodeMapping Mapping = It.Value();
+
+		GLog->Logf(TEXT("%-40s --> %s"), *GetNameSafe(ObjKey.ResolveObjectPtr()), *Enum->GetNameStringByValue(static_cast<uint32>(Mapping)));
+	}
+}
+
+void UShooterReplicationGraph::PrintGridOccupancy()
+{
+	auto PrintGridHistogram = [this](UReplicationGraphNode_GridSpatialization2D* Node, const TCHAR* GridName)
+	{
+		if (Node == nullptr)
+		{
+			return;
+		}
+
+		// Buckets hold cells with up to N actors: 0, 1, 2-3, 4-7, ... 64+
+		static const int32 BucketMaxActors[] = { 0, 1, 3, 7, 15, 31, 63, MAX_int32 };
+		int32 BucketCounts[UE_ARRAY_COUNT(BucketMaxActors)] = { 0 };
+
+		int32 NumCells = 0;
+		int32 NumEntries = 0;
+		int32 MaxActorsInCell = 0;
+		TArray<FActorRepListType> CellActors;
+
+		for (TObjectIterator<UReplicationGraphNode_GridCell> It; It; ++It)
+		{
+			if (It->GetOuter() != Node)
+			{
+				continue;
+			}
+
+			CellActors.Reset();
+			It->GetAllActorsInNode_Debugging(CellActors);
+
+			const int32 NumActors = CellActors.Num();
+			NumCells++;
+			NumEntries += NumActors;
+			MaxActorsInCell = FMath::Max(MaxActorsInCell, NumActors);
+
+			int32 BucketIdx = 0;
+			while (NumActors > BucketMaxActors[BucketIdx])
+			{
+				BucketIdx++;
+			}
+			BucketCounts[BucketIdx]++;
+		}
+
+		GLog->Logf(TEXT("%s: CellSize %.0f, SpatialBias %s, %d allocated cells, %d actor entries, max %d actors in a cell"), GridName, Node->CellSize, *Node->SpatialBias.ToString(), NumCells, NumEntries, MaxActorsInCell);
+
+		int32 BucketMinActors = 0;
+		for (int32 BucketIdx = 0; BucketIdx < UE_ARRAY_COUNT(BucketMaxActors); ++BucketIdx)
+		{
+			const FString Range = BucketMaxActors[BucketIdx] == MAX_int32 ? FString::Printf(TEXT("%d+"), BucketMinActors) : FString::Printf(TEXT("%d-%d"), BucketMinActors, BucketMaxActors[BucketIdx]);
+			const int32 BarLength = NumCells > 0 ? FMath::CeilToInt(50.f * BucketCounts[BucketIdx] / NumCells) : 0;
+			GLog->Logf(TEXT("  %8s actors: %5d cells %s"), *Range, BucketCounts[BucketIdx], *FString::ChrN(BarLength, TEXT('#')));
+			BucketMinActors = BucketMaxActors[BucketIdx] + 1;
+		}
+	};
+
+	GLog->Logf(TEXT("===================================="));
+	GLog->Logf(TEXT("Shooter Replication Grid Occupancy"));
+	GLog->Logf(TEXT("===================================="));
+
+	PrintGridHistogram(GridNode, TEXT("Grid"));
+	PrintGridHistogram(CoarseGridMinCullDistance > 0.f ? CoarseGridNode : nullptr, TEXT("Coarse Grid"));
+}
+
+void UShooterReplicationGraph::PrintProfile(int32 TopN, bool bReset)
+{
+	Profiler.Print(TopN);
+
+	if (bReset)
+	{
+		Profiler.Reset();
+	}
+}
+
+FAutoConsoleCommandWithWorldAndArgs ShooterPrintGridOccupancyCmd(TEXT("ShooterRepGraph.PrintGridOccupancy"),TEXT("Prints spatialization grid sizes and a histogram of actors per cell"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		for (TObjectIterator<UShooterReplicationGraph> It; It; ++It)
+		{
+			It->PrintGridOccupancy();
+		}
+	})
+);
+
+FAutoConsoleCommandWithWorldAndArgs ShooterPrintProfileCmd(TEXT("ShooterRepGraph.PrintProfile"),TEXT("Prints replication graph node costs and the most expensive classes and connections. Arguments: TopN (default 10), 'reset' to start over after printing"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		int32 TopN = 10;
+		if (Args.Num() > 0)
+		{
+			LexTryParseString<int32>(TopN, *Args[0]);
+		}
+
+		const bool bReset = Args.Contains(TEXT("reset"));
+
+		for (TObjectIterator<UShooterReplicationGraph> It; It; ++It)
+		{
+			if (It->GetWorld() == World)
+			{
+				It->PrintProfile(FMath::Max(TopN, 1), bReset);
+			}
+		}
+	})
+);
+
+FAutoConsoleCommandWithWorldAndArgs ShooterBuildPVSCmd(TEXT("ShooterRepGraph.BuildPVS"),TEXT("Builds the replication PVS of the current map and saves it to Content/PVS. Optional argument: cell size (default 2000)"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const float CellSize = Args.Num() > 0 ? FCString::Atof(*Args[0]) : 2000.f;
+
+		// Pairs farther apart than pawns are relevant at are culled by distance anyway
+		const float MaxTraceDistance = FMath::Sqrt(GetDefault<AShooterCharacter>()->NetCullDistanceSquared);
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		FShooterPVSData PVSData;
+		if (!PVSData.Build(World, CellSize, MaxTraceDistance))
+		{
+			UE_LOG(LogShooterReplicationGraph, Warning, TEXT("Failed to build PVS, no level bounds"));
+			return;
+		}
+
+		const FString MapName = FShooterPVSData::GetMapName(World);
+		if (!PVSData.Save(MapName))
+		{
+			UE_LOG(LogShooterReplicationGraph, Warning, TEXT("Failed to save PVS to %s"), *FShooterPVSData::GetFilename(MapName));
+			return;
+		}
+
+		UE_LOG(LogShooterReplicationGraph, Display, TEXT("Built PVS for %s in %.1fs: %dx%d cells of %.0f, saved to %s"), *MapName, FPlatformTime::Seconds() - StartTime,
+			PVSData.NumCellsX, PVSData.NumCellsY, PVSData.CellSize, *FShooterPVSData::GetFilename(MapName));
+
+		// Pick it up right away, moving already routed pawns over
+		for (TObjectIterator<UShooterReplicationGraph> It; It; ++It)
+		{
+			if (It->GetWorld() == World && It->PVSNode)
+			{
+				It->InitPVSForWorld(World);
+			}
+		}
+	})
+);
+
 FAutoConsoleCommandWithWorldAndArgs ShooterPrintRepNodePoliciesCmd(TEXT("ShooterRepGraph.PrintRouting"),TEXT("Prints how actor classes are routed to RepGraph nodes"),
 	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
 	{
@@ -4,15 +4,32 @@
 
 #include "CoreMinimal.h"
 #include "ReplicationGraph.h"
+#include "ShooterReplicationPVS.h"
+#include "ShooterReplicationGraphStats.h"
 #include "ShooterReplicationGraph.generated.h"
 
 class AShooterCharacter;
 class AShooterWeapon;
+class AShooterPlayerState;
+class UShooterReplicationGraphNode_PlayerStateFrequencyLimiter;
+class UShooterReplicationGraphNode_PVS;
+class UShooterReplicationGraphNode_TeamRelevancy;
+class UShooterReplicationGraphNode_WeaponFireInterest;
 class UReplicationGraphNode_GridSpatialization2D;
 class AGameplayDebuggerCategoryReplicator;
+struct FShooterRepClassPolicyCache;
 
 DECLARE_LOG_CATEGORY_EXTERN( LogShooterReplicationGraph, Display, All );
 
+/** A connection as seen by the parallel pre-gather, see UShooterReplicationGraph::PreGather */
+struct FShooterPreGatherConnection
+{
+	UNetReplicationGraphConnection* ConnectionManager = nullptr;
+
+	/** Collected on the game thread, the same way the engine does for the gather */
+	FNetViewerArray Viewers;
+};
+
 // This is the main enum we use to route actors to the right replication node. Each class maps to one enum.
 UENUM()
 enum class EClassRepNodeMapping : uint32
@@ -44,6 +61,9 @@ public:
 	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
 	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
 	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual void InitializeActorsInWorld(UWorld* InWorld) override;
+	virtual void NotifyActorTearOff(AActor* Actor) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
 	
 	UPROPERTY()
 	TArray<UClass*>	SpatializedClasses;
@@ -57,13 +77,34 @@ public:
 	UPROPERTY()
 	UReplicationGraphNode_GridSpatialization2D* GridNode;
 
+	/** Second, coarser grid level for actors whose cull distance spans many GridNode cells. Only created when ShooterRepGraph.HierarchicalGrid is set */
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* CoarseGridNode;
+
 	UPROPERTY()
 	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
 
+	UPROPERTY()
+	UShooterReplicationGraphNode_PlayerStateFrequencyLimiter* PlayerStateNode;
+
+	/** Pawns go here instead of GridNode when the map has a PVS */
+	UPROPERTY()
+	UShooterReplicationGraphNode_PVS* PVSNode;
+
+	/** Pawns are also added here, so teammates stay relevant to each other in team games */
+	UPROPERTY()
+	UShooterReplicationGraphNode_TeamRelevancy* TeamNode;
+
+	/** Throttles replication of weapons (cosmetic fire state) to far away connections */
+	UPROPERTY()
+	UShooterReplicationGraphNode_WeaponFireInterest* WeaponFireNode;
+
 	TMap<FName, FActorRepListRefView> AlwaysRelevantStreamingLevelActors;
 
 	void OnCharacterEquipWeapon(AShooterCharacter* Character, AShooterWeapon* NewWeapon);
 	void OnCharacterUnEquipWeapon(AShooterCharacter* Character, AShooterWeapon* OldWeapon);
+	void OnPlayerStateScoreChanged(AShooterPlayerState* PlayerState);
+	void OnPlayerStateTeamChanged(AShooterPlayerState* PlayerState);
 
 #if WITH_GAMEPLAY_DEBUGGER
 	void OnGameplayDebuggerOwnerChange(AGameplayDebuggerCategoryReplicator* Debugger, APlayerController* OldOwner);
@@ -71,13 +112,58 @@ public:
 
 	void PrintRepNodePolicies();
 
+	void PrintGridOccupancy();
+
+	void PrintProfile(int32 TopN, bool bReset);
+
+	FShooterRepGraphProfiler& GetProfiler() { return Profiler; }
+
+	const TArray<UNetReplicationGraphConnection*>& GetConnections() const { return Connections; }
+
+	/** Loads the PVS of the world's map and routes already added pawns to the PVS node or the grid to match */
+	void InitPVSForWorld(UWorld* World);
+
 private:
 
 	EClassRepNodeMapping GetMappingPolicy(UClass* Class);
 
 	bool IsSpatialized(EClassRepNodeMapping Mapping) const { return Mapping >= EClassRepNodeMapping::Spatialize_Static; }
 
+	/** Derives routing policies and legacy class settings of the replicated classes not in KnownClasses from their CDOs, appending them to OutCache */
+	void BuildClassPolicies(const TArray<UClass*>& ExplicitlySetClasses, const TSet<UClass*>& KnownClasses, FShooterRepClassPolicyCache& OutCache);
+
+	/** Applies policies recorded by BuildClassPolicies, skipping classes that aren't loaded. Returns false if the cache is empty */
+	bool ApplyClassPolicyCache(const FShooterRepClassPolicyCache& Cache, TSet<UClass*>& OutAppliedClasses);
+
+	/**
+	 * Runs ahead of Super::ServerReplicateActors. Prepares the PVS and PlayerState nodes, then works out the per connection results of the PVS,
+	 * PlayerState and weapon fire nodes for all connections with ParallelFor. Their gathers then only hand over what was worked out here.
+	 * Between the two the nodes' shared state is only read, so workers need no locks. The grids and AlwaysRelevant_ForConnection still gather
+	 * on the game thread: the first are engine nodes, the second reads streaming levels and the world.
+	 */
+	void PreGather();
+
+	/** Sizes the spatialization grid(s) from the bounds and actor density of the world being loaded */
+	void ConfigureGridForWorld(UWorld* World);
+
+	/** Returns the grid level a spatialized actor goes to */
+	UReplicationGraphNode_GridSpatialization2D* GetGridNodeForActor(const FNewReplicatedActorInfo& ActorInfo, const FGlobalActorReplicationInfo& GlobalInfo);
+
+	/** Cull distance above which actors are routed to CoarseGridNode. 0 when the coarse level isn't used for the current world */
+	float CoarseGridMinCullDistance = 0.f;
+
+	/** Actors currently routed to CoarseGridNode, so removal goes to the same level */
+	TSet<FActorRepListType> CoarseGridActors;
+
+	/** Torn off actors already removed from the routed nodes, so they aren't removed again when destroyed */
+	TSet<FActorRepListType> TornOffActors;
+
 	TClassMap<EClassRepNodeMapping> ClassRepNodePolicies;
+
+	/** Connections of this frame's pre-gather */
+	TArray<FShooterPreGatherConnection> PreGatherConnections;
+
+	FShooterRepGraphProfiler Profiler;
 };
 
 UCLASS()
@@ -89,7 +175,7 @@ public:
 
 	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& Actor) override { }
 	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound=true) override { return false; }
-	virtual void NotifyResetAllNetworkActors() override { }
+	virtual void NotifyResetAllNetworkActors() override;
 
 	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
 
@@ -106,30 +192,67 @@ public:
 
 private:
 
+	/** What the cached lists were built from, for a single viewer. Compared every frame to detect when a rebuild is needed */
+	struct FCachedViewerState
+	{
+		TWeakObjectPtr<AActor> InViewer;
+		TWeakObjectPtr<AActor> ViewTarget;
+		TWeakObjectPtr<APawn> Pawn;
+		TWeakObjectPtr<APlayerState> PlayerState;
+		int32 InventoryCount = 0;
+
+		bool operator==(const FCachedViewerState& Other) const
+		{
+			return InViewer == Other.InViewer && ViewTarget == Other.ViewTarget && Pawn == Other.Pawn && PlayerState == Other.PlayerState && InventoryCount == Other.InventoryCount;
+		}
+	};
+
+	/** Updates CachedViewerStates, returns true if anything the lists depend on changed */
+	bool UpdateCachedViewerStates(const FConnectionGatherActorListParameters& Params);
+
+	/** Rebuilds ReplicationActorList and PlayerStateActorList from the connection's viewers */
+	void RebuildActorLists(const FConnectionGatherActorListParameters& Params);
+
+	/** Adds the always relevant actor lists of visible streaming levels. Levels whose actors are all dormant are dropped when bCheckDormancy is set */
+	void GatherStreamingLevelActorLists(const FConnectionGatherActorListParameters& Params, bool bCheckDormancy);
+
 	TArray<FName, TInlineAllocator<64> > AlwaysRelevantStreamingLevelsNeedingReplication;
 
+	/** Levels were added since the last dormancy check */
+	bool bStreamingLevelsAdded = false;
+
 	FActorRepListRefView ReplicationActorList;
 
-	UPROPERTY()
-	AActor* LastPawn = nullptr;
+	/** Owning player states, returned every other frame */
+	FActorRepListRefView PlayerStateActorList;
+
+	TArray<FCachedViewerState, TInlineAllocator<2> > CachedViewerStates;
+
+#if WITH_GAMEPLAY_DEBUGGER
+	TWeakObjectPtr<AGameplayDebuggerCategoryReplicator> CachedGameplayDebugger;
+#endif
 
 	/** List of previously (or currently if nothing changed last tick) focused actor data per connection */
 	UPROPERTY()
 	TArray<FAlwaysRelevantActorInfo> PastRelevantActors;
-
-	bool bInitializedPlayerState = false;
 };
 
-/** This is a specialized node for handling PlayerState replication in a frequency limited fashion. It tracks all player states but only returns a subset of them to the replication driver each frame. */
+/**
+ * This is a specialized node for handling PlayerState replication in a frequency limited fashion. It tracks all player states but only returns a subset of them to each connection each frame.
+ * The subset grows with the bandwidth a connection has to spare, and player states whose score changed since the connection last received them go first.
+ */
 UCLASS()
 class UShooterReplicationGraphNode_PlayerStateFrequencyLimiter : public UReplicationGraphNode
 {
 	GENERATED_BODY()
 
+public:
+
 	UShooterReplicationGraphNode_PlayerStateFrequencyLimiter();
 
-	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& Actor) override { }
-	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound=true) override { return false; }
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& Actor) override;
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound=true) override;
+	virtual void NotifyResetAllNetworkActors() override;
 
 	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
 
@@ -137,11 +260,205 @@ class UShooterReplicationGraphNode_PlayerStateFrequencyLimiter : public UReplica
 
 	virtual void LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const override;
 
-	/** How many actors we want to return to the replication driver per frame. Will not suppress ForceNetUpdate. */
-	int32 TargetActorsPerFrame = 2;
+	/** Marks the player state as changed, so it is gathered ahead of the rolling set until each connection received it */
+	void NotifyScoreChanged(APlayerState* PlayerState);
+
+	/** Game thread, after PrepareForReplication: adds a pre-gather result for each connection */
+	void BeginPreGather(const TArray<FShooterPreGatherConnection>& Connections);
+
+	/** Any thread, after BeginPreGather: builds the connection's list. Only writes the connection's own result */
+	void PreGatherForConnection(const FShooterPreGatherConnection& Connection);
+
+	/** How many actors we return per frame to a connection with no bandwidth to spare. Will not suppress ForceNetUpdate. */
+	int32 MinActorsPerFrame = 2;
+
+	/** How many actors we return per frame to a connection that is using none of its bandwidth */
+	int32 MaxActorsPerFrame = 16;
 
 private:
-	
-	TArray<FActorRepListRefView> ReplicationActorLists;
+
+	/** Returns how much of its bandwidth the connection has left: 0 when saturated, 1 when idle */
+	static float GetBandwidthHeadroom(const UNetConnection* NetConnection);
+
+	/** Fills the list of player states to return to a connection this frame. Only reads node and connection state */
+	void BuildActorListForConnection(const UNetReplicationGraphConnection& ConnectionManager, TArray<FActorRepListType>& OutActors) const;
+
+	/** All replicated player states. Kept up to date through NotifyAdd/RemoveNetworkActor */
+	FActorRepListRefView PlayerStates;
+
+	/** Replication frame at which a player state's score last changed. Pruned once the rolling set has passed over the player state */
+	TMap<FActorRepListType, uint32> ScoreChangedFrames;
+
+	/** Start of this frame's rolling set in PlayerStates. Shared by all connections, so connections with the same budget gather the same actors and share serialization */
+	int32 RollingStartIdx = 0;
+
+	/** List handed to each connection this frame. It has to outlive the gather, so it is kept per connection */
+	TMap<TWeakObjectPtr<UNetReplicationGraphConnection>, FActorRepListRefView> ConnectionActorLists;
+
+	/** Lists built by the pre-gather, valid in frame PreGatherFrame (GFrameCounter) */
+	TMap<UNetReplicationGraphConnection*, TArray<FActorRepListType>> PreGatheredActors;
+
+	uint64 PreGatherFrame = 0;
+
 	FActorRepListRefView ForceNetUpdateReplicationActorList;
-};
\ No newline at end of file
+};
+
+/**
+ * Pawns culled by the map's precomputed visibility (see FShooterPVSData). Actors are bucketed by PVS cell once per frame, and a cell's actors
+ * are only gathered for a connection if the viewer's cell can see that cell. No traces are done at runtime. Only active when the map has a PVS.
+ */
+UCLASS()
+class UShooterReplicationGraphNode_PVS : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+
+	UShooterReplicationGraphNode_PVS();
+
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound=true) override;
+	virtual void NotifyResetAllNetworkActors() override;
+
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	virtual void PrepareForReplication() override;
+
+	virtual void LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const override;
+
+	/** Loads the PVS of the world's map. The node is active if there is one */
+	void InitForWorld(UWorld* World);
+
+	bool IsActive() const { return PVSData.IsValid(); }
+
+	/** Game thread, after PrepareForReplication: adds a pre-gather result for each connection */
+	void BeginPreGather(const TArray<FShooterPreGatherConnection>& Connections);
+
+	/** Any thread, after BeginPreGather: finds the occupied cells the connection sees. Only writes the connection's own result */
+	void PreGatherForConnection(const FShooterPreGatherConnection& Connection);
+
+private:
+
+	/** Occupied cells visible from any of the viewers */
+	void GetVisibleCells(const FNetViewerArray& Viewers, TArray<int32>& OutCells) const;
+
+	FShooterPVSData PVSData;
+
+	/** All actors routed to this node */
+	FActorRepListRefView Actors;
+
+	/** Actors per PVS cell, rebuilt every frame. Only entries in OccupiedCells are current */
+	TMap<int32, FActorRepListRefView> CellActorLists;
+
+	TArray<int32> OccupiedCells;
+
+	/** Actors outside of the PVS grid, gathered for everyone */
+	FActorRepListRefView OutsideActors;
+
+	/** Visible cells found by the pre-gather, valid in frame PreGatherFrame (GFrameCounter) */
+	TMap<UNetReplicationGraphConnection*, TArray<int32>> PreGatheredCells;
+
+	uint64 PreGatherFrame = 0;
+};
+
+/**
+ * Keeps teammates relevant to each other in team games (AShooterGameState::NumTeams > 1), so they don't drop out and reopen channels as they move apart.
+ * Pawns stay in the spatial and PVS nodes for enemies. This node additionally returns the viewer's teammates with no cull distance, replicated
+ * at a lower frequency while they are farther than FarDistance from the viewer.
+ */
+UCLASS()
+class UShooterReplicationGraphNode_TeamRelevancy : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+
+	UShooterReplicationGraphNode_TeamRelevancy();
+
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound=true) override;
+	virtual void NotifyResetAllNetworkActors() override;
+
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	virtual void PrepareForReplication() override;
+
+	virtual void LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const override;
+
+	/** A player changed team: per connection settings given to former teammates get restored on the next frame */
+	void NotifyTeamChanged();
+
+	/** Teammates farther than this from the viewer are replicated every FarReplicationPeriodFrame frames */
+	float FarDistance = 5000.f;
+
+	int32 FarReplicationPeriodFrame = 6;
+
+private:
+
+	/** Restores class cull distance and replication period of all pawns on all connections */
+	void RestoreConnectionSettings();
+
+	/** All pawns routed to this node */
+	FActorRepListRefView Pawns;
+
+	/** Possessed pawns per team, rebuilt every frame */
+	TMap<int32, FActorRepListRefView> TeamPawns;
+
+	/** Current match has teams */
+	bool bTeamGame = false;
+
+	bool bTeamsChanged = false;
+};
+
+/**
+ * Weapons replicate as dependents of their pawn, so they share its relevancy distance. What they replicate to other players is cosmetic
+ * (BurstCounter, HitNotify), so this node lowers the weapon's per connection replication rate with distance to the viewer: half rate beyond
+ * FireCullDistance / 2, and once every CulledReplicationPeriodFrame frames beyond FireCullDistance. The owning connection is never affected.
+ * This node doesn't gather any actors itself.
+ */
+UCLASS()
+class UShooterReplicationGraphNode_WeaponFireInterest : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound=true) override;
+	virtual void NotifyResetAllNetworkActors() override;
+
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	virtual void LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const override;
+
+	float FireCullDistance = 8000.f;
+
+	int32 CulledReplicationPeriodFrame = 30;
+
+	/** Distances are re-evaluated for a connection every this many frames */
+	int32 UpdateIntervalFrames = 4;
+
+	/** Game thread: adds a pre-gather result for each connection */
+	void BeginPreGather(const TArray<FShooterPreGatherConnection>& Connections, uint32 FrameNum);
+
+	/** Any thread, after BeginPreGather: works out the connection's weapon replication periods. Only writes the connection's own result */
+	void PreGatherForConnection(const FShooterPreGatherConnection& Connection);
+
+private:
+
+	typedef TArray<TPair<FActorRepListType, uint32>> FWeaponPeriods;
+
+	/** Replication period of each managed weapon for the connection, empty on frames the connection isn't due. Only reads node and connection state */
+	void GetWeaponPeriods(const UNetReplicationGraphConnection& ConnectionManager, const FNetViewerArray& Viewers, uint32 FrameNum, FWeaponPeriods& OutPeriods) const;
+
+	/** Characters whose current weapon is managed */
+	FActorRepListRefView Characters;
+
+	/** Periods worked out by the pre-gather, valid in frame PreGatherFrame (GFrameCounter) */
+	TMap<UNetReplicationGraphConnection*, FWeaponPeriods> PreGatheredPeriods;
+
+	uint64 PreGatherFrame = 0;
+
+	/** Replication frame the pre-gather ran for */
+	uint32 PreGatherRepFrame = 0;
+};
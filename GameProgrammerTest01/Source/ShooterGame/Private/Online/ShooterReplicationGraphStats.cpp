@@ -0,0 +1,244 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "ShooterReplicationGraphStats.h"
+#include "ReplicationGraph.h"
+
+DEFINE_STAT(STAT_ShooterRepGraph_ServerReplicateActors);
+DEFINE_STAT(STAT_ShooterRepGraph_AlwaysRelevant);
+DEFINE_STAT(STAT_ShooterRepGraph_PlayerStateLimiter);
+DEFINE_STAT(STAT_ShooterRepGraph_PVS);
+DEFINE_STAT(STAT_ShooterRepGraph_TeamRelevancy);
+DEFINE_STAT(STAT_ShooterRepGraph_WeaponFireInterest);
+DEFINE_STAT(STAT_ShooterRepGraph_PreGather);
+DEFINE_STAT(STAT_ShooterRepGraph_SaturatedConnections);
+DEFINE_STAT(STAT_ShooterRepGraph_ReplicatedActors);
+DEFINE_STAT(STAT_ShooterRepGraph_StarvedActors);
+
+CSV_DEFINE_CATEGORY(ShooterRepGraph, true);
+
+int32 CVar_ShooterRepGraph_Profile = 1;
+static FAutoConsoleVariableRef CVarShooterRepProfile(TEXT("ShooterRepGraph.Profile"), CVar_ShooterRepGraph_Profile, TEXT("Collect node, class and connection costs for ShooterRepGraph.PrintProfile. 0: Disable, 1: Enable"), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_ProfileSampleFrames = 30;
+static FAutoConsoleVariableRef CVarShooterRepProfileSampleFrames(TEXT("ShooterRepGraph.ProfileSampleFrames"), CVar_ShooterRepGraph_ProfileSampleFrames, TEXT("Frames between samples of a connection's per class and per connection replication stats. Connections are sampled round robin, a share of them every frame"), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_StarvedFrames = 60;
+static FAutoConsoleVariableRef CVarShooterRepStarvedFrames(TEXT("ShooterRepGraph.StarvedFrames"), CVar_ShooterRepGraph_StarvedFrames, TEXT("Frames an actor with an open channel can go without replicating (beyond twice its period) before it counts as starved"), ECVF_Default );
+
+bool FShooterRepGraphProfiler::IsEnabled()
+{
+	return CVar_ShooterRepGraph_Profile > 0;
+}
+
+void FShooterRepGraphProfiler::Reset()
+{
+	ClassStats.Reset();
+	ConnectionStats.Reset();
+	NumFrames = 0;
+	NumSamples = 0;
+	SampleCursor = 0;
+	SampleNumReplicated = 0;
+	SampleNumStarved = 0;
+	SampleOutBytesPerSecond = 0;
+
+	for (uint64& Cycles : ScopeCycles)
+	{
+		Cycles = 0;
+	}
+}
+
+void FShooterRepGraphProfiler::PostServerReplicateActors(const TArray<UNetReplicationGraphConnection*>& Connections, uint32 FrameNum)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	NumFrames++;
+
+	uint32 NumSaturated = 0;
+
+	for (UNetReplicationGraphConnection* ConnectionManager : Connections)
+	{
+		UNetConnection* NetConnection = ConnectionManager->NetConnection;
+		if (NetConnection == nullptr)
+		{
+			continue;
+		}
+
+		FConnectionStats& Stats = ConnectionStats.FindOrAdd(NetConnection);
+		if (Stats.NumFrames == 0)
+		{
+			// Only count what replicates from here on
+			Stats.LastSampleFrame = FrameNum;
+		}
+		Stats.NumFrames++;
+
+		// Anything that still wants to go out this frame has to wait
+		if (!NetConnection->IsNetReady(false))
+		{
+			Stats.NumSaturatedFrames++;
+			NumSaturated++;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_ShooterRepGraph_SaturatedConnections, NumSaturated);
+	CSV_CUSTOM_STAT(ShooterRepGraph, SaturatedConnections, (int32)NumSaturated, ECsvCustomStatOp::Set);
+
+	const int32 NumConnections = Connections.Num();
+	if (CVar_ShooterRepGraph_ProfileSampleFrames <= 0 || NumConnections == 0)
+	{
+		return;
+	}
+
+	// Walking an ActorInfoMap is the expensive part, so spread the connections over the sample period instead of walking them all in one frame
+	const int32 NumToSample = FMath::DivideAndRoundUp(NumConnections, CVar_ShooterRepGraph_ProfileSampleFrames);
+	for (int32 SampleIdx = 0; SampleIdx < NumToSample; SampleIdx++)
+	{
+		SampleCursor = SampleCursor < NumConnections ? SampleCursor : 0;
+		UNetReplicationGraphConnection* ConnectionManager = Connections[SampleCursor++];
+
+		if (ConnectionManager->NetConnection != nullptr)
+		{
+			SampleConnection(*ConnectionManager, ConnectionStats.FindOrAdd(ConnectionManager->NetConnection), FrameNum);
+		}
+
+		if (SampleCursor >= NumConnections)
+		{
+			EndSample();
+		}
+	}
+}
+
+void FShooterRepGraphProfiler::EndSample()
+{
+	NumSamples++;
+
+	SET_DWORD_STAT(STAT_ShooterRepGraph_ReplicatedActors, SampleNumReplicated);
+	SET_DWORD_STAT(STAT_ShooterRepGraph_StarvedActors, SampleNumStarved);
+	CSV_CUSTOM_STAT(ShooterRepGraph, ReplicatedActors, SampleNumReplicated, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ShooterRepGraph, StarvedActors, SampleNumStarved, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ShooterRepGraph, OutKBytesPerSecond, SampleOutBytesPerSecond / 1024.f, ECsvCustomStatOp::Set);
+
+	SampleNumReplicated = 0;
+	SampleNumStarved = 0;
+	SampleOutBytesPerSecond = 0;
+
+	for (auto It = ConnectionStats.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FShooterRepGraphProfiler::SampleConnection(UNetReplicationGraphConnection& ConnectionManager, FConnectionStats& Stats, uint32 FrameNum)
+{
+	UNetConnection* NetConnection = ConnectionManager.NetConnection;
+
+	const APlayerState* PlayerState = NetConnection->PlayerController ? NetConnection->PlayerController->PlayerState : nullptr;
+	Stats.Description = PlayerState ? FString::Printf(TEXT("%s (%s)"), *PlayerState->GetPlayerName(), *NetConnection->LowLevelGetRemoteAddress(true)) : NetConnection->LowLevelGetRemoteAddress(true);
+
+	const uint32 StarvedFrames = (uint32)FMath::Max(CVar_ShooterRepGraph_StarvedFrames, 1);
+	int32 NumReplicated = 0;
+	int32 NumStarved = 0;
+
+	for (auto It = ConnectionManager.ActorInfoMap.CreateIterator(); It; ++It)
+	{
+		AActor* Actor = It.Key();
+		const FConnectionReplicationActorInfo& ActorInfo = *It.Value().Get();
+		if (Actor == nullptr)
+		{
+			continue;
+		}
+
+		const bool bReplicated = ActorInfo.LastRepFrameNum > Stats.LastSampleFrame;
+
+		// Gathered actors keep their channel open, so an open channel that hasn't replicated for a while is an actor losing out on bandwidth
+		const bool bStarved = ActorInfo.Channel != nullptr && !ActorInfo.bDormantOnConnection
+			&& FrameNum - ActorInfo.LastRepFrameNum > FMath::Max<uint32>(StarvedFrames, ActorInfo.ReplicationPeriodFrame * 2);
+
+		if (bReplicated || bStarved)
+		{
+			FClassStats& Class = ClassStats.FindOrAdd(Actor->GetClass());
+			Class.NumReplicated += bReplicated ? 1 : 0;
+			Class.NumStarved += bStarved ? 1 : 0;
+			NumReplicated += bReplicated ? 1 : 0;
+			NumStarved += bStarved ? 1 : 0;
+		}
+	}
+
+	Stats.LastSampleFrame = FrameNum;
+	Stats.NumSamples++;
+	Stats.OutBytesPerSecondSum += NetConnection->OutBytesPerSecond;
+	Stats.NumStarvedSum += NumStarved;
+	SampleNumReplicated += NumReplicated;
+	SampleNumStarved += NumStarved;
+	SampleOutBytesPerSecond += NetConnection->OutBytesPerSecond;
+}
+
+void FShooterRepGraphProfiler::Print(int32 TopN) const
+{
+	GLog->Logf(TEXT("===================================="));
+	GLog->Logf(TEXT("Shooter Replication Profile"));
+	GLog->Logf(TEXT("===================================="));
+
+	if (NumFrames == 0)
+	{
+		GLog->Logf(TEXT("No frames recorded. Is ShooterRepGraph.Profile enabled?"));
+		return;
+	}
+
+	GLog->Logf(TEXT("%d frames, %d samples"), NumFrames, NumSamples);
+
+	static const TCHAR* ScopeNames[] = { TEXT("ServerReplicateActors"), TEXT("AlwaysRelevant_ForConnection"), TEXT("PlayerStateFrequencyLimiter"), TEXT("PVS"), TEXT("TeamRelevancy"), TEXT("WeaponFireInterest"), TEXT("PreGather") };
+	static_assert(UE_ARRAY_COUNT(ScopeNames) == (int32)EShooterRepGraphProfileScope::Count, "Name every profile scope");
+
+	GLog->Logf(TEXT(""));
+	GLog->Logf(TEXT("%-40s %10s"), TEXT("Scope"), TEXT("ms/frame"));
+	for (int32 ScopeIdx = 0; ScopeIdx < (int32)EShooterRepGraphProfileScope::Count; ScopeIdx++)
+	{
+		GLog->Logf(TEXT("%-40s %10.3f"), ScopeNames[ScopeIdx], FPlatformTime::ToMilliseconds64(ScopeCycles[ScopeIdx]) / NumFrames);
+	}
+
+	const int32 SafeNumSamples = FMath::Max(NumSamples, 1);
+
+	TArray<TPair<FObjectKey, FClassStats>> SortedClasses = ClassStats.Array();
+	SortedClasses.Sort([](const TPair<FObjectKey, FClassStats>& A, const TPair<FObjectKey, FClassStats>& B)
+	{
+		return A.Value.NumReplicated + A.Value.NumStarved > B.Value.NumReplicated + B.Value.NumStarved;
+	});
+
+	GLog->Logf(TEXT(""));
+	GLog->Logf(TEXT("Top %d classes (connection / actor pairs per sample)"), TopN);
+	GLog->Logf(TEXT("%-40s %12s %12s"), TEXT("Class"), TEXT("Replicated"), TEXT("Starved"));
+	for (int32 Idx = 0; Idx < FMath::Min(TopN, SortedClasses.Num()); Idx++)
+	{
+		const TPair<FObjectKey, FClassStats>& Pair = SortedClasses[Idx];
+		GLog->Logf(TEXT("%-40s %12.1f %12.1f"), *GetNameSafe(Pair.Key.ResolveObjectPtr()), (float)Pair.Value.NumReplicated / SafeNumSamples, (float)Pair.Value.NumStarved / SafeNumSamples);
+	}
+
+	TArray<const FConnectionStats*> SortedConnections;
+	for (const TPair<TWeakObjectPtr<UNetConnection>, FConnectionStats>& Pair : ConnectionStats)
+	{
+		SortedConnections.Add(&Pair.Value);
+	}
+
+	auto GetAverageBytes = [](const FConnectionStats& Stats) { return Stats.NumSamples > 0 ? Stats.OutBytesPerSecondSum / Stats.NumSamples : 0; };
+	SortedConnections.Sort([&GetAverageBytes](const FConnectionStats& A, const FConnectionStats& B)
+	{
+		return GetAverageBytes(A) > GetAverageBytes(B);
+	});
+
+	GLog->Logf(TEXT(""));
+	GLog->Logf(TEXT("Top %d connections"), TopN);
+	GLog->Logf(TEXT("%-40s %12s %12s %12s"), TEXT("Connection"), TEXT("Out KB/s"), TEXT("Saturated %"), TEXT("Starved"));
+	for (int32 Idx = 0; Idx < FMath::Min(TopN, SortedConnections.Num()); Idx++)
+	{
+		const FConnectionStats& Stats = *SortedConnections[Idx];
+		GLog->Logf(TEXT("%-40s %12.1f %12.1f %12.1f"), *Stats.Description, GetAverageBytes(Stats) / 1024.f,
+			100.f * Stats.NumSaturatedFrames / FMath::Max(Stats.NumFrames, 1), (float)Stats.NumStarvedSum / FMath::Max(Stats.NumSamples, 1));
+	}
+}
@@ -0,0 +1,151 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "UObject/ObjectKey.h"
+
+class UNetConnection;
+class UNetDriver;
+class UNetReplicationGraphConnection;
+
+DECLARE_STATS_GROUP(TEXT("ShooterRepGraph"), STATGROUP_ShooterRepGraph, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ServerReplicateActors"), STAT_ShooterRepGraph_ServerReplicateActors, STATGROUP_ShooterRepGraph, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AlwaysRelevant_ForConnection"), STAT_ShooterRepGraph_AlwaysRelevant, STATGROUP_ShooterRepGraph, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PlayerStateFrequencyLimiter"), STAT_ShooterRepGraph_PlayerStateLimiter, STATGROUP_ShooterRepGraph, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PVS"), STAT_ShooterRepGraph_PVS, STATGROUP_ShooterRepGraph, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TeamRelevancy"), STAT_ShooterRepGraph_TeamRelevancy, STATGROUP_ShooterRepGraph, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("WeaponFireInterest"), STAT_ShooterRepGraph_WeaponFireInterest, STATGROUP_ShooterRepGraph, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PreGather"), STAT_ShooterRepGraph_PreGather, STATGROUP_ShooterRepGraph, );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Saturated Connections"), STAT_ShooterRepGraph_SaturatedConnections, STATGROUP_ShooterRepGraph, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Replicated Actors (sampled)"), STAT_ShooterRepGraph_ReplicatedActors, STATGROUP_ShooterRepGraph, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Starved Actors (sampled)"), STAT_ShooterRepGraph_StarvedActors, STATGROUP_ShooterRepGraph, );
+
+CSV_DECLARE_CATEGORY_EXTERN(ShooterRepGraph);
+
+/** Scopes timed by FShooterRepGraphProfiler, one per custom node plus the whole replication frame and its parallel pre-gather */
+enum class EShooterRepGraphProfileScope : uint8
+{
+	ServerReplicateActors,
+	AlwaysRelevant,
+	PlayerStateLimiter,
+	PVS,
+	TeamRelevancy,
+	WeaponFireInterest,
+	PreGather,
+	Count
+};
+
+/**
+ * Replication graph costs for capacity planning: time spent in each custom node, replications and starvation per actor class, and per connection
+ * bandwidth and saturation. Cheap enough to stay on in shipping servers: saturation is checked once per connection per frame, everything else is
+ * sampled round robin, a share of the connections per frame so that each is visited every ShooterRepGraph.ProfileSampleFrames frames. A sample
+ * ends once every connection was visited. Dumped with ShooterRepGraph.PrintProfile.
+ *
+ * Bytes per class aren't visible to game code, those come from the engine's CSV class tracker (UReplicationGraph::CSVTracker).
+ */
+class FShooterRepGraphProfiler
+{
+public:
+
+	/** Called after every replication frame */
+	void PostServerReplicateActors(const TArray<UNetReplicationGraphConnection*>& Connections, uint32 FrameNum);
+
+	/** Logs node costs and the TopN classes and connections */
+	void Print(int32 TopN) const;
+
+	void Reset();
+
+	static bool IsEnabled();
+
+	/** Profiler of the net driver's replication graph, null if it doesn't use UShooterReplicationGraph */
+	static const FShooterRepGraphProfiler* Get(UNetDriver* NetDriver);
+
+	/** Game thread only */
+	void AddScopeCycles(EShooterRepGraphProfileScope Scope, uint64 Cycles) { ScopeCycles[(int32)Scope] += Cycles; }
+
+	/** Cycles spent in Scope since the last Reset, for callers that diff it over their own window */
+	uint64 GetScopeCycles(EShooterRepGraphProfileScope Scope) const { return ScopeCycles[(int32)Scope]; }
+
+private:
+
+	struct FClassStats
+	{
+		/** Connection / actor pairs that replicated during a sample window */
+		int32 NumReplicated = 0;
+
+		/** Connection / actor pairs with an open channel that haven't replicated for ShooterRepGraph.StarvedFrames */
+		int32 NumStarved = 0;
+	};
+
+	struct FConnectionStats
+	{
+		FString Description;
+		uint32 LastSampleFrame = 0;
+		int32 NumFrames = 0;
+		int32 NumSaturatedFrames = 0;
+		int32 NumSamples = 0;
+		int64 OutBytesPerSecondSum = 0;
+		int32 NumStarvedSum = 0;
+	};
+
+	/** Adds the connection's replicated and starved actors since its last sample to the class stats and the sample totals */
+	void SampleConnection(UNetReplicationGraphConnection& ConnectionManager, FConnectionStats& Stats, uint32 FrameNum);
+
+	/** Publishes the sample totals once every connection was sampled */
+	void EndSample();
+
+	TMap<FObjectKey, FClassStats> ClassStats;
+
+	TMap<TWeakObjectPtr<UNetConnection>, FConnectionStats> ConnectionStats;
+
+	/** Next connection to sample */
+	int32 SampleCursor = 0;
+
+	int32 SampleNumReplicated = 0;
+
+	int32 SampleNumStarved = 0;
+
+	int64 SampleOutBytesPerSecond = 0;
+
+	int32 NumFrames = 0;
+
+	int32 NumSamples = 0;
+
+	uint64 ScopeCycles[(int32)EShooterRepGraphProfileScope::Count] = { 0 };
+};
+
+/** Adds the time spent in its scope to a FShooterRepGraphProfiler */
+struct FShooterRepGraphScopedTimer
+{
+	FShooterRepGraphScopedTimer(FShooterRepGraphProfiler& InProfiler, EShooterRepGraphProfileScope InScope)
+		: Profiler(InProfiler)
+		, Scope(InScope)
+		, StartCycles(FShooterRepGraphProfiler::IsEnabled() ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FShooterRepGraphScopedTimer()
+	{
+		if (StartCycles != 0)
+		{
+			Profiler.AddScopeCycles(Scope, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+private:
+
+	FShooterRepGraphProfiler& Profiler;
+	EShooterRepGraphProfileScope Scope;
+	uint64 StartCycles;
+};
+
+/** Times a scope for the stat group, the CSV category and the graph's ShooterRepGraph.PrintProfile. Game thread only */
+#define SHOOTER_REPGRAPH_PROFILE_SCOPE(Profiler, Scope) \
+	SCOPE_CYCLE_COUNTER(STAT_ShooterRepGraph_##Scope); \
+	CSV_SCOPED_TIMING_STAT(ShooterRepGraph, Scope); \
+	FShooterRepGraphScopedTimer ShooterRepGraphScopedTimer(Profiler, EShooterRepGraphProfileScope::Scope)
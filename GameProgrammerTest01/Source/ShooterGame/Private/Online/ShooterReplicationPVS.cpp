@@ -0,0 +1,260 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "ShooterReplicationPVS.h"
+#include "Engine/LevelBounds.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+namespace ShooterPVS
+{
+	static const uint32 FileMagic = 0x53505653;		// 'SPVS'
+	static const int32 FileVersion = 1;
+
+	/** Height above walkable surfaces at which visibility is sampled */
+	static const float EyeHeight = 160.f;
+
+	/** Sample columns per cell axis */
+	static const int32 SamplesPerAxis = 2;
+
+	/** Walkable surfaces stacked in one sample column that get sampled, e.g. floors of a building */
+	static const int32 MaxFloorsPerSample = 4;
+
+	/** Minimum normal Z of a surface to count as walkable */
+	static const float WalkableNormalZ = 0.7f;
+}
+
+void FShooterPVSData::Reset()
+{
+	Origin = FVector2D::ZeroVector;
+	CellSize = 0.f;
+	NumCellsX = 0;
+	NumCellsY = 0;
+	Visibility.Empty();
+}
+
+bool FShooterPVSData::Build(UWorld* World, float InCellSize, float MaxTraceDistance)
+{
+	Reset();
+
+	if (World == nullptr || InCellSize <= 0.f)
+	{
+		return false;
+	}
+
+	FBox Bounds(ForceInit);
+	for (ULevel* Level : World->GetLevels())
+	{
+		if (Level && Level->bIsVisible)
+		{
+			const FBox LevelBounds = ALevelBounds::CalculateLevelBounds(Level);
+			if (LevelBounds.IsValid)
+			{
+				Bounds += LevelBounds;
+			}
+		}
+	}
+
+	if (!Bounds.IsValid)
+	{
+		return false;
+	}
+
+	const FVector Size = Bounds.GetSize();
+	CellSize = InCellSize;
+	while (FMath::CeilToInt(Size.X / CellSize) * FMath::CeilToInt(Size.Y / CellSize) > MaxCells)
+	{
+		CellSize *= 1.25f;
+	}
+
+	Origin = FVector2D(Bounds.Min.X, Bounds.Min.Y);
+	NumCellsX = FMath::Max(FMath::CeilToInt(Size.X / CellSize), 1);
+	NumCellsY = FMath::Max(FMath::CeilToInt(Size.Y / CellSize), 1);
+	const int32 NumCells = GetNumCells();
+
+	// Eye height points above each walkable surface found in a column
+	TArray<TArray<FVector>> CellSamples;
+	CellSamples.SetNum(NumCells);
+
+	ParallelFor(NumCells, [&](int32 CellIdx)
+	{
+		const FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(ShooterPVSFloor), true);
+		const int32 CellX = CellIdx % NumCellsX;
+		const int32 CellY = CellIdx / NumCellsX;
+
+		for (int32 SampleX = 0; SampleX < ShooterPVS::SamplesPerAxis; SampleX++)
+		{
+			for (int32 SampleY = 0; SampleY < ShooterPVS::SamplesPerAxis; SampleY++)
+			{
+				const FVector2D SampleLocation = Origin + FVector2D(CellX + (SampleX + 0.5f) / ShooterPVS::SamplesPerAxis, CellY + (SampleY + 0.5f) / ShooterPVS::SamplesPerAxis) * CellSize;
+				const FVector TraceEnd(SampleLocation, Bounds.Min.Z);
+				FVector TraceStart(SampleLocation, Bounds.Max.Z);
+
+				for (int32 Floor = 0; Floor < ShooterPVS::MaxFloorsPerSample; Floor++)
+				{
+					FHitResult Hit;
+					if (!World->LineTraceSingleByChannel(Hit, TraceStart, TraceEnd, ECC_Visibility, TraceParams))
+					{
+						break;
+					}
+
+					if (Hit.ImpactNormal.Z >= ShooterPVS::WalkableNormalZ)
+					{
+						CellSamples[CellIdx].Add(Hit.ImpactPoint + FVector(0.f, 0.f, ShooterPVS::EyeHeight));
+					}
+
+					// continue just below this surface to find the floors under it
+					TraceStart = Hit.ImpactPoint - FVector(0.f, 0.f, 10.f);
+				}
+			}
+		}
+	});
+
+	// Visibility is symmetric, so each cell only traces against the cells after it
+	TArray<TArray<int32>> VisibleCells;
+	VisibleCells.SetNum(NumCells);
+
+	const float CellDiagonal = CellSize * UE_SQRT_2;
+
+	ParallelFor(NumCells, [&](int32 CellA)
+	{
+		const FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(ShooterPVSVisibility), true);
+		const FVector2D CenterA = Origin + FVector2D(CellA % NumCellsX + 0.5f, CellA / NumCellsX + 0.5f) * CellSize;
+
+		for (int32 CellB = CellA + 1; CellB < NumCells; CellB++)
+		{
+			const FVector2D CenterB = Origin + FVector2D(CellB % NumCellsX + 0.5f, CellB / NumCellsX + 0.5f) * CellSize;
+
+			// Columns without walkable surfaces are kept visible to be safe, far away ones are left to distance culling
+			if (CellSamples[CellA].Num() == 0 || CellSamples[CellB].Num() == 0 || FVector2D::Distance(CenterA, CenterB) - CellDiagonal > MaxTraceDistance)
+			{
+				VisibleCells[CellA].Add(CellB);
+				continue;
+			}
+
+			bool bVisible = false;
+			for (const FVector& SampleA : CellSamples[CellA])
+			{
+				for (const FVector& SampleB : CellSamples[CellB])
+				{
+					if (!World->LineTraceTestByChannel(SampleA, SampleB, ECC_Visibility, TraceParams))
+					{
+						bVisible = true;
+						break;
+					}
+				}
+
+				if (bVisible)
+				{
+					break;
+				}
+			}
+
+			if (bVisible)
+			{
+				VisibleCells[CellA].Add(CellB);
+			}
+		}
+	});
+
+	TBitArray<> DirectVisibility(false, NumCells * NumCells);
+	for (int32 CellA = 0; CellA < NumCells; CellA++)
+	{
+		DirectVisibility[CellA * NumCells + CellA] = true;
+		for (int32 CellB : VisibleCells[CellA])
+		{
+			DirectVisibility[CellA * NumCells + CellB] = true;
+			DirectVisibility[CellB * NumCells + CellA] = true;
+		}
+	}
+
+	// Dilate: a cell sees the neighbors of every cell it sees
+	Visibility.Init(false, NumCells * NumCells);
+	for (int32 CellA = 0; CellA < NumCells; CellA++)
+	{
+		for (int32 CellB = 0; CellB < NumCells; CellB++)
+		{
+			if (!DirectVisibility[CellA * NumCells + CellB])
+			{
+				continue;
+			}
+
+			const int32 CellX = CellB % NumCellsX;
+			const int32 CellY = CellB / NumCellsX;
+			for (int32 NeighborY = FMath::Max(CellY - 1, 0); NeighborY <= FMath::Min(CellY + 1, NumCellsY - 1); NeighborY++)
+			{
+				for (int32 NeighborX = FMath::Max(CellX - 1, 0); NeighborX <= FMath::Min(CellX + 1, NumCellsX - 1); NeighborX++)
+				{
+					Visibility[CellA * NumCells + NeighborY * NumCellsX + NeighborX] = true;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+bool FShooterPVSData::Load(const FString& MapName)
+{
+	Reset();
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *GetFilename(MapName), FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	Reader << *this;
+
+	if (Reader.IsError() || !IsValid())
+	{
+		Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FShooterPVSData::Save(const FString& MapName) const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	Writer << const_cast<FShooterPVSData&>(*this);
+
+	return FFileHelper::SaveArrayToFile(Bytes, *GetFilename(MapName));
+}
+
+FString FShooterPVSData::GetMapName(const UWorld* World)
+{
+	return FPackageName::GetShortName(UWorld::RemovePIEPrefix(World->GetOutermost()->GetName()));
+}
+
+FString FShooterPVSData::GetFilename(const FString& MapName)
+{
+	return FPaths::ProjectContentDir() / TEXT("PVS") / MapName + TEXT(".pvs");
+}
+
+FArchive& operator<<(FArchive& Ar, FShooterPVSData& Data)
+{
+	uint32 Magic = ShooterPVS::FileMagic;
+	int32 Version = ShooterPVS::FileVersion;
+	Ar << Magic;
+	Ar << Version;
+
+	if (Ar.IsLoading() && (Magic != ShooterPVS::FileMagic || Version != ShooterPVS::FileVersion))
+	{
+		Ar.SetError();
+		return Ar;
+	}
+
+	Ar << Data.Origin;
+	Ar << Data.CellSize;
+	Ar << Data.NumCellsX;
+	Ar << Data.NumCellsY;
+	Ar << Data.Visibility;
+
+	return Ar;
+}
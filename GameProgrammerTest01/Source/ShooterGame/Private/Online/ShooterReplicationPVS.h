@@ -0,0 +1,71 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Precomputed cell to cell visibility (potentially visible set) of a map, used by the replication graph to cull occluded actors without traces.
+ *
+ * The map is divided into vertical columns of CellSize x CellSize. Visibility is computed offline with ShooterRepGraph.BuildPVS by tracing between
+ * eye height sample points on the walkable surfaces of each pair of columns, then dilated by one cell to cover what the sparse samples miss.
+ * The result is stored as a NumCells x NumCells bitset in Content/PVS/<MapName>.pvs, which is staged with the game.
+ */
+struct FShooterPVSData
+{
+	/** Min corner of the grid */
+	FVector2D Origin = FVector2D::ZeroVector;
+
+	float CellSize = 0.f;
+
+	int32 NumCellsX = 0;
+
+	int32 NumCellsY = 0;
+
+	/** Row per viewer cell, bit per target cell */
+	TBitArray<> Visibility;
+
+	bool IsValid() const { return NumCellsX > 0 && NumCellsY > 0 && Visibility.Num() == GetNumCells() * GetNumCells(); }
+
+	int32 GetNumCells() const { return NumCellsX * NumCellsY; }
+
+	/** Returns the cell containing Location, or INDEX_NONE when outside of the grid */
+	int32 GetCellIndex(const FVector& Location) const
+	{
+		const int32 CellX = FMath::FloorToInt((Location.X - Origin.X) / CellSize);
+		const int32 CellY = FMath::FloorToInt((Location.Y - Origin.Y) / CellSize);
+		return (CellX >= 0 && CellX < NumCellsX && CellY >= 0 && CellY < NumCellsY) ? CellY * NumCellsX + CellX : INDEX_NONE;
+	}
+
+	/** Whether anything in ToCell may be visible from FromCell */
+	bool IsVisible(int32 FromCell, int32 ToCell) const
+	{
+		return Visibility[FromCell * GetNumCells() + ToCell];
+	}
+
+	void Reset();
+
+	/**
+	 * Computes visibility for the world's loaded levels.
+	 *
+	 * @param World				World to build for, all levels that should affect visibility need to be loaded.
+	 * @param InCellSize		Requested cell size. Grown if the map would need more than MaxCells cells.
+	 * @param MaxTraceDistance	Cell pairs farther apart than this are marked visible without tracing, distance culling takes care of them.
+	 */
+	bool Build(UWorld* World, float InCellSize, float MaxTraceDistance);
+
+	/** Loads the PVS file of given map, returns false if there is none or it is out of date */
+	bool Load(const FString& MapName);
+
+	bool Save(const FString& MapName) const;
+
+	/** Short name of the map the world was loaded from, PVS files are keyed by it */
+	static FString GetMapName(const UWorld* World);
+
+	static FString GetFilename(const FString& MapName);
+
+	friend FArchive& operator<<(FArchive& Ar, FShooterPVSData& Data);
+
+	/** Upper bound on cells, keeps the bitset at 2MB */
+	static const int32 MaxCells = 4096;
+};
@@ -2,6 +2,7 @@
 
 #include "ShooterGame.h"
 #include "Pickups/ShooterPickup.h"
+#include "Pickups/ShooterPickupRegistry.h"
 #include "Particles/ParticleSystemComponent.h"
 
 AShooterPickup::AShooterPickup(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
@@ -25,19 +26,32 @@ AShooterPickup::AShooterPickup(const FObjectInitializer& ObjectInitializer) : Su
 
 	SetRemoteRoleForBackwardsCompat(ROLE_SimulatedProxy);
 	bReplicates = true;
+	NetDormancy = DORM_DormantAll;
 }
 
 void AShooterPickup::BeginPlay()
 {
 	Super::BeginPlay();
 
+	// registers in the pickup registry (server only) as it becomes active
 	RespawnPickup();
+}
 
-	// register on pickup list (server only), don't care about unregistering (in FinishDestroy) - no streaming
-	AShooterGameMode* GameMode = GetWorld()->GetAuthGameMode<AShooterGameMode>();
-	if (GameMode)
+void AShooterPickup::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UShooterPickupRegistry* Registry = UShooterPickupRegistry::Get(GetWorld()))
 	{
-		GameMode->LevelPickups.Add(this);
+		Registry->SetPickupAvailable(this, false);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AShooterPickup::UpdatePickupRegistry()
+{
+	if (UShooterPickupRegistry* Registry = UShooterPickupRegistry::Get(GetWorld()))
+	{
+		Registry->SetPickupAvailable(this, bIsActive);
 	}
 }
 
@@ -62,12 +76,16 @@ void AShooterPickup::PickupOnTouch(class AShooterCharacter* Pawn)
 	{
 		if (CanBePickedUp(Pawn))
 		{
+			FlushNetDormancy();
 			GivePickupTo(Pawn);
 			PickedUpBy = Pawn;
+			MARK_PROPERTY_DIRTY_FROM_NAME(AShooterPickup, PickedUpBy, this);
 
 			if (!IsPendingKill())
 			{
 				bIsActive = false;
+				MARK_PROPERTY_DIRTY_FROM_NAME(AShooterPickup, bIsActive, this);
+				UpdatePickupRegistry();
 				OnPickedUp();
 
 				if (RespawnTime > 0.0f)
@@ -81,8 +99,12 @@ void AShooterPickup::PickupOnTouch(class AShooterCharacter* Pawn)
 
 void AShooterPickup::RespawnPickup()
 {
+	FlushNetDormancy();
 	bIsActive = true;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterPickup, bIsActive, this);
+	UpdatePickupRegistry();
 	PickedUpBy = NULL;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterPickup, PickedUpBy, this);
 	OnRespawned();
 
 	TSet<AActor*> OverlappingPawns;
@@ -151,6 +173,9 @@ void AShooterPickup::GetLifetimeReplicatedProps( TArray< FLifetimeProperty > & O
 {
 	Super::GetLifetimeReplicatedProps( OutLifetimeProps );
 
-	DOREPLIFETIME( AShooterPickup, bIsActive );
-	DOREPLIFETIME( AShooterPickup, PickedUpBy );
+	FDoRepLifetimeParams SharedParams;
+	SharedParams.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST( AShooterPickup, bIsActive, SharedParams );
+	DOREPLIFETIME_WITH_PARAMS_FAST( AShooterPickup, PickedUpBy, SharedParams );
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Pickups/ShooterPickupRegistry.h"
+
+void UShooterPickupRegistry::Deinitialize()
+{
+	AvailablePickups.Empty();
+
+	Super::Deinitialize();
+}
+
+UShooterPickupRegistry* UShooterPickupRegistry::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UShooterPickupRegistry>() : nullptr;
+}
+
+void UShooterPickupRegistry::SetPickupAvailable(AShooterPickup* Pickup, bool bAvailable)
+{
+	if (Pickup == nullptr)
+	{
+		return;
+	}
+
+	if (bAvailable)
+	{
+		AvailablePickups.FindOrAdd(Pickup->GetClass()).AddUnique(Pickup);
+	}
+	else if (TArray<TWeakObjectPtr<AShooterPickup>>* Bucket = AvailablePickups.Find(Pickup->GetClass()))
+	{
+		Bucket->RemoveSingleSwap(Pickup, false);
+	}
+}
@@ -19,6 +19,7 @@ void AShooterPickup_Health::GivePickupTo(class AShooterCharacter* Pawn)
 	if (Pawn)
 	{
 		Pawn->Health = FMath::Min(FMath::TruncToInt(Pawn->Health) + Health, Pawn->GetMaxHealth());
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, Health, Pawn);
 
 		// Fire event for collected health
 		const UWorld* World = GetWorld();
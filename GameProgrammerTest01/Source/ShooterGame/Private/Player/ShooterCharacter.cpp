@@ -5,6 +5,7 @@
 #include "Weapons/ShooterDamageType.h"
 #include "UI/ShooterHUD.h"
 #include "Online/ShooterPlayerState.h"
+#include "Player/ShooterPawnSpatialIndex.h"
 #include "Animation/AnimMontage.h"
 #include "Animation/AnimInstance.h"
 #include "Sound/SoundNodeLocalPlayer.h"
@@ -64,6 +65,7 @@ AShooterCharacter::AShooterCharacter(const FObjectInitializer& ObjectInitializer
 	RunningSpeedModifier = 1.5f;
 	bWantsToRun = false;
 	bWantsToFire = false;
+	bReplicationCulledByPVS = false;
 	LowHealthPercentage = 0.5f;
 
 	BaseTurnRate = 45.f;
@@ -86,6 +88,7 @@ void AShooterCharacter::PostInitializeComponents()
 	if (GetLocalRole() == ROLE_Authority)
 	{
 		Health = GetMaxHealth();
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, Health, this);
 
 		// Needs to happen after character is added to repgraph
 		GetWorldTimerManager().SetTimerForNextTick(this, &AShooterCharacter::SpawnDefaultInventory);
@@ -147,6 +150,12 @@ void AShooterCharacter::PossessedBy(class AController* InController)
 
 	// [server] as soon as PlayerState is assigned, set team colors of this pawn for local player
 	UpdateTeamColorsAllMIDs();
+
+	// [server] enemy queries filter on the team, which the index didn't know when this pawn spawned
+	if (UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(GetWorld()))
+	{
+		PawnIndex->OnPawnPossessed(this);
+	}
 }
 
 void AShooterCharacter::OnRep_PlayerState()
@@ -290,6 +299,7 @@ float AShooterCharacter::TakeDamage(float Damage, struct FDamageEvent const& Dam
 	if (ActualDamage > 0.f)
 	{
 		Health -= ActualDamage;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, Health, this);
 		if (Health <= 0)
 		{
 			Die(ActualDamage, DamageEvent, EventInstigator, DamageCauser);
@@ -329,6 +339,7 @@ bool AShooterCharacter::Die(float KillingDamage, FDamageEvent const& DamageEvent
 	}
 
 	Health = FMath::Min(0.0f, Health);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, Health, this);
 
 	// if this is an environmental death then refer to the previous killer so that they receive credit (knocked into lava pits, etc)
 	UDamageType const* const DamageType = DamageEvent.DamageTypeClass ? DamageEvent.DamageTypeClass->GetDefaultObject<UDamageType>() : GetDefault<UDamageType>();
@@ -568,6 +579,7 @@ void AShooterCharacter::ReplicateHit(float Damage, struct FDamageEvent const& Da
 	LastTakeHitInfo.SetDamageEvent(DamageEvent);
 	LastTakeHitInfo.bKilled = bKilled;
 	LastTakeHitInfo.EnsureReplication();
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, LastTakeHitInfo, this);
 
 	LastTakeHitTimeTimeout = TimeoutTime;
 }
@@ -649,6 +661,7 @@ void AShooterCharacter::AddWeapon(AShooterWeapon* Weapon)
 	{
 		Weapon->OnEnterInventory(this);
 		Inventory.AddUnique(Weapon);
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, Inventory, this);
 	}
 }
 
@@ -658,6 +671,7 @@ void AShooterCharacter::RemoveWeapon(AShooterWeapon* Weapon)
 	{
 		Weapon->OnLeaveInventory();
 		Inventory.RemoveSingle(Weapon);
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, Inventory, this);
 	}
 }
 
@@ -724,6 +738,7 @@ void AShooterCharacter::SetCurrentWeapon(AShooterWeapon* NewWeapon, AShooterWeap
 	}
 
 	CurrentWeapon = NewWeapon;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, CurrentWeapon, this);
 
 	// equip new one
 	if (NewWeapon)
@@ -775,6 +790,7 @@ bool AShooterCharacter::CanReload() const
 void AShooterCharacter::SetTargeting(bool bNewTargeting)
 {
 	bIsTargeting = bNewTargeting;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, bIsTargeting, this);
 
 	if (TargetingSound)
 	{
@@ -803,6 +819,7 @@ void AShooterCharacter::ServerSetTargeting_Implementation(bool bNewTargeting)
 void AShooterCharacter::SetRunning(bool bNewRunning, bool bToggle)
 {
 	bWantsToRun = bNewRunning;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, bWantsToRun, this);
 	bWantsToRunToggled = bNewRunning && bToggle;
 
 	if (GetLocalRole() < ROLE_Authority)
@@ -1176,6 +1193,7 @@ void AShooterCharacter::Tick(float DeltaSeconds)
 		if (this->Health < this->GetMaxHealth())
 		{
 			this->Health += 5 * DeltaSeconds;
+			MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, Health, this);
 			if (Health > this->GetMaxHealth())
 			{
 				Health = this->GetMaxHealth();
@@ -1343,22 +1361,36 @@ void AShooterCharacter::GetLifetimeReplicatedProps(TArray< FLifetimeProperty > &
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
+	// all properties are push based: they're only compared after being marked dirty
+	FDoRepLifetimeParams SharedParams;
+	SharedParams.bIsPushBased = true;
+
 	// only to local owner: weapon change requests are locally instigated, other clients don't need it
-	DOREPLIFETIME_CONDITION(AShooterCharacter, Inventory, COND_OwnerOnly);
+	SharedParams.Condition = COND_OwnerOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, Inventory, SharedParams);
 
 	// everyone except local owner: flag change is locally instigated
-	DOREPLIFETIME_CONDITION(AShooterCharacter, bIsTargeting, COND_SkipOwner);
-	DOREPLIFETIME_CONDITION(AShooterCharacter, bWantsToRun, COND_SkipOwner);
+	SharedParams.Condition = COND_SkipOwner;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, bIsTargeting, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, bWantsToRun, SharedParams);
 
-	DOREPLIFETIME_CONDITION(AShooterCharacter, LastTakeHitInfo, COND_Custom);
+	SharedParams.Condition = COND_Custom;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, LastTakeHitInfo, SharedParams);
 
 	// everyone
-	DOREPLIFETIME(AShooterCharacter, CurrentWeapon);
-	DOREPLIFETIME(AShooterCharacter, Health);
+	SharedParams.Condition = COND_None;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, CurrentWeapon, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, Health, SharedParams);
 }
 
 bool AShooterCharacter::IsReplicationPausedForConnection(const FNetViewer& ConnectionOwnerNetViewer)
 {
+	// Occlusion is already handled without traces by the replication graph when the map has a PVS
+	if (bReplicationCulledByPVS)
+	{
+		return false;
+	}
+
 	if (NetEnablePauseRelevancy == 1)
 	{
 		APlayerController* PC = Cast<APlayerController>(ConnectionOwnerNetViewer.InViewer);
@@ -32,7 +32,7 @@ void UShooterCheatManager::ToggleMatchTimer()
 	AShooterGameState* const MyGameState = MyPC->GetWorld()->GetGameState<AShooterGameState>();
 	if (MyGameState && MyGameState->GetLocalRole() == ROLE_Authority)
 	{
-		MyGameState->bTimerPaused = !MyGameState->bTimerPaused;
+		MyGameState->SetTimerPaused(!MyGameState->bTimerPaused);
 		MyPC->ClientMessage(FString::Printf(TEXT("Match timer: %s"), MyGameState->bTimerPaused ? TEXT("PAUSED") : TEXT("running")));
 	}
 }
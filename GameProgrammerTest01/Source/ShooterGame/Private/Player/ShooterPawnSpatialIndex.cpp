@@ -0,0 +1,504 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Player/ShooterPawnSpatialIndex.h"
+#include "Online/ShooterPlayerState.h"
+
+static float ShooterPawnIndexCellSize = 2500.f;
+FAutoConsoleVariableRef CVarShooterPawnIndexCellSize(
+	TEXT("ShooterGame.PawnIndexCellSize"),
+	ShooterPawnIndexCellSize,
+	TEXT("Cell size of the pawn spatial index grid, applied on the next rebuild"),
+	ECVF_Default);
+
+FShooterPawnGrid::FShooterPawnGrid(float InCellSize)
+	: CellSize(InCellSize)
+	, MinCell(0, 0)
+	, MaxCell(0, 0)
+{
+}
+
+FIntPoint FShooterPawnGrid::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void FShooterPawnGrid::Reset()
+{
+	Entries.Reset();
+	Cells.Reset();
+	AddedEntries.Reset();
+	MinCell = MaxCell = FIntPoint(0, 0);
+}
+
+void FShooterPawnGrid::Build(TArray<FEntry>& InEntries, float InCellSize)
+{
+	Reset();
+	CellSize = FMath::Max(InCellSize, 100.f);
+	Entries = MoveTemp(InEntries);
+
+	if (Entries.Num() == 0)
+	{
+		return;
+	}
+
+	for (FEntry& Entry : Entries)
+	{
+		Entry.Cell = GetCell(Entry.Location);
+	}
+
+	Entries.Sort([](const FEntry& A, const FEntry& B)
+	{
+		return A.Cell.Y != B.Cell.Y ? A.Cell.Y < B.Cell.Y : A.Cell.X < B.Cell.X;
+	});
+
+	MinCell = MaxCell = Entries[0].Cell;
+	FCellRange* Range = nullptr;
+	for (int32 Idx = 0; Idx < Entries.Num(); Idx++)
+	{
+		const FIntPoint Cell = Entries[Idx].Cell;
+		if (Range == nullptr || Cell != Entries[Idx - 1].Cell)
+		{
+			Range = &Cells.Add(Cell, FCellRange{ Idx, 0 });
+			MinCell = MinCell.ComponentMin(Cell);
+			MaxCell = MaxCell.ComponentMax(Cell);
+		}
+
+		Range->Num++;
+	}
+}
+
+void FShooterPawnGrid::Add(const FEntry& Entry)
+{
+	FEntry& NewEntry = AddedEntries.Add_GetRef(Entry);
+	NewEntry.Cell = GetCell(Entry.Location);
+}
+
+void FShooterPawnGrid::SetTeamNum(const APawn* Pawn, int32 TeamNum)
+{
+	// Possessions are rare and mostly hit pawns spawned this frame
+	for (TArray<FEntry>* List : { &AddedEntries, &Entries })
+	{
+		for (FEntry& Entry : *List)
+		{
+			if (Entry.Pawn.Get() == Pawn)
+			{
+				Entry.TeamNum = TeamNum;
+				return;
+			}
+		}
+	}
+}
+
+void FShooterPawnGrid::FindInRadius(const FVector& Origin, float Radius, TFunctionRef<bool(const FEntry&)> Filter, TArray<const FEntry*>& OutEntries) const
+{
+	OutEntries.Reset();
+
+	const float RadiusSq = FMath::Square(Radius);
+	auto Consider = [&](const FEntry& Entry)
+	{
+		if (FVector::DistSquared(Entry.Location, Origin) <= RadiusSq && Filter(Entry))
+		{
+			OutEntries.Add(&Entry);
+		}
+	};
+
+	for (const FEntry& Entry : AddedEntries)
+	{
+		Consider(Entry);
+	}
+
+	if (Cells.Num() == 0)
+	{
+		return;
+	}
+
+	// Clamped in float space, the radius may be huge
+	auto ToCell = [this](float Coord, int32 Lo, int32 Hi) { return FMath::FloorToInt(FMath::Clamp(Coord / CellSize, (float)Lo, (float)Hi)); };
+	const int32 MinX = ToCell(Origin.X - Radius, MinCell.X, MaxCell.X);
+	const int32 MaxX = ToCell(Origin.X + Radius, MinCell.X, MaxCell.X);
+	const int32 MinY = ToCell(Origin.Y - Radius, MinCell.Y, MaxCell.Y);
+	const int32 MaxY = ToCell(Origin.Y + Radius, MinCell.Y, MaxCell.Y);
+
+	if ((MaxX - MinX + 1) * (MaxY - MinY + 1) > Cells.Num())
+	{
+		// Fewer occupied cells than cells in range
+		for (const FEntry& Entry : Entries)
+		{
+			Consider(Entry);
+		}
+		return;
+	}
+
+	for (int32 Y = MinY; Y <= MaxY; Y++)
+	{
+		for (int32 X = MinX; X <= MaxX; X++)
+		{
+			if (const FCellRange* Range = Cells.Find(FIntPoint(X, Y)))
+			{
+				for (int32 Idx = Range->Start; Idx < Range->Start + Range->Num; Idx++)
+				{
+					Consider(Entries[Idx]);
+				}
+			}
+		}
+	}
+}
+
+void FShooterPawnGrid::FindNearest(const FVector& Origin, int32 MaxResults, float MaxRadius, TFunctionRef<bool(const FEntry&)> Filter, TArray<const FEntry*>& OutEntries) const
+{
+	OutEntries.Reset();
+
+	if (MaxResults <= 0)
+	{
+		return;
+	}
+
+	const float MaxRadiusSq = FMath::Square(MaxRadius);
+	TArray<TPair<float, const FEntry*>, TInlineAllocator<32>> Found;
+	auto Consider = [&](const FEntry& Entry)
+	{
+		const float DistSq = FVector::DistSquared(Entry.Location, Origin);
+		if (DistSq <= MaxRadiusSq && Filter(Entry))
+		{
+			Found.Emplace(DistSq, &Entry);
+		}
+	};
+	auto SortFound = [&Found]()
+	{
+		Found.Sort([](const TPair<float, const FEntry*>& A, const TPair<float, const FEntry*>& B) { return A.Key < B.Key; });
+	};
+
+	for (const FEntry& Entry : AddedEntries)
+	{
+		Consider(Entry);
+	}
+
+	if (Cells.Num() > 0)
+	{
+		// Search rings of cells around the origin's cell outwards, up to the last ring holding occupied cells in range
+		const FIntPoint Center = GetCell(Origin);
+		int32 LastRing = FMath::Max(
+			FMath::Max(FMath::Abs(Center.X - MinCell.X), FMath::Abs(MaxCell.X - Center.X)),
+			FMath::Max(FMath::Abs(Center.Y - MinCell.Y), FMath::Abs(MaxCell.Y - Center.Y)));
+		if (MaxRadius < LastRing * CellSize)
+		{
+			LastRing = FMath::CeilToInt(MaxRadius / CellSize);
+		}
+
+		int32 NumVisitedCells = 0;
+		auto VisitCell = [&](int32 X, int32 Y)
+		{
+			NumVisitedCells++;
+			if (const FCellRange* Range = Cells.Find(FIntPoint(X, Y)))
+			{
+				for (int32 Idx = Range->Start; Idx < Range->Start + Range->Num; Idx++)
+				{
+					Consider(Entries[Idx]);
+				}
+			}
+		};
+
+		for (int32 Ring = 0; Ring <= LastRing; Ring++)
+		{
+			if (NumVisitedCells > Cells.Num())
+			{
+				// Mostly empty rings, cheaper to go through the entries that are left
+				for (const FEntry& Entry : Entries)
+				{
+					if (FMath::Max(FMath::Abs(Entry.Cell.X - Center.X), FMath::Abs(Entry.Cell.Y - Center.Y)) >= Ring)
+					{
+						Consider(Entry);
+					}
+				}
+				break;
+			}
+
+			if (Ring == 0)
+			{
+				VisitCell(Center.X, Center.Y);
+			}
+			else
+			{
+				for (int32 X = -Ring; X <= Ring; X++)
+				{
+					VisitCell(Center.X + X, Center.Y - Ring);
+					VisitCell(Center.X + X, Center.Y + Ring);
+				}
+				for (int32 Y = -Ring + 1; Y < Ring; Y++)
+				{
+					VisitCell(Center.X - Ring, Center.Y + Y);
+					VisitCell(Center.X + Ring, Center.Y + Y);
+				}
+			}
+
+			// Entries in the rings further out are at least Ring cells away
+			if (Found.Num() >= MaxResults)
+			{
+				SortFound();
+				if (Found[MaxResults - 1].Key <= FMath::Square(Ring * CellSize))
+				{
+					break;
+				}
+			}
+		}
+	}
+
+	SortFound();
+
+	const int32 NumResults = FMath::Min(MaxResults, Found.Num());
+	OutEntries.Reserve(NumResults);
+	for (int32 Idx = 0; Idx < NumResults; Idx++)
+	{
+		OutEntries.Add(Found[Idx].Value);
+	}
+}
+
+FShooterPawnQueryFilter FShooterPawnQueryFilter::MakeEnemyFilter(const AController* Controller)
+{
+	FShooterPawnQueryFilter Filter;
+	Filter.PawnClass = AShooterCharacter::StaticClass();
+	Filter.IgnorePawn = Controller ? Controller->GetPawn() : nullptr;
+	Filter.bAliveOnly = true;
+
+	// Only team games keep teammates from being enemies, see AShooterGame_TeamDeathMatch::CanDealDamage
+	const AShooterGameState* MyGameState = Controller ? Controller->GetWorld()->GetGameState<AShooterGameState>() : nullptr;
+	const AShooterPlayerState* MyPlayerState = Controller ? Controller->GetPlayerState<AShooterPlayerState>() : nullptr;
+	if (MyGameState && MyGameState->NumTeams > 1 && MyPlayerState)
+	{
+		Filter.ExcludeTeamNum = MyPlayerState->GetTeamNum();
+	}
+
+	return Filter;
+}
+
+void UShooterPawnSpatialIndex::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	MaxPawnRadius = 0.f;
+	MaxPawnHalfHeight = 0.f;
+	PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &UShooterPawnSpatialIndex::OnWorldPreActorTick);
+	ActorSpawnedHandle = GetWorld()->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UShooterPawnSpatialIndex::OnActorSpawned));
+}
+
+void UShooterPawnSpatialIndex::Deinitialize()
+{
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+	GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	Grid.Reset();
+
+	Super::Deinitialize();
+}
+
+UShooterPawnSpatialIndex* UShooterPawnSpatialIndex::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UShooterPawnSpatialIndex>() : nullptr;
+}
+
+void UShooterPawnSpatialIndex::OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_ShooterPawnSpatialIndex_Rebuild);
+
+	MaxPawnRadius = 0.f;
+	MaxPawnHalfHeight = 0.f;
+
+	TArray<FShooterPawnGrid::FEntry> Entries;
+	Entries.Reserve(Grid.Num());
+	for (APawn* Pawn : TActorRange<APawn>(World))
+	{
+		if (!Pawn->IsPendingKill())
+		{
+			MakeEntry(Pawn, Entries.AddDefaulted_GetRef());
+		}
+	}
+
+	Grid.Build(Entries, ShooterPawnIndexCellSize);
+}
+
+void UShooterPawnSpatialIndex::OnActorSpawned(AActor* Actor)
+{
+	// spawn point checks for players restarted in the same frame have to see each other
+	APawn* Pawn = Cast<APawn>(Actor);
+	if (Pawn)
+	{
+		FShooterPawnGrid::FEntry Entry;
+		MakeEntry(Pawn, Entry);
+		Grid.Add(Entry);
+	}
+}
+
+void UShooterPawnSpatialIndex::MakeEntry(APawn* Pawn, FShooterPawnGrid::FEntry& OutEntry)
+{
+	float Radius = 0.f;
+	float HalfHeight = 0.f;
+	Pawn->GetSimpleCollisionCylinder(Radius, HalfHeight);
+	MaxPawnRadius = FMath::Max(MaxPawnRadius, Radius);
+	MaxPawnHalfHeight = FMath::Max(MaxPawnHalfHeight, HalfHeight);
+
+	const AShooterPlayerState* PlayerState = Pawn->GetPlayerState<AShooterPlayerState>();
+	OutEntry.Pawn = Pawn;
+	OutEntry.Location = Pawn->GetActorLocation();
+	OutEntry.TeamNum = PlayerState ? PlayerState->GetTeamNum() : INDEX_NONE;
+}
+
+void UShooterPawnSpatialIndex::OnPawnPossessed(APawn* Pawn)
+{
+	// pawns are indexed when spawned, before the controller possessing them gives them a PlayerState
+	const AShooterPlayerState* PlayerState = Pawn ? Pawn->GetPlayerState<AShooterPlayerState>() : nullptr;
+	if (PlayerState)
+	{
+		Grid.SetTeamNum(Pawn, PlayerState->GetTeamNum());
+	}
+}
+
+bool UShooterPawnSpatialIndex::PassesFilter(const FShooterPawnGrid::FEntry& Entry, const FShooterPawnQueryFilter& Filter) const
+{
+	if ((Filter.TeamNum != INDEX_NONE && Entry.TeamNum != Filter.TeamNum)
+		|| (Filter.ExcludeTeamNum != INDEX_NONE && Entry.TeamNum == Filter.ExcludeTeamNum))
+	{
+		return false;
+	}
+
+	const APawn* Pawn = Entry.Pawn.Get();
+	if (Pawn == nullptr || Pawn->IsPendingKill() || Pawn == Filter.IgnorePawn
+		|| (Filter.PawnClass && !Pawn->IsA(Filter.PawnClass)))
+	{
+		return false;
+	}
+
+	if (Filter.bAliveOnly)
+	{
+		const AShooterCharacter* Character = Cast<AShooterCharacter>(Pawn);
+		if (Character && !Character->IsAlive())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void UShooterPawnSpatialIndex::FindPawnsInRadius(const FVector& Origin, float Radius, const FShooterPawnQueryFilter& Filter, TArray<APawn*>& OutPawns) const
+{
+	TArray<const FShooterPawnGrid::FEntry*> Entries;
+	Grid.FindInRadius(Origin, Radius, [this, &Filter](const FShooterPawnGrid::FEntry& Entry) { return PassesFilter(Entry, Filter); }, Entries);
+
+	OutPawns.Reset(Entries.Num());
+	for (const FShooterPawnGrid::FEntry* Entry : Entries)
+	{
+		OutPawns.Add(Entry->Pawn.Get());
+	}
+}
+
+void UShooterPawnSpatialIndex::FindNearestPawns(const FVector& Origin, int32 MaxResults, const FShooterPawnQueryFilter& Filter, TArray<APawn*>& OutPawns, float MaxRadius) const
+{
+	TArray<const FShooterPawnGrid::FEntry*> Entries;
+	Grid.FindNearest(Origin, MaxResults, MaxRadius, [this, &Filter](const FShooterPawnGrid::FEntry& Entry) { return PassesFilter(Entry, Filter); }, Entries);
+
+	OutPawns.Reset(Entries.Num());
+	for (const FShooterPawnGrid::FEntry* Entry : Entries)
+	{
+		OutPawns.Add(Entry->Pawn.Get());
+	}
+}
+
+namespace ShooterPawnSpatialIndex
+{
+	/** Times a frame of bot queries (every pawn looks for its nearest enemy and its neighbours) on the grid and by brute force */
+	static void RunBenchmark(int32 NumPawns, int32 NumFrames)
+	{
+		// Roughly the playable area of Highrise
+		const float MapExtent = 15000.f;
+		const float NeighbourRadius = 2000.f;
+
+		FRandomStream Random(NumPawns);
+		TArray<FShooterPawnGrid::FEntry> Pawns;
+		for (int32 Idx = 0; Idx < NumPawns; Idx++)
+		{
+			FShooterPawnGrid::FEntry& Entry = Pawns.AddDefaulted_GetRef();
+			Entry.Location = FVector(Random.FRandRange(-MapExtent, MapExtent), Random.FRandRange(-MapExtent, MapExtent), Random.FRandRange(0.f, 2000.f));
+			Entry.TeamNum = Idx % 2;
+		}
+
+		FShooterPawnGrid Grid;
+		TArray<FShooterPawnGrid::FEntry> BuildEntries;
+		TArray<const FShooterPawnGrid::FEntry*> Results;
+		TArray<float> GridNearestDistSq;
+		TArray<int32> GridNumNeighbours;
+		GridNearestDistSq.SetNumUninitialized(NumPawns);
+		GridNumNeighbours.SetNumUninitialized(NumPawns);
+
+		double BuildSeconds = 0.0;
+		double GridSeconds = 0.0;
+		double BruteForceSeconds = 0.0;
+		int32 NumMismatches = 0;
+
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			BuildEntries = Pawns;
+
+			double StartTime = FPlatformTime::Seconds();
+			Grid.Build(BuildEntries, ShooterPawnIndexCellSize);
+			BuildSeconds += FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			for (int32 Idx = 0; Idx < NumPawns; Idx++)
+			{
+				const FShooterPawnGrid::FEntry& Querier = Pawns[Idx];
+				Grid.FindNearest(Querier.Location, 1, MAX_FLT, [&Querier](const FShooterPawnGrid::FEntry& Entry) { return Entry.TeamNum != Querier.TeamNum; }, Results);
+				GridNearestDistSq[Idx] = Results.Num() > 0 ? FVector::DistSquared(Results[0]->Location, Querier.Location) : -1.f;
+
+				Grid.FindInRadius(Querier.Location, NeighbourRadius, [](const FShooterPawnGrid::FEntry& Entry) { return true; }, Results);
+				GridNumNeighbours[Idx] = Results.Num();
+			}
+			GridSeconds += FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			for (int32 Idx = 0; Idx < NumPawns; Idx++)
+			{
+				const FShooterPawnGrid::FEntry& Querier = Pawns[Idx];
+				float BestDistSq = MAX_FLT;
+				int32 NumNeighbours = 0;
+				for (const FShooterPawnGrid::FEntry& Other : Pawns)
+				{
+					const float DistSq = FVector::DistSquared(Other.Location, Querier.Location);
+					if (Other.TeamNum != Querier.TeamNum && DistSq < BestDistSq)
+					{
+						BestDistSq = DistSq;
+					}
+					NumNeighbours += DistSq <= FMath::Square(NeighbourRadius) ? 1 : 0;
+				}
+
+				const float NearestDistSq = BestDistSq < MAX_FLT ? BestDistSq : -1.f;
+				NumMismatches += (NearestDistSq != GridNearestDistSq[Idx] || NumNeighbours != GridNumNeighbours[Idx]) ? 1 : 0;
+			}
+			BruteForceSeconds += FPlatformTime::Seconds() - StartTime;
+		}
+
+		const double MicrosecondsPerFrame = 1000000.0 / FMath::Max(NumFrames, 1);
+		UE_LOG(LogShooter, Display, TEXT("%4d pawns: build %8.2f us, grid queries %9.2f us, brute force %9.2f us per frame (%d mismatches)"),
+			NumPawns, BuildSeconds * MicrosecondsPerFrame, GridSeconds * MicrosecondsPerFrame, BruteForceSeconds * MicrosecondsPerFrame, NumMismatches);
+	}
+}
+
+FAutoConsoleCommand ShooterBenchmarkPawnIndexCmd(TEXT("ShooterGame.BenchmarkPawnIndex"), TEXT("Times nearest enemy and neighbour queries for 16, 64 and 256 random pawns on the pawn index grid against brute force. Optional argument: frames (default 1000)"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		int32 NumFrames = 1000;
+		if (Args.Num() > 0)
+		{
+			LexTryParseString<int32>(NumFrames, *Args[0]);
+		}
+
+		for (int32 NumPawns : { 16, 64, 256 })
+		{
+			ShooterPawnSpatialIndex::RunBenchmark(NumPawns, FMath::Max(NumFrames, 1));
+		}
+	})
+);
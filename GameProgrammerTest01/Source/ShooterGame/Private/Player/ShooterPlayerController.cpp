@@ -19,6 +19,7 @@
 #include "ShooterGameInstance.h"
 #include "ShooterLeaderboards.h"
 #include "ShooterGameViewportClient.h"
+#include "ShooterStartupTimer.h"
 #include "Sound/SoundNodeLocalPlayer.h"
 #include "AudioThread.h"
 #include "OnlineSubsystemUtils.h"
@@ -119,6 +120,13 @@ void AShooterPlayerController::TickActor(float DeltaTime, enum ELevelTick TickTy
 {
 	Super::TickActor(DeltaTime, TickType, ThisTickFunction);
 
+	// first frame with a possessed pawn ends the startup or travel report, if one is running. During seamless travel
+	// the pawn is still the previous match's
+	if (GetPawn() && IsLocalController() && !GetWorld()->IsInSeamlessTravel())
+	{
+		FShooterStartupTimer::Playable(TEXT("pawn"));
+	}
+
 	if (IsGameMenuVisible())
 	{
 		if (ShooterFriendUpdateTimer > 0)
@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "ShooterDeterministicMode.h"
+
+bool FShooterDeterministicMode::bEnabled = false;
+int32 FShooterDeterministicMode::Seed = 0;
+float FShooterDeterministicMode::SimFPS = 30.f;
+FRandomStream FShooterDeterministicMode::Stream;
+
+void FShooterDeterministicMode::Initialize()
+{
+	bEnabled = FParse::Value(FCommandLine::Get(), TEXT("ShooterSeed="), Seed);
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	FParse::Value(FCommandLine::Get(), TEXT("ShooterSimFPS="), SimFPS);
+	SimFPS = FMath::Max(SimFPS, 1.f);
+
+	UE_LOG(LogShooter, Log, TEXT("Deterministic mode: seed %d, %.0f fps fixed timestep"), Seed, SimFPS);
+}
+
+void FShooterDeterministicMode::BeginMatch()
+{
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	// benchmarking: fixed delta every frame without waiting for real time to catch up
+	FApp::SetBenchmarking(true);
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / SimFPS);
+
+	Stream.Initialize(Seed);
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+
+	UE_LOG(LogShooter, Log, TEXT("Deterministic mode: match seeded with %d"), Seed);
+}
+
+int32 FShooterDeterministicMode::Rand()
+{
+	return bEnabled ? (int32)(Stream.GetUnsignedInt() & MAX_int32) : FMath::Rand();
+}
+
+float FShooterDeterministicMode::FRand()
+{
+	return bEnabled ? Stream.GetFraction() : FMath::FRand();
+}
+
+int32 FShooterDeterministicMode::RandHelper(int32 Max)
+{
+	return bEnabled ? Stream.RandHelper(Max) : FMath::RandHelper(Max);
+}
+
+void FShooterDeterministicMode::LogKill(const UWorld* World, const APlayerState* Killer, const APlayerState* Victim)
+{
+	if (bEnabled && World)
+	{
+		UE_LOG(LogShooter, Log, TEXT("Kill %.3f: %s killed %s"), World->GetTimeSeconds(),
+			Killer ? *Killer->GetPlayerName() : TEXT("nobody"), Victim ? *Victim->GetPlayerName() : TEXT("nobody"));
+	}
+}
@@ -20,6 +20,10 @@
 #include "Online/ShooterOnlineSessionClient.h"
 #include "OnlineSubsystemUtils.h"
 #include "ShooterGameUserSettings.h"
+#include "ShooterStartupTimer.h"
+#include "Misc/ScopeExit.h"
+#include "AssetRegistryModule.h"
+#include "IAssetRegistry.h"
 
 #if !defined(CONTROLLER_SWAPPING)
 	#define CONTROLLER_SWAPPING 0
@@ -31,6 +35,20 @@
 
 FAutoConsoleVariable CVarShooterGameTestEncryption(TEXT("ShooterGame.TestEncryption"), 0, TEXT("If true, clients will send an encryption token with their request to join the server and attempt to encrypt the connection using a debug key. This is NOT SECURE and for demonstration purposes only."));
 
+static int32 ShooterMapPreload = 1;
+static FAutoConsoleVariableRef CVarShooterMapPreload(
+	TEXT("ShooterGame.MapPreload"),
+	ShooterMapPreload,
+	TEXT("If true, the map about to be hosted is loaded in the background while in the menus."),
+	ECVF_Default);
+
+static int32 ShooterMapPreloadBudgetMB = 512;
+static FAutoConsoleVariableRef CVarShooterMapPreloadBudgetMB(
+	TEXT("ShooterGame.MapPreloadBudgetMB"),
+	ShooterMapPreloadBudgetMB,
+	TEXT("Maps with more than this many MB of packages left to load, by their size on disk, aren't preloaded."),
+	ECVF_Default);
+
 void SShooterWaitDialog::Construct(const FArguments& InArgs)
 {
 	const FShooterMenuItemStyle* ItemStyle = &FShooterStyle::Get().GetWidgetStyle<FShooterMenuItemStyle>("DefaultShooterMenuItemStyle");
@@ -97,10 +115,29 @@ UShooterGameInstance::UShooterGameInstance(const FObjectInitializer& ObjectIniti
 	, bIsLicensed(true) // Default to licensed (should have been checked by OS on boot)
 {
 	CurrentState = ShooterGameInstanceState::None;
+	MainMenuStateStartTime = 0.0;
+	PreloadedMapWorld = nullptr;
+	PreloadStartTime = 0.0;
+	bPreloadMapAlreadyLoaded = false;
+	bLoadingPreloadedMap = false;
+	bLoadingAlreadyLoadedMap = false;
+	MapLoadStartTime = 0.0;
+	bSeamlessTravelling = false;
 }
 
 void UShooterGameInstance::Init() 
 {
+	// loaded with the engine, before the game instance
+	IShooterGameLoadingScreenModule* LoadingScreenModule = FModuleManager::GetModulePtr<IShooterGameLoadingScreenModule>("ShooterGameLoadingScreen");
+	if (LoadingScreenModule != nullptr)
+	{
+		double StartTime, EndTime;
+		LoadingScreenModule->GetStartupTimes(StartTime, EndTime);
+		FShooterStartupTimer::AddPhase(TEXT("ShooterGameLoadingScreen module"), StartTime, EndTime);
+	}
+
+	FShooterStartupTimer::BeginPhase(TEXT("GameInstance Init"));
+
 	Super::Init();
 
 	IgnorePairingChangeForControllerId = -1;
@@ -136,6 +173,7 @@ void UShooterGameInstance::Init()
 
 	FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &UShooterGameInstance::OnPreLoadMap);
 	FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UShooterGameInstance::OnPostLoadMap);
+	FWorldDelegates::OnSeamlessTravelStart.AddUObject(this, &UShooterGameInstance::OnSeamlessTravelStart);
 
 	FCoreUObjectDelegates::PostDemoPlay.AddUObject(this, &UShooterGameInstance::OnPostDemoPlay);
 
@@ -170,6 +208,8 @@ void UShooterGameInstance::Init()
 	{
 		DebugTestEncryptionKey[i] = uint8(i);
 	}
+
+	FShooterStartupTimer::EndPhase(TEXT("GameInstance Init"));
 }
 
 void UShooterGameInstance::Shutdown()
@@ -254,6 +294,16 @@ void UShooterGameInstance::HandleSessionFailure( const FUniqueNetId& NetId, ESes
 
 void UShooterGameInstance::OnPreLoadMap(const FString& MapName)
 {
+	// still in flight counts too, the load waits for what's left
+	LoadingMapName = MapName;
+	bLoadingPreloadedMap = PreloadStartTime > 0.0 && PreloadMapName == MapName;
+	bLoadingAlreadyLoadedMap = bPreloadMapAlreadyLoaded && PreloadMapName == MapName;
+	bSeamlessTravelling = false;
+	MapLoadStartTime = FPlatformTime::Seconds();
+
+	FShooterStartupTimer::BeginTravel(MapName);
+	FShooterStartupTimer::BeginPhase(bLoadingPreloadedMap ? TEXT("LoadMap preloaded") : TEXT("LoadMap"));
+
 	if (bPendingEnableSplitscreen)
 	{
 		// Allow splitscreen
@@ -275,6 +325,68 @@ void UShooterGameInstance::OnPostLoadMap(UWorld*)
 	{
 		ShooterViewport->HideLoadingScreen();
 	}
+
+	FShooterStartupTimer::EndPhase(bLoadingPreloadedMap ? TEXT("LoadMap preloaded") : TEXT("LoadMap"));
+	FShooterStartupTimer::EndPhase(TEXT("LoadingScreen"));
+
+	const double LoadMs = (FPlatformTime::Seconds() - MapLoadStartTime) * 1000.0;
+	if (bSeamlessTravelling)
+	{
+		FShooterStartupTimer::EndPhase(TEXT("SeamlessTravel"));
+		UE_LOG(LogShooter, Log, TEXT("Seamless travel to %s took %.1f ms"), *LoadingMapName, LoadMs);
+	}
+	else if (bLoadingAlreadyLoadedMap)
+	{
+		// not a cold load, keep it out of the baseline
+		UE_LOG(LogShooter, Log, TEXT("Map %s loaded in %.1f ms, its package was already in memory"), *LoadingMapName, LoadMs);
+	}
+	else if (!bLoadingPreloadedMap)
+	{
+		MapLoadMsWithoutPreload.Add(LoadingMapName, LoadMs);
+		UE_LOG(LogShooter, Log, TEXT("Map %s loaded in %.1f ms"), *LoadingMapName, LoadMs);
+	}
+	else if (const double* LoadMsWithoutPreload = MapLoadMsWithoutPreload.Find(LoadingMapName))
+	{
+		UE_LOG(LogShooter, Log, TEXT("Map %s loaded in %.1f ms after preloading, %.1f ms saved"), *LoadingMapName, LoadMs, *LoadMsWithoutPreload - LoadMs);
+	}
+	else
+	{
+		UE_LOG(LogShooter, Log, TEXT("Map %s loaded in %.1f ms after preloading, no load without preloading to compare to yet"), *LoadingMapName, LoadMs);
+	}
+
+	// the world context holds the map now
+	ReleasePreloadedMap();
+	SeamlessTravelAssets.Reset();
+
+	// clients aren't playable until they possess a pawn, see AShooterPlayerController::TickActor, and after seamless
+	// travel the server waits for the travelling players, see AShooterGameMode::CheckTravellingPlayersArrived
+	if (IsRunningDedicatedServer() && !bSeamlessTravelling)
+	{
+		FShooterStartupTimer::Playable(TEXT("map loaded"));
+	}
+
+	bSeamlessTravelling = false;
+}
+
+void UShooterGameInstance::OnSeamlessTravelStart(UWorld* World, const FString& MapName)
+{
+	LoadingMapName = MapName;
+	bLoadingPreloadedMap = false;
+	bSeamlessTravelling = true;
+	MapLoadStartTime = FPlatformTime::Seconds();
+
+	// last frame of the match, the report runs until the next one is playable
+	FShooterStartupTimer::BeginTravel(MapName);
+	FShooterStartupTimer::BeginPhase(TEXT("SeamlessTravel"));
+
+	// the transition collects the old world with its assets, keep them when the same map loads again
+	SeamlessTravelAssets.Reset();
+	const FName CurrentPackageName = World->GetOutermost()->GetFName();
+	if (FPackageName::GetShortName(UWorld::RemovePIEPrefix(CurrentPackageName.ToString())) == FPackageName::GetShortName(UWorld::RemovePIEPrefix(MapName)))
+	{
+		GetLoadedDependencyAssets(CurrentPackageName, SeamlessTravelAssets);
+		UE_LOG(LogShooter, Log, TEXT("Keeping %d assets of %s loaded through seamless travel"), SeamlessTravelAssets.Num(), *MapName);
+	}
 }
 
 void UShooterGameInstance::OnUserCanPlayInvite(const FUniqueNetId& UserId, EUserPrivileges::Type Privilege, uint32 PrivilegeResults)
@@ -317,6 +429,12 @@ void UShooterGameInstance::HandleDemoPlaybackFailure( EDemoPlayFailure::Type Fai
 
 void UShooterGameInstance::StartGameInstance()
 {
+	FShooterStartupTimer::BeginPhase(TEXT("StartGameInstance"));
+	ON_SCOPE_EXIT
+	{
+		FShooterStartupTimer::EndPhase(TEXT("StartGameInstance"));
+	};
+
 #if PLATFORM_PS4 == 0
 	TCHAR Parm[4096] = TEXT("");
 
@@ -485,6 +603,9 @@ void UShooterGameInstance::ShowMessageThenGotoState( const FText& Message, const
 
 void UShooterGameInstance::ShowLoadingScreen()
 {
+	// travel from the menu starts here, before the session work and the map load
+	FShooterStartupTimer::BeginTravel(FString());
+
 	// This can be confusing, so here is what is happening:
 	//	For LoadMap, we use the IShooterGameLoadingScreenModule interface to show the load screen
 	//  This is necessary since this is a blocking call, and our viewport loading screen won't get updated.
@@ -503,6 +624,8 @@ void UShooterGameInstance::ShowLoadingScreen()
 	{
 		ShooterViewport->ShowLoadingScreen();
 	}
+
+	FShooterStartupTimer::BeginPhase(TEXT("LoadingScreen"));
 }
 
 bool UShooterGameInstance::LoadFrontEndMap(const FString& MapName)
@@ -529,7 +652,10 @@ bool UShooterGameInstance::LoadFrontEndMap(const FString& MapName)
 
 	if (URL.Valid && !HasAnyFlags(RF_ClassDefaultObject)) //CastChecked<UEngine>() will fail if using Default__ShooterGameInstance, so make sure that we're not default
 	{
+		const FString PhaseName = FString::Printf(TEXT("LoadFrontEndMap %s"), *FPackageName::GetShortName(MapName));
+		FShooterStartupTimer::BeginPhase(PhaseName);
 		BrowseRet = GetEngine()->Browse(*WorldContext, URL, Error);
+		FShooterStartupTimer::EndPhase(PhaseName);
 
 		// Handle failure.
 		if (BrowseRet != EBrowseReturnVal::Success)
@@ -630,11 +756,21 @@ void UShooterGameInstance::EndCurrentState(FName NextState)
 		EndPlayingState();
 	}
 
+	FShooterStartupTimer::EndPhase(FString::Printf(TEXT("State %s"), *CurrentState.ToString()));
+
 	CurrentState = ShooterGameInstanceState::None;
 }
 
 void UShooterGameInstance::BeginNewState(FName NewState, FName PrevState)
 {
+	// going to play always means travelling, make sure the report is running for the state's phase
+	if (NewState == ShooterGameInstanceState::Playing)
+	{
+		FShooterStartupTimer::BeginTravel(FString());
+	}
+
+	FShooterStartupTimer::BeginPhase(FString::Printf(TEXT("State %s"), *NewState.ToString()));
+
 	// per-state custom starting code here
 
 	if (NewState == ShooterGameInstanceState::PendingInvite)
@@ -659,6 +795,12 @@ void UShooterGameInstance::BeginNewState(FName NewState, FName PrevState)
 	}
 
 	CurrentState = NewState;
+
+	// the welcome screen takes input right away, the main menu once it is shown
+	if (!IsRunningDedicatedServer() && NewState == ShooterGameInstanceState::WelcomeScreen)
+	{
+		FShooterStartupTimer::Playable(TEXT("menu"));
+	}
 }
 
 void UShooterGameInstance::BeginPendingInviteState()
@@ -738,6 +880,8 @@ void UShooterGameInstance::SetPresenceForLocalPlayer(int32 LocalUserNum, const F
 
 void UShooterGameInstance::BeginMainMenuState()
 {
+	MainMenuStateStartTime = FPlatformTime::Seconds();
+
 	// Make sure we're not showing the loadscreen
 	UShooterGameViewportClient * ShooterViewport = Cast<UShooterGameViewportClient>(GetGameViewportClient());
 
@@ -765,9 +909,11 @@ void UShooterGameInstance::BeginMainMenuState()
 	// player 0 gets to own the UI
 	ULocalPlayer* const Player = GetFirstGamePlayer();
 
+	FShooterStartupTimer::BeginPhase(TEXT("MainMenu Construct"));
 	MainMenuUI = MakeShareable(new FShooterMainMenu());
 	MainMenuUI->Construct(this, Player);
 	MainMenuUI->AddMenuToGameViewport();
+	FShooterStartupTimer::EndPhase(TEXT("MainMenu Construct"));
 
 #if !SHOOTER_CONSOLE_UI
 	// The cached unique net ID is usually set on the welcome screen, but there isn't
@@ -2083,6 +2229,156 @@ void UShooterGameInstance::BeginHostingQuickMatch()
 	GetWorld()->ServerTravel(GetQuickMatchUrl());	
 }
 
+void UShooterGameInstance::PreloadMap(const FString& MapPackageName)
+{
+	if (MapPackageName == PreloadMapName)
+	{
+		return;
+	}
+
+	ReleasePreloadedMap();
+	PreloadMapName = MapPackageName;
+
+	if (!ShooterMapPreload || IsDedicatedServerInstance())
+	{
+		return;
+	}
+
+	if (FindPackage(nullptr, *MapPackageName) != nullptr)
+	{
+		bPreloadMapAlreadyLoaded = true;
+		return;
+	}
+
+	// stay within the budget and leave most of the free memory alone
+	const int64 LoadBytes = GetUnloadedPackageSize(FName(*MapPackageName));
+	const int64 BudgetBytes = FMath::Min<int64>((int64)ShooterMapPreloadBudgetMB * 1024 * 1024, FPlatformMemory::GetStats().AvailablePhysical / 2);
+	if (LoadBytes == INDEX_NONE)
+	{
+		UE_LOG(LogShooter, Log, TEXT("Not preloading %s, the asset registry has no package data for it"), *MapPackageName);
+		return;
+	}
+	else if (LoadBytes > BudgetBytes)
+	{
+		UE_LOG(LogShooter, Log, TEXT("Not preloading %s, %.1f MB to load is over the %.1f MB budget"), *MapPackageName, LoadBytes / (1024.0 * 1024.0), BudgetBytes / (1024.0 * 1024.0));
+		return;
+	}
+
+	UE_LOG(LogShooter, Log, TEXT("Preloading %s, %.1f MB to load"), *MapPackageName, LoadBytes / (1024.0 * 1024.0));
+	PreloadStartTime = FPlatformTime::Seconds();
+	LoadPackageAsync(MapPackageName, FLoadPackageAsyncDelegate::CreateUObject(this, &UShooterGameInstance::OnMapPreloaded));
+}
+
+void UShooterGameInstance::ReleasePreloadedMap()
+{
+	PreloadedMapWorld = nullptr;
+	PreloadMapName.Reset();
+	PreloadStartTime = 0.0;
+	bPreloadMapAlreadyLoaded = false;
+}
+
+void UShooterGameInstance::OnMapPreloaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
+{
+	// the selection may have moved on, or the map been loaded for real meanwhile
+	if (PreloadStartTime == 0.0 || PackageName.ToString() != PreloadMapName)
+	{
+		return;
+	}
+
+	if (Result != EAsyncLoadingResult::Succeeded || LoadedPackage == nullptr)
+	{
+		UE_LOG(LogShooter, Warning, TEXT("Preloading %s failed"), *PreloadMapName);
+		return;
+	}
+
+	// the package doesn't keep its world alive, the world keeps its level, actors and their assets
+	PreloadedMapWorld = UWorld::FindWorldInPackage(LoadedPackage);
+	UE_LOG(LogShooter, Log, TEXT("Preloaded %s in %.1f ms"), *PreloadMapName, (FPlatformTime::Seconds() - PreloadStartTime) * 1000.0);
+}
+
+int64 UShooterGameInstance::GetUnloadedPackageSize(FName PackageName)
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	// cooked registries only have package data and dependencies with [AssetRegistry] bSerializePackageData and bSerializeDependencies
+	if (AssetRegistry.GetAssetPackageData(PackageName) == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	int64 Size = 0;
+	TSet<FName> Visited;
+	TArray<FName> Pending;
+	TArray<FName> Dependencies;
+	Pending.Add(PackageName);
+
+	while (Pending.Num() > 0)
+	{
+		const FName Name = Pending.Pop(false);
+
+		bool bAlreadyVisited = false;
+		Visited.Add(Name, &bAlreadyVisited);
+		if (bAlreadyVisited || FindPackage(nullptr, *Name.ToString()) != nullptr)
+		{
+			continue;
+		}
+
+		if (const FAssetPackageData* PackageData = AssetRegistry.GetAssetPackageData(Name))
+		{
+			Size += PackageData->DiskSize;
+		}
+
+		Dependencies.Reset();
+		AssetRegistry.GetDependencies(Name, Dependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+		Pending.Append(Dependencies);
+	}
+
+	return Size;
+}
+
+void UShooterGameInstance::GetLoadedDependencyAssets(FName PackageName, TArray<UObject*>& OutAssets)
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	TSet<FName> Visited;
+	TArray<FName> Pending;
+	TArray<FName> Dependencies;
+	TArray<FAssetData> PackageAssets;
+	AssetRegistry.GetDependencies(PackageName, Pending, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+	if (Pending.Num() == 0)
+	{
+		UE_LOG(LogShooter, Warning, TEXT("The asset registry has no dependencies of %s, cooked builds need [AssetRegistry] bSerializeDependencies"), *PackageName.ToString());
+	}
+
+	while (Pending.Num() > 0)
+	{
+		const FName Name = Pending.Pop(false);
+
+		// what isn't loaded wasn't used, and isn't loaded through its dependencies either
+		bool bAlreadyVisited = false;
+		Visited.Add(Name, &bAlreadyVisited);
+		if (bAlreadyVisited || Name == PackageName || FindPackage(nullptr, *Name.ToString()) == nullptr)
+		{
+			continue;
+		}
+
+		PackageAssets.Reset();
+		AssetRegistry.GetAssetsByPackageName(Name, PackageAssets, true);
+		for (const FAssetData& Asset : PackageAssets)
+		{
+			// levels belong with their world
+			if (Asset.IsAssetLoaded() && Asset.AssetClass != UWorld::StaticClass()->GetFName())
+			{
+				OutAssets.Add(Asset.GetAsset());
+			}
+		}
+
+		Dependencies.Reset();
+		AssetRegistry.GetDependencies(Name, Dependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+		Pending.Append(Dependencies);
+	}
+}
+
 void UShooterGameInstance::ReceivedNetworkEncryptionToken(const FString& EncryptionToken, const FOnEncryptionKeyResponse& Delegate)
 {
 	// This is a simple implementation to demonstrate using encryption for game traffic using a hardcoded key.
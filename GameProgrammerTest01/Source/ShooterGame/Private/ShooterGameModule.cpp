@@ -2,6 +2,7 @@
 
 #include "ShooterGame.h"
 #include "ShooterGameDelegates.h"
+#include "ShooterDeterministicMode.h"
 
 #include "ShooterMenuSoundsWidgetStyle.h"
 #include "ShooterMenuWidgetStyle.h"
@@ -22,6 +23,7 @@ class FShooterGameModule : public FDefaultGameModuleImpl
 	virtual void StartupModule() override
 	{
 		InitializeShooterGameDelegates();
+		FShooterDeterministicMode::Initialize();
 		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
 
 		//Hot reload hack
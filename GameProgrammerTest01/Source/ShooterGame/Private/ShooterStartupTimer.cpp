@@ -0,0 +1,106 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "ShooterStartupTimer.h"
+#include "Misc/FileHelper.h"
+
+TArray<FShooterStartupTimer::FPhase> FShooterStartupTimer::Phases;
+FString FShooterStartupTimer::ReportName = TEXT("ColdStart");
+double FShooterStartupTimer::ReportStartTime = 0.0;
+bool FShooterStartupTimer::bTravelMapPending = false;
+
+void FShooterStartupTimer::BeginPhase(const FString& Name)
+{
+	if (!ReportName.IsEmpty())
+	{
+		Phases.Add({ Name, FPlatformTime::Seconds(), 0.0 });
+	}
+}
+
+void FShooterStartupTimer::EndPhase(const FString& Name)
+{
+	for (int32 Idx = Phases.Num() - 1; Idx >= 0; Idx--)
+	{
+		if (Phases[Idx].Name == Name && Phases[Idx].EndTime == 0.0)
+		{
+			Phases[Idx].EndTime = FPlatformTime::Seconds();
+			return;
+		}
+	}
+}
+
+void FShooterStartupTimer::AddPhase(const FString& Name, double StartTime, double EndTime)
+{
+	if (!ReportName.IsEmpty())
+	{
+		Phases.Add({ Name, StartTime, EndTime });
+	}
+}
+
+void FShooterStartupTimer::BeginTravel(const FString& MapName)
+{
+	if (ReportName.IsEmpty())
+	{
+		ReportStartTime = FPlatformTime::Seconds();
+		bTravelMapPending = true;
+	}
+	else if (!bTravelMapPending)
+	{
+		return;
+	}
+
+	// named once the map load tells us the map
+	if (MapName.IsEmpty())
+	{
+		ReportName = TEXT("Travel");
+	}
+	else
+	{
+		ReportName = FString::Printf(TEXT("Travel %s"), *FPackageName::GetShortName(MapName));
+		bTravelMapPending = false;
+	}
+}
+
+void FShooterStartupTimer::Playable(const TCHAR* What)
+{
+	if (!ReportName.IsEmpty())
+	{
+		WriteReport(What);
+	}
+}
+
+void FShooterStartupTimer::WriteReport(const TCHAR* What)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (ReportStartTime == 0.0)
+	{
+		// cold start counts from process start
+		ReportStartTime = GStartTime;
+	}
+
+	const TCHAR* Role = IsRunningDedicatedServer() ? TEXT("Server") : TEXT("Client");
+
+	UE_LOG(LogShooter, Log, TEXT("%s (%s) playable (%s) after %.1f ms:"), *ReportName, Role, What, (Now - ReportStartTime) * 1000.0);
+	UE_LOG(LogShooter, Log, TEXT("  %-40s %10s %10s"), TEXT("Phase"), TEXT("Start ms"), TEXT("Length ms"));
+
+	const FString Filename = FPaths::ProfilingDir() / TEXT("ShooterStartupTiming.csv");
+	FString Csv = IFileManager::Get().FileExists(*Filename) ? FString() : FString(TEXT("Report,Role,Phase,StartMs,LengthMs\n"));
+
+	for (const FPhase& Phase : Phases)
+	{
+		// phases still running end with the report
+		const double EndTime = Phase.EndTime != 0.0 ? Phase.EndTime : Now;
+		const double StartMs = (Phase.StartTime - ReportStartTime) * 1000.0;
+		const double LengthMs = (EndTime - Phase.StartTime) * 1000.0;
+
+		UE_LOG(LogShooter, Log, TEXT("  %-40s %10.1f %10.1f"), *Phase.Name, StartMs, LengthMs);
+		Csv += FString::Printf(TEXT("%s,%s,%s,%.1f,%.1f\n"), *ReportName, Role, *Phase.Name, StartMs, LengthMs);
+	}
+	Csv += FString::Printf(TEXT("%s,%s,Playable (%s),%.1f,0.0\n"), *ReportName, Role, What, (Now - ReportStartTime) * 1000.0);
+
+	FFileHelper::SaveStringToFile(Csv, *Filename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	Phases.Reset();
+	ReportName.Reset();
+	bTravelMapPending = false;
+}
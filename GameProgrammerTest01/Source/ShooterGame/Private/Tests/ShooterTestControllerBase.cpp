@@ -494,4 +494,95 @@ ULocalPlayer* UShooterTestControllerBase::GetFirstLocalPlayer() const
 	}
 
 	return nullptr;
+}
+
+float UShooterTestControllerBase::GetGameThreadFrameMs()
+{
+	// servers and fixed timestep runs sleep to keep their frame rate, that isn't work
+	return FMath::Max(FApp::GetDeltaTime() - FApp::GetIdleTime(), 0.0) * 1000.0;
+}
+
+float UShooterTestControllerBase::GetPercentile(const TArray<float>& SortedSamples, float Fraction)
+{
+	if (SortedSamples.Num() == 0)
+	{
+		return 0.f;
+	}
+
+	return SortedSamples[FMath::Clamp(FMath::CeilToInt(Fraction * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1)];
+}
+
+FShooterNetDriverTickTimer::~FShooterNetDriverTickTimer()
+{
+	// the world can outlive the test controller, e.g. when a test ends mid capture
+	Unregister();
+}
+
+void FShooterNetDriverTickTimer::Register(UWorld* InWorld, UNetDriver* NetDriver, bool bIncludeFlush)
+{
+	Unregister();
+
+	if (InWorld == nullptr)
+	{
+		return;
+	}
+
+	// World tick events call the last added handler first. Adding the end markers before the driver's handlers and
+	// the start markers after them brackets all of the driver's work, post tick handlers included
+	World = InWorld;
+	if (NetDriver)
+	{
+		NetDriver->UnregisterTickEvents(InWorld);
+	}
+
+	PostTickDispatchHandle = InWorld->OnPostTickDispatch().AddRaw(this, &FShooterNetDriverTickTimer::OnEnd);
+	if (bIncludeFlush)
+	{
+		PostTickFlushHandle = InWorld->OnPostTickFlush().AddRaw(this, &FShooterNetDriverTickTimer::OnEnd);
+	}
+
+	if (NetDriver)
+	{
+		NetDriver->RegisterTickEvents(InWorld);
+	}
+
+	TickDispatchHandle = InWorld->OnTickDispatch().AddRaw(this, &FShooterNetDriverTickTimer::OnStart);
+	if (bIncludeFlush)
+	{
+		TickFlushHandle = InWorld->OnTickFlush().AddRaw(this, &FShooterNetDriverTickTimer::OnStart);
+	}
+}
+
+void FShooterNetDriverTickTimer::Unregister()
+{
+	if (UWorld* RegisteredWorld = World.Get())
+	{
+		RegisteredWorld->OnTickDispatch().Remove(TickDispatchHandle);
+		RegisteredWorld->OnPostTickDispatch().Remove(PostTickDispatchHandle);
+		RegisteredWorld->OnTickFlush().Remove(TickFlushHandle);
+		RegisteredWorld->OnPostTickFlush().Remove(PostTickFlushHandle);
+	}
+
+	World = nullptr;
+	TickDispatchHandle.Reset();
+	PostTickDispatchHandle.Reset();
+	TickFlushHandle.Reset();
+	PostTickFlushHandle.Reset();
+}
+
+double FShooterNetDriverTickTimer::ConsumeSeconds()
+{
+	const double Result = Seconds;
+	Seconds = 0.0;
+	return Result;
+}
+
+void FShooterNetDriverTickTimer::OnStart(float DeltaSeconds)
+{
+	StartTime = FPlatformTime::Seconds();
+}
+
+void FShooterNetDriverTickTimer::OnEnd()
+{
+	Seconds += FPlatformTime::Seconds() - StartTime;
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+// Copyright Epic Games, Inc.All Rights Reserved.
+#include "Tests/ShooterTestControllerLoadClient.h"
+#include "ShooterGame.h"
+
+namespace ShooterLoadClient
+{
+	/** seconds of one fire cycle and of the burst at its start */
+	static const float FireCycle = 4.f;
+	static const float FireBurst = 1.5f;
+
+	/** seconds of one jetpack cycle and of the boost at its start */
+	static const float JetpackCycle = 7.f;
+	static const float JetpackBoost = 1.f;
+
+	/** degrees per second */
+	static const float TurnRate = 45.f;
+}
+
+void UShooterTestControllerLoadClient::OnInit()
+{
+	Super::OnInit();
+
+	Duration = 600.f;
+	Timeout  = 300.f;
+
+	FParse::Value(FCommandLine::Get(), TEXT("LoadClientDuration="), Duration);
+	FParse::Value(FCommandLine::Get(), TEXT("LoadClientTimeout="), Timeout);
+
+	GameTime = 0.f;
+	Phase = FMath::FRand() * ShooterLoadClient::JetpackCycle;
+	bFiring = false;
+	bJetpacking = false;
+}
+
+void UShooterTestControllerLoadClient::OnTick(float TimeDelta)
+{
+	// fails on network errors (MessageMenu)
+	Super::OnTick(TimeDelta);
+
+	APlayerController* PC = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+	AShooterCharacter* Pawn = PC ? Cast<AShooterCharacter>(PC->GetPawn()) : nullptr;
+
+	if (!IsInGame() || PC == nullptr || PC->GetNetMode() != NM_Client)
+	{
+		if (GetTimeInCurrentState() > Timeout)
+		{
+			UE_LOG(LogGauntlet, Error, TEXT("Failing load client, not connected after %.0f secs!"), Timeout);
+			EndTest(-1);
+		}
+		return;
+	}
+
+	GameTime += TimeDelta;
+	if (GameTime >= Duration)
+	{
+		EndTest(0);
+		return;
+	}
+
+	if (Pawn && Pawn->IsAlive())
+	{
+		DrivePawn(Pawn, TimeDelta);
+	}
+}
+
+void UShooterTestControllerLoadClient::OnPostMapChange(UWorld* World)
+{
+	// follow the server across match restarts, don't count cycled matches
+}
+
+void UShooterTestControllerLoadClient::DrivePawn(AShooterCharacter* Pawn, float TimeDelta)
+{
+	if (DrivenPawn != Pawn)
+	{
+		// new life, new input state
+		DrivenPawn = Pawn;
+		bFiring = false;
+		bJetpacking = false;
+	}
+
+	const float ScriptTime = GameTime + Phase;
+
+	// strafe around in circles
+	Pawn->MoveForward(1.f);
+	Pawn->MoveRight(FMath::Sin(ScriptTime * 0.5f));
+	if (AController* Controller = Pawn->GetController())
+	{
+		Controller->SetControlRotation(Controller->GetControlRotation() + FRotator(0.f, ShooterLoadClient::TurnRate * TimeDelta, 0.f));
+	}
+
+	const bool bWantsToFire = FMath::Fmod(ScriptTime, ShooterLoadClient::FireCycle) < ShooterLoadClient::FireBurst;
+	if (bWantsToFire != bFiring)
+	{
+		bFiring = bWantsToFire;
+		if (bFiring)
+		{
+			Pawn->OnStartFire();
+		}
+		else
+		{
+			Pawn->OnStopFire();
+		}
+	}
+
+	const bool bWantsToJetpack = FMath::Fmod(ScriptTime, ShooterLoadClient::JetpackCycle) < ShooterLoadClient::JetpackBoost;
+	if (bWantsToJetpack != bJetpacking)
+	{
+		bJetpacking = bWantsToJetpack;
+		if (bJetpacking)
+		{
+			Pawn->OnStartJetpack();
+		}
+		else
+		{
+			Pawn->OnStopJetpack();
+		}
+	}
+}
@@ -0,0 +1,186 @@
+// Copyright Epic Games, Inc.All Rights Reserved.
+#include "Tests/ShooterTestControllerLoadServer.h"
+#include "ShooterGame.h"
+#include "Online/ShooterReplicationGraphStats.h"
+#include "Engine/NetConnection.h"
+#include "Misc/FileHelper.h"
+
+void UShooterTestControllerLoadServer::OnInit()
+{
+	Super::OnInit();
+
+	SettleTime   = 10.f;
+	StepDuration = 30.f;
+	StepTimeout  = 300.f;
+
+	FString StepsString = TEXT("16,32,64,100");
+	FParse::Value(FCommandLine::Get(), TEXT("LoadSteps="), StepsString, false);
+	FParse::Value(FCommandLine::Get(), TEXT("LoadSettle="), SettleTime);
+	FParse::Value(FCommandLine::Get(), TEXT("LoadStepDuration="), StepDuration);
+	FParse::Value(FCommandLine::Get(), TEXT("LoadStepTimeout="), StepTimeout);
+
+	TArray<FString> StepStrings;
+	StepsString.ParseIntoArray(StepStrings, TEXT(","));
+	for (const FString& StepString : StepStrings)
+	{
+		Steps.Add(FCString::Atoi(*StepString));
+	}
+
+	StepIdx = 0;
+	StepTime = 0.f;
+	bMeasuring = false;
+
+	// replication graph time comes from its profiler
+	if (IConsoleVariable* ProfileCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("ShooterRepGraph.Profile")))
+	{
+		ProfileCVar->Set(1);
+	}
+}
+
+void UShooterTestControllerLoadServer::OnTick(float TimeDelta)
+{
+	if (!IsRunningDedicatedServer())
+	{
+		UE_LOG(LogGauntlet, Error, TEXT("Failing load test, the server controller needs a dedicated server!"));
+		EndTest(-1);
+		return;
+	}
+
+	if (StepIdx >= Steps.Num())
+	{
+		return;
+	}
+
+	StepTime += TimeDelta;
+
+	if (!bMeasuring)
+	{
+		// wait for the step's connections, then for them to spawn and start playing
+		if (GetNumConnections() < Steps[StepIdx])
+		{
+			if (StepTime > StepTimeout)
+			{
+				UE_LOG(LogGauntlet, Error, TEXT("Failing load test, %d of %d connections after %.0f secs!"), GetNumConnections(), Steps[StepIdx], StepTimeout);
+				WriteResults();
+				EndTest(-1);
+			}
+			return;
+		}
+
+		if (StepTime >= SettleTime)
+		{
+			StartStep();
+		}
+		return;
+	}
+
+	SampleFrame();
+
+	if (StepTime >= StepDuration)
+	{
+		FinishStep();
+	}
+}
+
+void UShooterTestControllerLoadServer::OnPostMapChange(UWorld* World)
+{
+	// clients follow the server across match restarts, don't count cycled matches
+}
+
+int32 UShooterTestControllerLoadServer::GetNumConnections() const
+{
+	const UWorld* World = GetWorld();
+	const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+	return NetDriver ? NetDriver->ClientConnections.Num() : 0;
+}
+
+uint64 UShooterTestControllerLoadServer::GetRepGraphCycles() const
+{
+	const UWorld* World = GetWorld();
+	const FShooterRepGraphProfiler* Profiler = World ? FShooterRepGraphProfiler::Get(World->GetNetDriver()) : nullptr;
+	return Profiler ? Profiler->GetScopeCycles(EShooterRepGraphProfileScope::ServerReplicateActors) : 0;
+}
+
+void UShooterTestControllerLoadServer::StartStep()
+{
+	UE_LOG(LogGauntlet, Display, TEXT("Load step %d: %d connections, measuring for %.0f secs."), StepIdx, GetNumConnections(), StepDuration);
+
+	bMeasuring = true;
+	StepTime = 0.f;
+
+	TickMs.Reset();
+	StartRepGraphCycles = GetRepGraphCycles();
+	NumFrames = 0;
+	OutBytesPerSecondSum = 0;
+	MaxOutBytesPerSecond = 0;
+	NumConnectionFrames = 0;
+	NumSaturatedConnectionFrames = 0;
+}
+
+void UShooterTestControllerLoadServer::SampleFrame()
+{
+	TickMs.Add(GetGameThreadFrameMs());
+	NumFrames++;
+
+	const UWorld* World = GetWorld();
+	const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+	if (NetDriver)
+	{
+		for (const UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			OutBytesPerSecondSum += Connection->OutBytesPerSecond;
+			MaxOutBytesPerSecond = FMath::Max(MaxOutBytesPerSecond, Connection->OutBytesPerSecond);
+			NumConnectionFrames++;
+
+			if (!const_cast<UNetConnection*>(Connection)->IsNetReady(false))
+			{
+				NumSaturatedConnectionFrames++;
+			}
+		}
+	}
+}
+
+void UShooterTestControllerLoadServer::FinishStep()
+{
+	bMeasuring = false;
+	StepTime = 0.f;
+
+	TickMs.Sort();
+	const float TickP50 = GetPercentile(TickMs, 0.50f);
+	const float TickP95 = GetPercentile(TickMs, 0.95f);
+
+	// a PrintProfile reset starts the count over
+	const uint64 RepGraphCycles = GetRepGraphCycles();
+	const uint64 StepRepGraphCycles = RepGraphCycles >= StartRepGraphCycles ? RepGraphCycles - StartRepGraphCycles : RepGraphCycles;
+	const float RepGraphMs = NumFrames > 0 ? FPlatformTime::ToMilliseconds64(StepRepGraphCycles) / NumFrames : 0.f;
+
+	const int32 AvgOutBytesPerSecond = NumConnectionFrames > 0 ? OutBytesPerSecondSum / NumConnectionFrames : 0;
+	const float SaturatedPct = NumConnectionFrames > 0 ? 100.f * NumSaturatedConnectionFrames / NumConnectionFrames : 0.f;
+
+	UE_LOG(LogGauntlet, Display, TEXT("Load step %d connections: tick p50 %.2f ms, p95 %.2f ms, replication graph %.2f ms/frame, out %d B/s avg, %d B/s max per connection, %.1f%% saturated"),
+		Steps[StepIdx], TickP50, TickP95, RepGraphMs, AvgOutBytesPerSecond, MaxOutBytesPerSecond, SaturatedPct);
+
+	Results.Add(FString::Printf(TEXT("%d,%d,%.3f,%.3f,%.3f,%d,%d,%.2f"),
+		Steps[StepIdx], GetNumConnections(), TickP50, TickP95, RepGraphMs, AvgOutBytesPerSecond, MaxOutBytesPerSecond, SaturatedPct));
+
+	if (++StepIdx >= Steps.Num())
+	{
+		WriteResults();
+		EndTest(0);
+	}
+}
+
+void UShooterTestControllerLoadServer::WriteResults() const
+{
+	FString Csv = TEXT("Step,Connections,TickP50Ms,TickP95Ms,RepGraphMsPerFrame,AvgOutBytesPerSec,MaxOutBytesPerSec,SaturatedPct\n");
+	for (const FString& Line : Results)
+	{
+		Csv += Line + TEXT("\n");
+	}
+
+	const FString Filename = FPaths::ProfilingDir() / TEXT("ShooterLoadTest.csv");
+	if (FFileHelper::SaveStringToFile(Csv, *Filename))
+	{
+		UE_LOG(LogGauntlet, Display, TEXT("Load test results written to %s"), *Filename);
+	}
+}
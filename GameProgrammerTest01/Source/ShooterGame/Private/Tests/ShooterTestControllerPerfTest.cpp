@@ -0,0 +1,175 @@
+// Copyright Epic Games, Inc.All Rights Reserved.
+#include "Tests/ShooterTestControllerPerfTest.h"
+#include "ShooterGame.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+void UShooterTestControllerPerfTest::OnInit()
+{
+	Super::OnInit();
+
+	WarmupTime            = 10.f;
+	CaptureTime           = 120.f;
+	Timeout               = 300.f;
+	GameThreadP95BudgetMs = 0.f;
+	GameThreadP99BudgetMs = 0.f;
+	NetTickP95BudgetMs    = 0.f;
+	MemoryBudgetMB        = 0.f;
+
+	FParse::Value(FCommandLine::Get(), TEXT("PerfWarmup="), WarmupTime);
+	FParse::Value(FCommandLine::Get(), TEXT("PerfDuration="), CaptureTime);
+	FParse::Value(FCommandLine::Get(), TEXT("PerfTimeout="), Timeout);
+	FParse::Value(FCommandLine::Get(), TEXT("GameThreadP95BudgetMs="), GameThreadP95BudgetMs);
+	FParse::Value(FCommandLine::Get(), TEXT("GameThreadP99BudgetMs="), GameThreadP99BudgetMs);
+	FParse::Value(FCommandLine::Get(), TEXT("NetTickP95BudgetMs="), NetTickP95BudgetMs);
+	FParse::Value(FCommandLine::Get(), TEXT("MemoryBudgetMB="), MemoryBudgetMB);
+
+	MatchTime = 0.f;
+	bCapturing = false;
+}
+
+void UShooterTestControllerPerfTest::OnTick(float TimeDelta)
+{
+	Super::OnTick(TimeDelta);
+
+	// the client joins the server's match, the server hosts it from its URL
+	if (!IsRunningDedicatedServer())
+	{
+		if (bIsLoggedIn && !bIsSearchingForGame && !bFoundGame)
+		{
+			StartSearchingForGame();
+		}
+
+		if (bIsSearchingForGame && !bFoundGame)
+		{
+			UpdateSearchStatus();
+		}
+	}
+
+	if (!bCapturing)
+	{
+		if (!IsMatchInProgress())
+		{
+			if (GetTimeInCurrentState() > Timeout)
+			{
+				UE_LOG(LogGauntlet, Error, TEXT("Failing perf test, no match in progress after %.0f secs!"), Timeout);
+				EndTest(-1);
+			}
+			return;
+		}
+
+		MatchTime += TimeDelta;
+		if (MatchTime >= WarmupTime)
+		{
+			StartCapture();
+		}
+		return;
+	}
+
+	SampleFrame(TimeDelta);
+
+	MatchTime += TimeDelta;
+	if (MatchTime >= CaptureTime)
+	{
+		FinishCapture();
+	}
+}
+
+void UShooterTestControllerPerfTest::OnPostMapChange(UWorld* World)
+{
+	// keep sampling across match restarts instead of counting cycled matches
+	if (bCapturing)
+	{
+		NetTickTimer.Register(World, World ? World->GetNetDriver() : nullptr, true);
+	}
+}
+
+bool UShooterTestControllerPerfTest::IsMatchInProgress() const
+{
+	const UWorld* World = GetWorld();
+	const AShooterGameState* GameState = World ? World->GetGameState<AShooterGameState>() : nullptr;
+	return GameState && GameState->HasMatchStarted();
+}
+
+void UShooterTestControllerPerfTest::StartCapture()
+{
+	UE_LOG(LogGauntlet, Display, TEXT("Starting perf capture for %.0f secs."), CaptureTime);
+
+	bCapturing = true;
+	MatchTime = 0.f;
+
+	const int32 ExpectedFrames = FMath::CeilToInt(CaptureTime * 60.f);
+	GameThreadMs.Reset(ExpectedFrames);
+	NetTickMs.Reset(ExpectedFrames);
+	MemoryMB.Reset(ExpectedFrames);
+
+	UWorld* World = GetWorld();
+	NetTickTimer.Register(World, World ? World->GetNetDriver() : nullptr, true);
+
+#if CSV_PROFILER
+	if (!FCsvProfiler::Get()->IsCapturing())
+	{
+		FCsvProfiler::Get()->BeginCapture();
+	}
+#endif
+}
+
+void UShooterTestControllerPerfTest::SampleFrame(float TimeDelta)
+{
+	GameThreadMs.Add(GetGameThreadFrameMs());
+	NetTickMs.Add(NetTickTimer.ConsumeSeconds() * 1000.0);
+	MemoryMB.Add(FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0));
+}
+
+void UShooterTestControllerPerfTest::FinishCapture()
+{
+	bCapturing = false;
+	NetTickTimer.Unregister();
+
+#if CSV_PROFILER
+	if (FCsvProfiler::Get()->IsCapturing())
+	{
+		FCsvProfiler::Get()->EndCapture();
+	}
+#endif
+
+	UE_LOG(LogGauntlet, Display, TEXT("Perf capture done (%s), %d frames."), IsRunningDedicatedServer() ? TEXT("server") : TEXT("client"), GameThreadMs.Num());
+
+	if (GameThreadMs.Num() == 0)
+	{
+		UE_LOG(LogGauntlet, Error, TEXT("Failing perf test, no frames captured!"));
+		EndTest(-1);
+		return;
+	}
+
+	bool bWithinBudget = true;
+	bWithinBudget &= ReportMetric(TEXT("GameThreadMs"), GameThreadMs, GameThreadP95BudgetMs, GameThreadP99BudgetMs);
+	bWithinBudget &= ReportMetric(TEXT("NetTickMs"), NetTickMs, NetTickP95BudgetMs, 0.f);
+	bWithinBudget &= ReportMetric(TEXT("MemoryMB"), MemoryMB, 0.f, MemoryBudgetMB);
+
+	EndTest(bWithinBudget ? 0 : -1);
+}
+
+bool UShooterTestControllerPerfTest::ReportMetric(const TCHAR* Name, TArray<float>& Samples, float P95Budget, float P99Budget)
+{
+	Samples.Sort();
+
+	const float P50 = GetPercentile(Samples, 0.50f);
+	const float P95 = GetPercentile(Samples, 0.95f);
+	const float P99 = GetPercentile(Samples, 0.99f);
+
+	UE_LOG(LogGauntlet, Display, TEXT("%s: p50 %.2f, p95 %.2f, p99 %.2f, max %.2f"), Name, P50, P95, P99, Samples.Last());
+
+	bool bWithinBudget = true;
+	if (P95Budget > 0.f && P95 > P95Budget)
+	{
+		UE_LOG(LogGauntlet, Error, TEXT("%s p95 %.2f is over its budget of %.2f!"), Name, P95, P95Budget);
+		bWithinBudget = false;
+	}
+	if (P99Budget > 0.f && P99 > P99Budget)
+	{
+		UE_LOG(LogGauntlet, Error, TEXT("%s p99 %.2f is over its budget of %.2f!"), Name, P99, P99Budget);
+		bWithinBudget = false;
+	}
+
+	return bWithinBudget;
+}
@@ -0,0 +1,261 @@
+// Copyright Epic Games, Inc.All Rights Reserved.
+#include "Tests/ShooterTestControllerReplayBenchmark.h"
+#include "ShooterGame.h"
+#include "Engine/DemoNetDriver.h"
+#include "Misc/FileHelper.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+CSV_DEFINE_CATEGORY(ShooterReplayBenchmark, true);
+
+void UShooterTestControllerReplayBenchmark::OnInit()
+{
+	Super::OnInit();
+
+	ReplayName   = TEXT("ShooterBenchmark");
+	BenchmarkFPS = 30.f;
+	Timeout      = 300.f;
+
+	FParse::Value(FCommandLine::Get(), TEXT("ReplayName="), ReplayName);
+	FParse::Value(FCommandLine::Get(), TEXT("ReplayBenchmarkFPS="), BenchmarkFPS);
+	FParse::Value(FCommandLine::Get(), TEXT("ReplayBenchmarkTimeout="), Timeout);
+
+	bStarted = false;
+	bCapturing = false;
+	bWaitingForCaptureFile = false;
+}
+
+void UShooterTestControllerReplayBenchmark::OnTick(float TimeDelta)
+{
+	if (IsRunningDedicatedServer())
+	{
+		TickRecording();
+	}
+	else
+	{
+		TickPlayback();
+	}
+}
+
+void UShooterTestControllerReplayBenchmark::OnPostMapChange(UWorld* World)
+{
+	// playback loads the replay's map, don't count cycled matches
+	if (bCapturing)
+	{
+		ReceiveTimer.Register(World, World ? World->GetDemoNetDriver() : nullptr, false);
+	}
+}
+
+void UShooterTestControllerReplayBenchmark::TickRecording()
+{
+	const UWorld* World = GetWorld();
+	const AShooterGameState* GameState = World ? World->GetGameState<AShooterGameState>() : nullptr;
+	UShooterGameInstance* GameInstance = GetGameInstance();
+	if (GameState == nullptr || GameInstance == nullptr)
+	{
+		return;
+	}
+
+	if (!bStarted && GameState->GetMatchState() == MatchState::InProgress)
+	{
+		UE_LOG(LogGauntlet, Display, TEXT("Recording replay %s."), *ReplayName);
+		bStarted = true;
+		GameInstance->StartRecordingReplay(ReplayName, ReplayName);
+	}
+	else if (bStarted && GameState->HasMatchEnded())
+	{
+		UE_LOG(LogGauntlet, Display, TEXT("Replay %s recorded."), *ReplayName);
+		GameInstance->StopRecordingReplay();
+		EndTest(0);
+	}
+	else if (!bStarted && GetTimeInCurrentState() > Timeout)
+	{
+		UE_LOG(LogGauntlet, Error, TEXT("Failing replay recording, no match in progress after %.0f secs!"), Timeout);
+		EndTest(-1);
+	}
+}
+
+void UShooterTestControllerReplayBenchmark::TickPlayback()
+{
+	// no login needed to play a local replay, so not the base flow
+	const FName GameInstanceState = GetGameInstanceState();
+	if (GameInstanceState == ShooterGameInstanceState::MessageMenu)
+	{
+		UE_LOG(LogGauntlet, Error, TEXT("Failing due to MessageMenu!"));
+		EndTest(-1);
+		return;
+	}
+
+	if (!bStarted)
+	{
+		if (GameInstanceState == ShooterGameInstanceState::WelcomeScreen || GameInstanceState == ShooterGameInstanceState::MainMenu)
+		{
+			UE_LOG(LogGauntlet, Display, TEXT("Playing back replay %s."), *ReplayName);
+			bStarted = true;
+			GetGameInstance()->PlayDemo(GetFirstLocalPlayer(), ReplayName);
+		}
+		return;
+	}
+
+	if (bWaitingForCaptureFile)
+	{
+		// the capture is written on another thread, keep ticking until it's done
+		if (CaptureFile.IsReady())
+		{
+			bWaitingForCaptureFile = false;
+			WriteResults(CaptureFile.Get());
+		}
+		return;
+	}
+
+	const UWorld* World = GetWorld();
+	UDemoNetDriver* DemoDriver = World ? World->GetDemoNetDriver() : nullptr;
+	const bool bPlaying = DemoDriver && DemoDriver->IsPlaying() && DemoDriver->GetDemoTotalTime() > 0.f;
+
+	if (!bCapturing)
+	{
+		if (bPlaying)
+		{
+			StartCapture();
+		}
+		else if (GetTimeInCurrentState() > Timeout)
+		{
+			UE_LOG(LogGauntlet, Error, TEXT("Failing replay benchmark, %s not playing after %.0f secs!"), *ReplayName, Timeout);
+			EndTest(-1);
+		}
+		return;
+	}
+
+	if (!bPlaying || DemoDriver->GetDemoCurrentTime() >= DemoDriver->GetDemoTotalTime())
+	{
+		FinishCapture();
+		return;
+	}
+
+	SampleFrame();
+}
+
+void UShooterTestControllerReplayBenchmark::StartCapture()
+{
+	UE_LOG(LogGauntlet, Display, TEXT("Starting replay benchmark capture at %.0f fps fixed timestep."), BenchmarkFPS);
+
+	bCapturing = true;
+
+	// same work every run: fixed delta every frame, without waiting for real time to catch up
+	FApp::SetBenchmarking(true);
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / FMath::Max(BenchmarkFPS, 1.f));
+
+	GameThreadMs.Reset();
+	ReplayReceiveMs.Reset();
+	UWorld* World = GetWorld();
+	ReceiveTimer.Register(World, World ? World->GetDemoNetDriver() : nullptr, false);
+
+#if CSV_PROFILER
+	if (!FCsvProfiler::Get()->IsCapturing())
+	{
+		FCsvProfiler::Get()->BeginCapture();
+	}
+#endif
+}
+
+void UShooterTestControllerReplayBenchmark::SampleFrame()
+{
+	const float ReceiveMs = ReceiveTimer.ConsumeSeconds() * 1000.0;
+
+	GameThreadMs.Add(GetGameThreadFrameMs());
+	ReplayReceiveMs.Add(ReceiveMs);
+	CSV_CUSTOM_STAT(ShooterReplayBenchmark, ReplayReceiveMs, ReceiveMs, ECsvCustomStatOp::Set);
+}
+
+void UShooterTestControllerReplayBenchmark::FinishCapture()
+{
+	bCapturing = false;
+	ReceiveTimer.Unregister();
+
+#if CSV_PROFILER
+	if (FCsvProfiler::Get()->IsCapturing())
+	{
+		bWaitingForCaptureFile = true;
+		CaptureFile = FCsvProfiler::Get()->EndCapture();
+		return;
+	}
+#endif
+
+	WriteResults(FString());
+}
+
+void UShooterTestControllerReplayBenchmark::WriteResults(const FString& CaptureFilename)
+{
+	TArray<float> AnimationMs = ReadCsvProfileColumn(CaptureFilename, TEXT("Exclusive/GameThread/Animation"));
+
+	UE_LOG(LogGauntlet, Display, TEXT("Replay benchmark done, %d frames."), GameThreadMs.Num());
+
+	if (GameThreadMs.Num() == 0)
+	{
+		UE_LOG(LogGauntlet, Error, TEXT("Failing replay benchmark, no frames captured!"));
+		EndTest(-1);
+		return;
+	}
+
+	FString Csv = TEXT("Metric,Frames,P50,P95,P99,Max\n");
+	auto AddMetric = [&Csv](const TCHAR* Name, TArray<float>& Samples)
+	{
+		if (Samples.Num() == 0)
+		{
+			UE_LOG(LogGauntlet, Warning, TEXT("%s: no samples"), Name);
+			return;
+		}
+
+		Samples.Sort();
+		const float P50 = GetPercentile(Samples, 0.50f);
+		const float P95 = GetPercentile(Samples, 0.95f);
+		const float P99 = GetPercentile(Samples, 0.99f);
+
+		UE_LOG(LogGauntlet, Display, TEXT("%s: p50 %.2f, p95 %.2f, p99 %.2f, max %.2f"), Name, P50, P95, P99, Samples.Last());
+		Csv += FString::Printf(TEXT("%s,%d,%.3f,%.3f,%.3f,%.3f\n"), Name, Samples.Num(), P50, P95, P99, Samples.Last());
+	};
+
+	AddMetric(TEXT("GameThreadMs"), GameThreadMs);
+	AddMetric(TEXT("ReplayReceiveMs"), ReplayReceiveMs);
+	AddMetric(TEXT("AnimationMs"), AnimationMs);
+
+	const FString Filename = FPaths::ProfilingDir() / TEXT("ShooterReplayBenchmark.csv");
+	if (FFileHelper::SaveStringToFile(Csv, *Filename))
+	{
+		UE_LOG(LogGauntlet, Display, TEXT("Replay benchmark results written to %s"), *Filename);
+	}
+
+	EndTest(0);
+}
+
+TArray<float> UShooterTestControllerReplayBenchmark::ReadCsvProfileColumn(const FString& Filename, const FString& Column)
+{
+	TArray<float> Samples;
+
+	TArray<FString> Lines;
+	if (Filename.IsEmpty() || !FFileHelper::LoadFileToStringArray(Lines, *Filename) || Lines.Num() == 0)
+	{
+		return Samples;
+	}
+
+	TArray<FString> Header;
+	Lines[0].ParseIntoArray(Header, TEXT(","), false);
+	const int32 ColumnIdx = Header.IndexOfByKey(Column);
+	if (ColumnIdx == INDEX_NONE)
+	{
+		return Samples;
+	}
+
+	// frame rows are numbers, the header may be repeated and metadata follows at the end
+	TArray<FString> Values;
+	for (int32 LineIdx = 1; LineIdx < Lines.Num(); LineIdx++)
+	{
+		Lines[LineIdx].ParseIntoArray(Values, TEXT(","), false);
+		if (Values.IsValidIndex(ColumnIdx) && Values[ColumnIdx].IsNumeric())
+		{
+			Samples.Add(FCString::Atof(*Values[ColumnIdx]));
+		}
+	}
+
+	return Samples;
+}
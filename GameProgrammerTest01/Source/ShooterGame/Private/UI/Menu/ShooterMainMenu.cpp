@@ -18,6 +18,7 @@
 #include "ShooterPersistentUser.h"
 #include "Player/ShooterLocalPlayer.h"
 #include "OnlineSubsystemUtils.h"
+#include "ShooterStartupTimer.h"
 
 #define LOCTEXT_NAMESPACE "ShooterGame.HUD.Menu"
 
@@ -83,6 +84,7 @@ void FShooterMainMenu::Construct(TWeakObjectPtr<UShooterGameInstance> _GameInsta
 	bUsedInputToCancelQuickmatchSearch = false;
 	bQuickmatchSearchRequestCanceled = false;
 	bIncQuickMAlpha = false;
+	bAcceptedInput = false;
 	PlayerOwner = _PlayerOwner;
 	MatchType = EMatchType::Custom;
 
@@ -224,8 +226,7 @@ void FShooterMainMenu::Construct(TWeakObjectPtr<UShooterGameInstance> _GameInsta
 			// JOIN menu option
 			MenuHelper::AddMenuItemSP(RootMenuItem, LOCTEXT("FindCustom", "FIND CUSTOM"), this, &FShooterMainMenu::OnJoinServer);
 
-			// Server list widget that will be called up if appropriate
-			MenuHelper::AddCustomMenuItem(JoinServerItem,SAssignNew(ServerListWidget,SShooterServerList).OwnerWidget(MenuWidget).PlayerOwner(GetPlayerOwner()));
+			// Server list widget that will be called up if appropriate, built on first use
 		}
 
 		// QUICK MATCH menu option
@@ -306,8 +307,7 @@ void FShooterMainMenu::Construct(TWeakObjectPtr<UShooterGameInstance> _GameInsta
 #endif
 			JoinMapOption = MenuHelper::AddMenuOption(MenuItem, LOCTEXT("SELECTED_LEVEL", "Map"), JoinMapList);
 
-			// Server list widget that will be called up if appropriate
-			MenuHelper::AddCustomMenuItem(JoinServerItem,SAssignNew(ServerListWidget,SShooterServerList).OwnerWidget(MenuWidget).PlayerOwner(GetPlayerOwner()));
+			// Server list widget that will be called up if appropriate, built on first use
 
 #if CONSOLE_LAN_SUPPORTED
 			JoinLANItem = MenuHelper::AddMenuOptionSP(MenuItem, LOCTEXT("LanMatch", "LAN"), OnOffList, this, &FShooterMainMenu::LanMatchChanged);
@@ -347,25 +347,21 @@ void FShooterMainMenu::Construct(TWeakObjectPtr<UShooterGameInstance> _GameInsta
 		DedicatedItem = MenuHelper::AddMenuOptionSP(MenuItem, LOCTEXT("Dedicated", "Dedicated"), OnOffList, this, &FShooterMainMenu::DedicatedServerChanged);
 		DedicatedItem->SelectedMultiChoice = bIsDedicatedServer;
 
-		// Server list widget that will be called up if appropriate
-		MenuHelper::AddCustomMenuItem(JoinServerItem,SAssignNew(ServerListWidget,SShooterServerList).OwnerWidget(MenuWidget).PlayerOwner(GetPlayerOwner()));
+		// Server list widget that will be called up if appropriate, built on first use
 #endif
 
 		// Leaderboards
 		MenuHelper::AddMenuItemSP(RootMenuItem, LOCTEXT("Leaderboards", "LEADERBOARDS"), this, &FShooterMainMenu::OnShowLeaderboard);
-		MenuHelper::AddCustomMenuItem(LeaderboardItem,SAssignNew(LeaderboardWidget,SShooterLeaderboard).OwnerWidget(MenuWidget).PlayerOwner(GetPlayerOwner()));
 
 #if ONLINE_STORE_ENABLED
 		// Purchases
 		MenuHelper::AddMenuItemSP(RootMenuItem, LOCTEXT("Store", "ONLINE STORE"), this, &FShooterMainMenu::OnShowOnlineStore);
-		MenuHelper::AddCustomMenuItem(OnlineStoreItem, SAssignNew(OnlineStoreWidget, SShooterOnlineStore).OwnerWidget(MenuWidget).PlayerOwner(GetPlayerOwner()));
 #endif //ONLINE_STORE_ENABLED
 #if !SHOOTER_CONSOLE_UI
 
 		// Demos
 		{
 			MenuHelper::AddMenuItemSP(RootMenuItem, LOCTEXT("Demos", "DEMOS"), this, &FShooterMainMenu::OnShowDemoBrowser);
-			MenuHelper::AddCustomMenuItem(DemoBrowserItem,SAssignNew(DemoListWidget,SShooterDemoList).OwnerWidget(MenuWidget).PlayerOwner(GetPlayerOwner()));
 		}
 #endif
 
@@ -387,6 +383,7 @@ void FShooterMainMenu::Construct(TWeakObjectPtr<UShooterGameInstance> _GameInsta
 		MenuWidget->OnGoBack.BindSP(this, &FShooterMainMenu::OnMenuGoBack);
 		MenuWidget->MainMenu = MenuWidget->CurrentMenu = RootMenuItem->SubMenu;
 		MenuWidget->OnMenuHidden.BindSP(this, &FShooterMainMenu::OnMenuHidden);
+		MenuWidget->OnMenuShown.BindSP(this, &FShooterMainMenu::OnMenuShown);
 
 		ShooterOptions->UpdateOptions();
 		MenuWidget->BuildAndShowMenu();
@@ -442,6 +439,26 @@ void FShooterMainMenu::Tick(float DeltaSeconds)
 		QuickMatchStoppingWidget->SetColorAndOpacity(QuickMColor);
 	}
 
+	// load the map about to be hosted while the player is still choosing
+	if (GameInstance.IsValid() && MenuWidget.IsValid() && IsMapReady())
+	{
+		if (bAnimateQuickmatchSearchingUI)
+		{
+			FString QuickMatchMap;
+			UShooterGameInstance::GetQuickMatchUrl().Split(TEXT("?"), &QuickMatchMap, nullptr);
+			GameInstance->PreloadMap(QuickMatchMap);
+		}
+		else if (IsHostMenuHighlighted())
+		{
+			GameInstance->PreloadMap(FString::Printf(TEXT("/Game/Maps/%s"), *GetMapName()));
+		}
+		else
+		{
+			// not about to host anymore, let the next GC free it
+			GameInstance->ReleasePreloadedMap();
+		}
+	}
+
 	IPlatformChunkInstall* ChunkInstaller = FPlatformMisc::GetPlatformChunkInstall();
 	if (ChunkInstaller)
 	{
@@ -485,6 +502,17 @@ TStatId FShooterMainMenu::GetStatId() const
 	RETURN_QUICK_DECLARE_CYCLE_STAT(FShooterMainMenu, STATGROUP_Tickables);
 }
 
+void FShooterMainMenu::OnMenuShown()
+{
+	// the menu has keyboard focus from here on
+	if (!bAcceptedInput && GameInstance.IsValid())
+	{
+		bAcceptedInput = true;
+		UE_LOG(LogShooter, Log, TEXT("Main menu accepting input %.1f ms after BeginMainMenuState"), (FPlatformTime::Seconds() - GameInstance->GetMainMenuStateStartTime()) * 1000.0);
+		FShooterStartupTimer::Playable(TEXT("menu input"));
+	}
+}
+
 void FShooterMainMenu::OnMenuHidden()
 {	
 #if SHOOTER_CONSOLE_UI
@@ -825,11 +853,13 @@ FReply FShooterMainMenu::OnSplitScreenPlay()
 				}
 
 
+				EnsureServerListWidget();
 				MenuWidget->NextMenu = JoinServerItem->SubMenu;
 				ServerListWidget->BeginServerSearch(bIsLanMatch, bIsDedicatedServer, SelectedMapFilterName);
 				ServerListWidget->UpdateServerList();
 				MenuWidget->EnterSubMenu();
 #else
+				EnsureServerListWidget();
 				SplitScreenLobbyWidget->NextMenu = JoinServerItem->SubMenu;
 				ServerListWidget->BeginServerSearch(bIsLanMatch, bIsDedicatedServer, SelectedMapFilterName);
 				ServerListWidget->UpdateServerList();
@@ -1038,6 +1068,20 @@ FShooterMainMenu::EMap FShooterMainMenu::GetSelectedMap() const
 	return EMap::ESancturary;	// Need to return something (we can hit this path in cooking)
 }
 
+bool FShooterMainMenu::IsHostMenuHighlighted() const
+{
+	// the host menu is either open, or previewed while its item is selected
+	for (const TSharedPtr<FShooterMenuItem>& MapOption : { HostOnlineMapOption, HostOfflineMapOption })
+	{
+		if (MapOption.IsValid() && (MenuWidget->CurrentMenu.Contains(MapOption) || MenuWidget->NextMenu.Contains(MapOption)))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void FShooterMainMenu::CloseSubMenu()
 {
 	MenuWidget->MenuGoBack(true);
@@ -1323,6 +1367,7 @@ void FShooterMainMenu::OnUserCanPlayOnlineJoin(const FUniqueNetId& UserId, EUser
 		AddMenuToGameViewport();
 		FSlateApplication::Get().SetKeyboardFocus(MenuWidget);
 
+		EnsureServerListWidget();
 		MenuWidget->NextMenu = JoinServerItem->SubMenu;
 		ServerListWidget->BeginServerSearch(bIsLanMatch, bIsDedicatedServer, SelectedMapFilterName);
 		ServerListWidget->UpdateServerList();
@@ -1338,6 +1383,7 @@ void FShooterMainMenu::OnUserCanPlayOnlineJoin(const FUniqueNetId& UserId, EUser
 		SplitScreenLobbyWidget->SetIsJoining( true );
 #endif
 #else
+		EnsureServerListWidget();
 		MenuWidget->NextMenu = JoinServerItem->SubMenu;
 		//FString SelectedMapFilterName = JoinMapOption->MultiChoice[JoinMapOption->SelectedMultiChoice].ToString();
 
@@ -1354,6 +1400,7 @@ void FShooterMainMenu::OnUserCanPlayOnlineJoin(const FUniqueNetId& UserId, EUser
 
 void FShooterMainMenu::OnShowLeaderboard()
 {
+	EnsureLeaderboardWidget();
 	MenuWidget->NextMenu = LeaderboardItem->SubMenu;
 #if LOGIN_REQUIRED_FOR_ONLINE_PLAY
 	LeaderboardWidget->ReadStatsLoginRequired();
@@ -1365,6 +1412,7 @@ void FShooterMainMenu::OnShowLeaderboard()
 
 void FShooterMainMenu::OnShowOnlineStore()
 {
+	EnsureOnlineStoreWidget();
 	MenuWidget->NextMenu = OnlineStoreItem->SubMenu;
 #if LOGIN_REQUIRED_FOR_ONLINE_PLAY
 	UE_LOG(LogOnline, Warning, TEXT("You need to be logged in before using the store"));
@@ -1375,11 +1423,44 @@ void FShooterMainMenu::OnShowOnlineStore()
 
 void FShooterMainMenu::OnShowDemoBrowser()
 {
+	EnsureDemoListWidget();
 	MenuWidget->NextMenu = DemoBrowserItem->SubMenu;
 	DemoListWidget->BuildDemoList();
 	MenuWidget->EnterSubMenu();
 }
 
+void FShooterMainMenu::EnsureServerListWidget()
+{
+	if (!ServerListWidget.IsValid())
+	{
+		MenuHelper::AddCustomMenuItem(JoinServerItem,SAssignNew(ServerListWidget,SShooterServerList).OwnerWidget(MenuWidget).PlayerOwner(GetPlayerOwner()));
+	}
+}
+
+void FShooterMainMenu::EnsureLeaderboardWidget()
+{
+	if (!LeaderboardWidget.IsValid())
+	{
+		MenuHelper::AddCustomMenuItem(LeaderboardItem,SAssignNew(LeaderboardWidget,SShooterLeaderboard).OwnerWidget(MenuWidget).PlayerOwner(GetPlayerOwner()));
+	}
+}
+
+void FShooterMainMenu::EnsureOnlineStoreWidget()
+{
+	if (!OnlineStoreWidget.IsValid())
+	{
+		MenuHelper::AddCustomMenuItem(OnlineStoreItem, SAssignNew(OnlineStoreWidget, SShooterOnlineStore).OwnerWidget(MenuWidget).PlayerOwner(GetPlayerOwner()));
+	}
+}
+
+void FShooterMainMenu::EnsureDemoListWidget()
+{
+	if (!DemoListWidget.IsValid())
+	{
+		MenuHelper::AddCustomMenuItem(DemoBrowserItem,SAssignNew(DemoListWidget,SShooterDemoList).OwnerWidget(MenuWidget).PlayerOwner(GetPlayerOwner()));
+	}
+}
+
 void FShooterMainMenu::OnUIQuit()
 {
 	bIsQuitting = true;
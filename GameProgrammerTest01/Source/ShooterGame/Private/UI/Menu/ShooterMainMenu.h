@@ -132,6 +132,9 @@ protected:
 
 	EMap GetSelectedMap() const;
 
+	/** Is a host menu, with its map option, open or previewed? */
+	bool IsHostMenuHighlighted() const;
+
 	/** goes back in menu structure */
 	void CloseSubMenu();
 
@@ -141,6 +144,15 @@ protected:
 	/** called when menu hide animation is finished */
 	void OnMenuHidden();
 
+	/** called when menu show animation starts and the menu takes keyboard focus */
+	void OnMenuShown();
+
+	/** sub-pages are built the first time they are shown */
+	void EnsureServerListWidget();
+	void EnsureLeaderboardWidget();
+	void EnsureOnlineStoreWidget();
+	void EnsureDemoListWidget();
+
 	/** called when user chooses to start matchmaking. */
 	void OnQuickMatchSelected();
 
@@ -326,6 +338,9 @@ protected:
 	/** Quitting */
 	bool bIsQuitting;
 
+	/** Has the menu taken input since it was constructed? */
+	bool bAcceptedInput;
+
 	/** used for displaying the quickmatch confirmation dialog when a quickmatch to join is not found */
 	TSharedPtr<class SShooterConfirmationDialog> QuickMatchFailureWidget;
 
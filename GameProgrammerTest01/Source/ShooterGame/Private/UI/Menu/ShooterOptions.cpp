@@ -400,7 +400,7 @@ void FShooterOptions::FreezeTimerOptionChanged(TSharedPtr<FShooterMenuItem> Menu
 	AShooterGameState* const GameState = World ? World->GetGameState<AShooterGameState>() : nullptr;
 	if (GameState)
 	{
-		GameState->bTimerPaused = MultiOptionIndex > 0  ? true : false;
+		GameState->SetTimerPaused(MultiOptionIndex > 0  ? true : false);
 	}
 }
 
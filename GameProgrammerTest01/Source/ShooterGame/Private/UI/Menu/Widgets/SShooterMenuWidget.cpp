@@ -813,6 +813,8 @@ void SShooterMenuWidget::FadeIn()
 
 	//Go into UI mode
 	FSlateApplication::Get().SetKeyboardFocus(SharedThis(this));
+
+	OnMenuShown.ExecuteIfBound();
 }
 
 FReply SShooterMenuWidget::OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
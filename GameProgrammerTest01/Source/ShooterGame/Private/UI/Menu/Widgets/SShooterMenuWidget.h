@@ -28,6 +28,9 @@ public:
 	/** delegate declaration */
 	DECLARE_DELEGATE(FOnMenuHidden);
 
+	/** delegate declaration */
+	DECLARE_DELEGATE(FOnMenuShown);
+
 	/** external delegate to call when in-game menu should be hidden using controller buttons - 
 	it's workaround as when joystick is captured, even when sending FReply::Unhandled, binding does not recieve input :( */
 	DECLARE_DELEGATE(FOnToggleMenu);
@@ -124,6 +127,9 @@ public:
 	/** delegate, which is executed when menu is finished hiding */
 	FOnMenuHidden OnMenuHidden;
 
+	/** delegate, which is executed when menu starts showing and takes keyboard focus */
+	FOnMenuShown OnMenuShown;
+
 	/** bind if menu should be hidden from outside by controller button */
 	FOnToggleMenu OnToggleMenu;
 
@@ -0,0 +1,259 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Weapons/ShooterExplosionResolver.h"
+#include "Player/ShooterPawnSpatialIndex.h"
+#include "GameFramework/DamageType.h"
+
+namespace ShooterExplosionResolver
+{
+	/** How far a pawn may have moved between the pawn index rebuild and the end of the frame */
+	static const float PawnMovementPadding = 500.f;
+}
+
+static int32 ShooterBatchExplosionDamage = 1;
+FAutoConsoleVariableRef CVarShooterBatchExplosionDamage(
+	TEXT("ShooterGame.BatchExplosionDamage"),
+	ShooterBatchExplosionDamage,
+	TEXT("Resolve radial damage of all explosions in a frame as one batch with async occlusion traces.\n")
+	TEXT("0: Disable (ApplyRadialDamage per explosion), 1: Enable"),
+	ECVF_Default);
+
+void UShooterExplosionResolver::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	NextBatchId = 0;
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UShooterExplosionResolver::OnWorldPostActorTick);
+}
+
+void UShooterExplosionResolver::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	QueuedExplosions.Empty();
+	PendingBatches.Empty();
+
+	Super::Deinitialize();
+}
+
+UShooterExplosionResolver* UShooterExplosionResolver::Get(const UWorld* World)
+{
+	return (World && ShooterBatchExplosionDamage) ? World->GetSubsystem<UShooterExplosionResolver>() : nullptr;
+}
+
+void UShooterExplosionResolver::QueueRadialDamage(float BaseDamage, const FVector& Origin, float Radius, TSubclassOf<UDamageType> DamageTypeClass, AActor* DamageCauser, AController* InstigatedBy)
+{
+	FPendingExplosion& Explosion = QueuedExplosions.AddDefaulted_GetRef();
+	Explosion.Origin = Origin;
+	Explosion.BaseDamage = BaseDamage;
+	Explosion.Radius = Radius;
+	Explosion.DamageTypeClass = DamageTypeClass ? DamageTypeClass : TSubclassOf<UDamageType>(UDamageType::StaticClass());
+	Explosion.DamageCauser = DamageCauser;
+	Explosion.InstigatedBy = InstigatedBy;
+}
+
+void UShooterExplosionResolver::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || QueuedExplosions.Num() == 0)
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_ShooterExplosionResolver_IssueBatch);
+
+	const uint32 BatchId = NextBatchId++;
+	FExplosionBatch& Batch = PendingBatches.Add(BatchId);
+	Batch.Explosions = MoveTemp(QueuedExplosions);
+	Batch.NumPendingTraces = 0;
+
+	// Candidate victims come from the pawn index, bounds are computed once per pawn for all explosions of this frame
+	struct FVictimCandidate
+	{
+		APawn* Pawn;
+		FVector Center;
+		float BoundsRadius;
+	};
+	TMap<APawn*, FVictimCandidate> Candidates;
+	TArray<APawn*> NearbyPawns;
+	const UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(World);
+	check(PawnIndex);
+
+	// Indexed locations are from the start of the frame, pad by how far pawns reach from them and may have moved since
+	const float QueryPadding = PawnIndex->GetMaxPawnRadius() + PawnIndex->GetMaxPawnHalfHeight() + ShooterExplosionResolver::PawnMovementPadding;
+
+	// Same object types ApplyRadialDamage overlaps against
+	const FCollisionObjectQueryParams DynamicObjectParams(FCollisionObjectQueryParams::InitType::AllDynamicObjects);
+	TArray<FOverlapResult> Overlaps;
+
+	for (int32 ExplosionIdx = 0; ExplosionIdx < Batch.Explosions.Num(); ExplosionIdx++)
+	{
+		const FPendingExplosion& Explosion = Batch.Explosions[ExplosionIdx];
+		const FCollisionShape ExplosionShape = FCollisionShape::MakeSphere(Explosion.Radius);
+
+		PawnIndex->FindPawnsInRadius(Explosion.Origin, Explosion.Radius + QueryPadding, FShooterPawnQueryFilter(), NearbyPawns);
+
+		for (APawn* NearbyPawn : NearbyPawns)
+		{
+			if (!NearbyPawn->CanBeDamaged())
+			{
+				continue;
+			}
+
+			FVictimCandidate* FoundCandidate = Candidates.Find(NearbyPawn);
+			if (FoundCandidate == nullptr)
+			{
+				FVector BoundsExtent;
+				FoundCandidate = &Candidates.Add(NearbyPawn);
+				FoundCandidate->Pawn = NearbyPawn;
+				NearbyPawn->GetActorBounds(false, FoundCandidate->Center, BoundsExtent);
+				FoundCandidate->BoundsRadius = BoundsExtent.Size();
+			}
+
+			const FVictimCandidate& Candidate = *FoundCandidate;
+			if (Candidate.Pawn == Explosion.DamageCauser.Get()
+				|| FVector::DistSquared(Candidate.Center, Explosion.Origin) > FMath::Square(Explosion.Radius + Candidate.BoundsRadius))
+			{
+				continue;
+			}
+
+			TInlineComponentArray<UPrimitiveComponent*> Components(Candidate.Pawn);
+			for (UPrimitiveComponent* Component : Components)
+			{
+				if (!Component->IsQueryCollisionEnabled()
+					|| !(DynamicObjectParams.GetQueryBitfield() & ECC_TO_BITFIELD(Component->GetCollisionObjectType()))
+					|| !Component->OverlapComponent(Explosion.Origin, FQuat::Identity, ExplosionShape))
+				{
+					continue;
+				}
+
+				FOcclusionTest& Test = Batch.Tests.AddDefaulted_GetRef();
+				Test.ExplosionIndex = ExplosionIdx;
+				Test.Victim = Candidate.Pawn;
+				Test.Component = Component;
+				Test.bVisible = false;
+			}
+		}
+
+		// Other victims (props, physics bodies, which TakeDamage pushes) come from the overlap ApplyRadialDamage does, pawns were handled above
+		Overlaps.Reset();
+		const FCollisionQueryParams OverlapParams(SCENE_QUERY_STAT(ShooterExplosionOverlap), false, Explosion.DamageCauser.Get());
+		World->OverlapMultiByObjectType(Overlaps, Explosion.Origin, FQuat::Identity, DynamicObjectParams, ExplosionShape, OverlapParams);
+
+		for (const FOverlapResult& Overlap : Overlaps)
+		{
+			AActor* OverlapActor = Overlap.GetActor();
+			UPrimitiveComponent* Component = Overlap.GetComponent();
+			if (OverlapActor == nullptr || Component == nullptr || OverlapActor->IsA<APawn>() || !OverlapActor->CanBeDamaged())
+			{
+				continue;
+			}
+
+			FOcclusionTest& Test = Batch.Tests.AddDefaulted_GetRef();
+			Test.ExplosionIndex = ExplosionIdx;
+			Test.Victim = OverlapActor;
+			Test.Component = Component;
+			Test.bVisible = false;
+		}
+	}
+
+	if (Batch.Tests.Num() == 0)
+	{
+		PendingBatches.Remove(BatchId);
+		return;
+	}
+
+	// Issue all occlusion traces in one async batch, mirroring ComponentIsDamageableFrom
+	FTraceDelegate TraceDelegate = FTraceDelegate::CreateUObject(this, &UShooterExplosionResolver::OnOcclusionTraceDone, BatchId);
+	for (int32 TestIdx = 0; TestIdx < Batch.Tests.Num(); TestIdx++)
+	{
+		const FOcclusionTest& Test = Batch.Tests[TestIdx];
+		const FPendingExplosion& Explosion = Batch.Explosions[Test.ExplosionIndex];
+
+		const FVector TraceEnd = Test.Component->Bounds.Origin;
+		FVector TraceStart = Explosion.Origin;
+		if (TraceStart == TraceEnd)
+		{
+			// tiny nudge so the trace doesn't early out with no hits
+			TraceStart.Z += 0.01f;
+		}
+
+		const FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(ShooterExplosionOcclusion), true, Explosion.DamageCauser.Get());
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, TraceStart, TraceEnd, ECC_Visibility, TraceParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, TestIdx);
+		Batch.NumPendingTraces++;
+	}
+}
+
+void UShooterExplosionResolver::OnOcclusionTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum, uint32 BatchId)
+{
+	FExplosionBatch* Batch = PendingBatches.Find(BatchId);
+	if (Batch == nullptr || !Batch->Tests.IsValidIndex(Datum.UserData))
+	{
+		return;
+	}
+
+	FOcclusionTest& Test = Batch->Tests[Datum.UserData];
+	UPrimitiveComponent* Component = Test.Component.Get();
+	if (Component)
+	{
+		if (Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit)
+		{
+			// visible only if the blocking hit was the victim component itself
+			Test.bVisible = Datum.OutHits[0].Component == Component;
+			Test.Hit = Datum.OutHits[0];
+		}
+		else
+		{
+			// nothing blocking, model the damage as having hit the component's center
+			const FPendingExplosion& Explosion = Batch->Explosions[Test.ExplosionIndex];
+			const FVector FakeHitLoc = Component->GetComponentLocation();
+			const FVector FakeHitNorm = (Explosion.Origin - FakeHitLoc).GetSafeNormal();
+			Test.bVisible = true;
+			Test.Hit = FHitResult(Component->GetOwner(), Component, FakeHitLoc, FakeHitNorm);
+		}
+	}
+
+	if (--Batch->NumPendingTraces <= 0)
+	{
+		ApplyBatchDamage(*Batch);
+		PendingBatches.Remove(BatchId);
+	}
+}
+
+void UShooterExplosionResolver::ApplyBatchDamage(FExplosionBatch& Batch)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_ShooterExplosionResolver_ApplyDamage);
+
+	// Tests are grouped by explosion, collate visible component hits per victim like ApplyRadialDamage does
+	int32 TestIdx = 0;
+	while (TestIdx < Batch.Tests.Num())
+	{
+		const int32 ExplosionIdx = Batch.Tests[TestIdx].ExplosionIndex;
+		const FPendingExplosion& Explosion = Batch.Explosions[ExplosionIdx];
+
+		TMap<AActor*, TArray<FHitResult> > VictimHits;
+		for (; TestIdx < Batch.Tests.Num() && Batch.Tests[TestIdx].ExplosionIndex == ExplosionIdx; TestIdx++)
+		{
+			const FOcclusionTest& Test = Batch.Tests[TestIdx];
+			AActor* Victim = Test.Victim.Get();
+			if (Victim && Test.bVisible && Test.Component.IsValid())
+			{
+				VictimHits.FindOrAdd(Victim).Add(Test.Hit);
+			}
+		}
+
+		FRadialDamageEvent DamageEvent;
+		DamageEvent.DamageTypeClass = Explosion.DamageTypeClass;
+		DamageEvent.Origin = Explosion.Origin;
+		DamageEvent.Params = FRadialDamageParams(Explosion.BaseDamage, 0.0f, 0.0f, Explosion.Radius, 1.0f);
+
+		for (TPair<AActor*, TArray<FHitResult> >& VictimIt : VictimHits)
+		{
+			AActor* Victim = VictimIt.Key;
+			if (!Victim->IsPendingKill() && Victim->CanBeDamaged())
+			{
+				DamageEvent.ComponentHits = MoveTemp(VictimIt.Value);
+				Victim->TakeDamage(Explosion.BaseDamage, DamageEvent, Explosion.InstigatedBy.Get(), Explosion.DamageCauser.Get());
+			}
+		}
+	}
+}
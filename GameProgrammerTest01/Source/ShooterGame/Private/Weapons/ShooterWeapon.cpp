@@ -78,6 +78,7 @@ void AShooterWeapon::Destroyed()
 
 void AShooterWeapon::OnEquip(const AShooterWeapon* LastWeapon)
 {
+	SetNetDormancy(DORM_Awake);
 	AttachMeshToPawn();
 
 	bPendingEquip = true;
@@ -144,6 +145,7 @@ void AShooterWeapon::OnUnEquip()
 	{
 		StopWeaponAnimation(ReloadAnim);
 		bPendingReload = false;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, bPendingReload, this);
 
 		GetWorldTimerManager().ClearTimer(TimerHandle_StopReload);
 		GetWorldTimerManager().ClearTimer(TimerHandle_ReloadWeapon);
@@ -160,11 +162,19 @@ void AShooterWeapon::OnUnEquip()
 	AShooterCharacter::NotifyUnEquipWeapon.Broadcast(MyPawn, this);
 
 	DetermineWeaponState();
+
+	// nothing changes on a holstered weapon until it's equipped again or given ammo
+	SetNetDormancy(DORM_DormantAll);
 }
 
 void AShooterWeapon::OnEnterInventory(AShooterCharacter* NewOwner)
 {
 	SetOwningPawn(NewOwner);
+
+	if (!IsAttachedToPawn())
+	{
+		SetNetDormancy(DORM_DormantAll);
+	}
 }
 
 void AShooterWeapon::OnLeaveInventory()
@@ -176,6 +186,7 @@ void AShooterWeapon::OnLeaveInventory()
 
 	if (GetLocalRole() == ROLE_Authority)
 	{
+		SetNetDormancy(DORM_Awake);
 		SetOwningPawn(NULL);
 	}
 }
@@ -259,6 +270,7 @@ void AShooterWeapon::StartReload(bool bFromReplication)
 	if (bFromReplication || CanReload())
 	{
 		bPendingReload = true;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, bPendingReload, this);
 		DetermineWeaponState();
 
 		float AnimDuration = PlayWeaponAnimation(ReloadAnim);		
@@ -285,6 +297,7 @@ void AShooterWeapon::StopReload()
 	if (CurrentState == EWeaponState::Reloading)
 	{
 		bPendingReload = false;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, bPendingReload, this);
 		DetermineWeaponState();
 		StopWeaponAnimation(ReloadAnim);
 	}
@@ -361,7 +374,9 @@ void AShooterWeapon::GiveAmmo(int AddAmount)
 {
 	const int32 MissingAmmo = FMath::Max(0, WeaponConfig.MaxAmmo - CurrentAmmo);
 	AddAmount = FMath::Min(AddAmount, MissingAmmo);
+	FlushNetDormancy();
 	CurrentAmmo += AddAmount;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, CurrentAmmo, this);
 
 	AShooterAIController* BotAI = MyPawn ? Cast<AShooterAIController>(MyPawn->GetController()) : NULL;
 	if (BotAI)
@@ -383,11 +398,13 @@ void AShooterWeapon::UseAmmo()
 	if (!HasInfiniteAmmo())
 	{
 		CurrentAmmoInClip--;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, CurrentAmmoInClip, this);
 	}
 
 	if (!HasInfiniteAmmo() && !HasInfiniteClip())
 	{
 		CurrentAmmo--;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, CurrentAmmo, this);
 	}
 
 	AShooterAIController* BotAI = MyPawn ? Cast<AShooterAIController>(MyPawn->GetController()) : NULL;	
@@ -446,6 +463,7 @@ void AShooterWeapon::HandleFiring()
 			
 			// update firing FX on remote clients if function was called on server
 			BurstCounter++;
+			MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, BurstCounter, this);
 		}
 	}
 	else if (CanReload())
@@ -520,6 +538,7 @@ void AShooterWeapon::ServerHandleFiring_Implementation()
 
 		// update firing FX on remote clients
 		BurstCounter++;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, BurstCounter, this);
 	}
 }
 
@@ -535,11 +554,13 @@ void AShooterWeapon::ReloadWeapon()
 	if (ClipDelta > 0)
 	{
 		CurrentAmmoInClip += ClipDelta;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, CurrentAmmoInClip, this);
 	}
 
 	if (HasInfiniteClip())
 	{
 		CurrentAmmo = FMath::Max(CurrentAmmoInClip, CurrentAmmo);
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, CurrentAmmo, this);
 	}
 }
 
@@ -609,6 +630,7 @@ void AShooterWeapon::OnBurstFinished()
 {
 	// stop firing FX on remote clients
 	BurstCounter = 0;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, BurstCounter, this);
 
 	// stop firing FX locally, unless it's a dedicated server
 	//if (GetNetMode() != NM_DedicatedServer)
@@ -768,6 +790,7 @@ void AShooterWeapon::SetOwningPawn(AShooterCharacter* NewOwner)
 	{
 		SetInstigator(NewOwner);
 		MyPawn = NewOwner;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, MyPawn, this);
 		// net owner for RPC calls
 		SetOwner(NewOwner);
 	}	
@@ -917,13 +940,18 @@ void AShooterWeapon::GetLifetimeReplicatedProps( TArray< FLifetimeProperty > & O
 {
 	Super::GetLifetimeReplicatedProps( OutLifetimeProps );
 
-	DOREPLIFETIME( AShooterWeapon, MyPawn );
+	FDoRepLifetimeParams SharedParams;
+	SharedParams.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST( AShooterWeapon, MyPawn, SharedParams );
 
-	DOREPLIFETIME_CONDITION( AShooterWeapon, CurrentAmmo,		COND_OwnerOnly );
-	DOREPLIFETIME_CONDITION( AShooterWeapon, CurrentAmmoInClip, COND_OwnerOnly );
+	SharedParams.Condition = COND_OwnerOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST( AShooterWeapon, CurrentAmmo,		SharedParams );
+	DOREPLIFETIME_WITH_PARAMS_FAST( AShooterWeapon, CurrentAmmoInClip,	SharedParams );
 
-	DOREPLIFETIME_CONDITION( AShooterWeapon, BurstCounter,		COND_SkipOwner );
-	DOREPLIFETIME_CONDITION( AShooterWeapon, bPendingReload,	COND_SkipOwner );
+	SharedParams.Condition = COND_SkipOwner;
+	DOREPLIFETIME_WITH_PARAMS_FAST( AShooterWeapon, BurstCounter,		SharedParams );
+	DOREPLIFETIME_WITH_PARAMS_FAST( AShooterWeapon, bPendingReload,		SharedParams );
 }
 
 USkeletalMeshComponent* AShooterWeapon::GetWeaponMesh() const
@@ -4,6 +4,7 @@
 #include "Weapons/ShooterWeapon_Instant.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Effects/ShooterImpactEffect.h"
+#include "ShooterDeterministicMode.h"
 
 AShooterWeapon_Instant::AShooterWeapon_Instant(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -15,7 +16,7 @@ AShooterWeapon_Instant::AShooterWeapon_Instant(const FObjectInitializer& ObjectI
 
 void AShooterWeapon_Instant::FireWeapon()
 {
-	const int32 RandomSeed = FMath::Rand();
+	const int32 RandomSeed = FShooterDeterministicMode::Rand();
 	FRandomStream WeaponRandomStream(RandomSeed);
 	const float CurrentSpread = GetCurrentSpread();
 	const float ConeHalfAngle = FMath::DegreesToRadians(CurrentSpread * 0.5f);
@@ -120,6 +121,7 @@ void AShooterWeapon_Instant::ServerNotifyMiss_Implementation(FVector_NetQuantize
 	HitNotify.Origin = Origin;
 	HitNotify.RandomSeed = RandomSeed;
 	HitNotify.ReticleSpread = ReticleSpread;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon_Instant, HitNotify, this);
 
 	// play FX locally
 	if (GetNetMode() != NM_DedicatedServer)
@@ -172,6 +174,7 @@ void AShooterWeapon_Instant::ProcessInstantHit_Confirmed(const FHitResult& Impac
 		HitNotify.Origin = Origin;
 		HitNotify.RandomSeed = RandomSeed;
 		HitNotify.ReticleSpread = ReticleSpread;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon_Instant, HitNotify, this);
 	}
 
 	// play FX locally
@@ -308,5 +311,9 @@ void AShooterWeapon_Instant::GetLifetimeReplicatedProps( TArray< FLifetimeProper
 {
 	Super::GetLifetimeReplicatedProps( OutLifetimeProps );
 
-	DOREPLIFETIME_CONDITION( AShooterWeapon_Instant, HitNotify, COND_SkipOwner );
+	FDoRepLifetimeParams SharedParams;
+	SharedParams.bIsPushBased = true;
+	SharedParams.Condition = COND_SkipOwner;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST( AShooterWeapon_Instant, HitNotify, SharedParams );
 }
\ No newline at end of file
@@ -2,13 +2,24 @@
 
 #pragma once
 #include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
+#include "NavigationSystemTypes.h"
 #include "BTTask_FindPickup.generated.h"
 
-// Bot AI Task that attempts to locate a pickup 
+// Bot AI Task that attempts to locate a reachable pickup, the path query waits for UShooterBotNavQueries and runs async
 UCLASS()
 class UBTTask_FindPickup : public UBTTask_BlackboardBase
 {
 	GENERATED_UCLASS_BODY()
-		
+
 	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual uint16 GetInstanceMemorySize() const override;
+
+protected:
+
+	/** queued query: starts the async path query to the pickup */
+	void RequestPath(TWeakObjectPtr<UBehaviorTreeComponent> WeakOwnerComp, uint32 QueryId);
+
+	/** path query finished: goes for the pickup if it can be reached */
+	void OnPathFound(uint32 PathQueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path, TWeakObjectPtr<UBehaviorTreeComponent> WeakOwnerComp, uint32 QueryId);
 };
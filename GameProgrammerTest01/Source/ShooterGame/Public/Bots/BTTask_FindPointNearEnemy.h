@@ -5,11 +5,18 @@
 #include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
 #include "BTTask_FindPointNearEnemy.generated.h"
 
-// Bot AI task that tries to find a location near the current enemy
+// Bot AI task that tries to find a location near the current enemy, the navmesh query waits for UShooterBotNavQueries
 UCLASS()
 class UBTTask_FindPointNearEnemy : public UBTTask_BlackboardBase
 {
 	GENERATED_UCLASS_BODY()
 
 	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual uint16 GetInstanceMemorySize() const override;
+
+protected:
+
+	/** finds the location and sets the blackboard key, true if found */
+	bool FindPointNearEnemy(UBehaviorTreeComponent& OwnerComp) const;
 };
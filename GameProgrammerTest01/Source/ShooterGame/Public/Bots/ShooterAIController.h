@@ -52,6 +52,9 @@ public:
 		
 	bool HasWeaponLOSToEnemy(AActor* InEnemyActor, const bool bAnyEnemy) const;
 
+	/** Applies what UShooterBotBrain decided for this bot: enemy, whether it is in sight, firing and ammo need */
+	void ApplyBrainDecision(AShooterCharacter* InEnemy, bool bInEnemyVisible, bool bFire, bool bNeedAmmo);
+
 	// Begin AAIController interface
 	/** Update direction AI is looking based on FocalPoint */
 	virtual void UpdateControlRotation(float DeltaTime, bool bUpdatePawn = true) override;
@@ -64,6 +67,9 @@ protected:
 	int32 EnemyKeyID;
 	int32 NeedAmmoKeyID;
 
+	/** Whether the enemy UShooterBotBrain picked was in sight when it did */
+	bool bBrainEnemyVisible;
+
 	/** Handle for efficient management of Respawn timer */
 	FTimerHandle TimerHandle_Respawn;
 
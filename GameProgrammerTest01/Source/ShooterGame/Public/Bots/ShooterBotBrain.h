@@ -0,0 +1,97 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ShooterServerWorldSubsystem.h"
+#include "ShooterBotBrain.generated.h"
+
+class AShooterAIController;
+class AShooterCharacter;
+
+DECLARE_STATS_GROUP(TEXT("ShooterBots"), STATGROUP_ShooterBots, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Batched brain think"), STAT_ShooterBots_BrainThink, STATGROUP_ShooterBots, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Behavior tree decisions"), STAT_ShooterBots_TreeDecisions, STATGROUP_ShooterBots, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bots thinking"), STAT_ShooterBots_NumThinking, STATGROUP_ShooterBots, );
+
+/**
+ * Optional batched decision pass for all bots, enabled with ShooterGame.BatchedBotBrain.
+ *
+ * Every ShooterGame.BotBrainInterval seconds it gathers each bot's state into flat arrays: eye location, aim, current
+ * enemy, weapon readiness and ammo, plus its nearest enemies (UShooterPawnSpatialIndex) with line of sight
+ * (UShooterBotPerception). Target selection, aim and fire decisions then run for all bots in one ParallelFor over
+ * that data, and the results are written back through AShooterAIController::ApplyBrainDecision.
+ *
+ * The behavior tree keeps running for movement and pickups; while the brain is enabled FindClosestEnemy,
+ * FindClosestEnemyWithLOS and ShootEnemy defer to its results.
+ */
+UCLASS()
+class UShooterBotBrain : public UShooterServerWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** returns the brain of given world, if batched decisions are enabled */
+	static UShooterBotBrain* Get(const UWorld* World);
+
+private:
+
+	/** enemy a bot could pick */
+	struct FCandidate
+	{
+		AShooterCharacter* Pawn;
+		FVector Location;
+		bool bVisible;
+	};
+
+	/** what a bot decided */
+	struct FDecision
+	{
+		AShooterCharacter* Enemy = nullptr;
+		bool bEnemyVisible = false;
+		bool bFire = false;
+		bool bNeedAmmo = false;
+	};
+
+	/** state of all thinking bots, one element per bot unless noted */
+	struct FBotBatch
+	{
+		TArray<TWeakObjectPtr<AShooterAIController>> Controllers;
+		TArray<FVector> EyeLocations;
+		TArray<FVector> AimDirections;
+		TArray<AShooterCharacter*> CurrentEnemies;
+		TArray<bool> WeaponReady;
+		TArray<float> AmmoRatios;
+
+		/** range of Candidates, nearest first */
+		TArray<int32> FirstCandidates;
+		TArray<int32> NumCandidates;
+
+		/** candidates of all bots */
+		TArray<FCandidate> Candidates;
+
+		TArray<FDecision> Decisions;
+
+		void Reset();
+	};
+
+	/** end of frame: thinks when the interval has passed */
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/** gathers bot state, decides for all bots and applies the decisions */
+	void Think(UWorld* World);
+
+	/** pure function of Batch data, safe to run in parallel for different bots */
+	void Decide(int32 BotIdx);
+
+	FBotBatch Batch;
+
+	float TimeUntilThink;
+
+	/** handle of OnWorldPostActorTick registration */
+	FDelegateHandle PostActorTickHandle;
+};
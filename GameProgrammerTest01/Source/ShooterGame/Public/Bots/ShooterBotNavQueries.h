@@ -0,0 +1,65 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ShooterServerWorldSubsystem.h"
+#include "ShooterBotNavQueries.generated.h"
+
+class UBehaviorTreeComponent;
+class UBTTaskNode;
+
+/** Node memory of the latent bot tasks that go through UShooterBotNavQueries */
+struct FShooterNavQueryTaskMemory
+{
+	/** queued query, 0 when none */
+	uint32 QueryId;
+
+	/** async pathfinding request issued by the query, 0 when none */
+	uint32 PathQueryId;
+
+	/** where the task wants to go */
+	FVector Goal;
+};
+
+/**
+ * Spreads bot navigation queries over frames.
+ *
+ * Bot tasks queue their navmesh queries here and go latent instead of running them right away, so a spawn wave of
+ * bots losing their enemy doesn't run them all in one frame. Queries run first in first out at the start of the
+ * frame, at most ShooterGame.BotNavQueryBudget per frame, and finish their task themselves.
+ */
+UCLASS()
+class UShooterBotNavQueries : public UShooterServerWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** returns the query queue of given world, exists on servers only */
+	static UShooterBotNavQueries* Get(const UWorld* World);
+
+	/** queues Query to run once the budget allows, it gets its own id. Returns that id */
+	uint32 QueueQuery(TFunction<void(uint32)>&& Query);
+
+	/** drops a query that hasn't run yet */
+	void CancelQuery(uint32 QueryId);
+
+	/** memory of Task in OwnerComp if the task is still running and waiting for QueryId, nullptr otherwise */
+	static FShooterNavQueryTaskMemory* GetTaskMemory(UBehaviorTreeComponent& OwnerComp, const UBTTaskNode* Task, uint32 QueryId);
+
+private:
+
+	/** start of frame: runs queued queries up to the budget */
+	void OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	TArray<TPair<uint32, TFunction<void(uint32)>>> QueuedQueries;
+
+	/** id of next query */
+	uint32 NextQueryId;
+
+	/** handle of OnWorldPreActorTick registration */
+	FDelegateHandle PreActorTickHandle;
+};
@@ -0,0 +1,95 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ShooterServerWorldSubsystem.h"
+#include "WorldCollision.h"
+#include "UObject/ObjectKey.h"
+#include "ShooterBotPerception.generated.h"
+
+/**
+ * Pawn to pawn line of sight shared by all bots.
+ *
+ * Bots used to trace for every LOS check (target selection, firing, behavior tree decorators), and the same viewer
+ * traced the same target several times per frame. Results are now cached per viewer and target: a pair is traced
+ * synchronously the first time it is asked about, after that the cached result is served and pairs older than
+ * ShooterGame.BotLOSCacheTTL are refreshed at the end of the frame with async traces, oldest first and at most
+ * ShooterGame.BotLOSTraceBudget per frame. Pairs nobody asked about for a while are dropped. First time traces are
+ * capped at ShooterGame.BotLOSSyncTraceBudget per frame, pairs over it aren't visible until their async trace is done.
+ *
+ * Visibility is traced from the viewer's eyes to the target's on the weapon channel, and the first blocking actor is
+ * kept. The target is visible if that is the target itself or, when any enemy will do, a pawn of another team.
+ */
+UCLASS()
+class UShooterBotPerception : public UShooterServerWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** returns the perception of given world, if the LOS cache is enabled */
+	static UShooterBotPerception* Get(const UWorld* World);
+
+	/** [server] whether Viewer can see Target. With bAnyEnemy, an enemy of Viewer in the way counts as well */
+	bool HasLineOfSight(const APawn* Viewer, const APawn* Target, bool bAnyEnemy);
+
+private:
+
+	/** cached trace from a viewer to a target */
+	struct FLineOfSight
+	{
+		TWeakObjectPtr<const APawn> Viewer;
+		TWeakObjectPtr<const APawn> Target;
+
+		/** first blocking actor on the way, if the trace hit one */
+		TWeakObjectPtr<const AActor> HitActor;
+		bool bBlockingHit = false;
+
+		/** async refresh in flight */
+		bool bTracePending = false;
+
+		/** world time of the trace HitActor comes from */
+		float TraceTime = 0.f;
+
+		/** world time it was last asked for */
+		float RequestTime = 0.f;
+	};
+
+	typedef TPair<FObjectKey, FObjectKey> FPairKey;
+
+	/** end of frame: issues async refreshes for the stalest pairs in use, drops unused pairs */
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/** async trace result for one pair */
+	void OnTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	void GetTraceParams(const APawn* Viewer, const APawn* Target, FVector& OutStart, FVector& OutEnd, FCollisionQueryParams& OutParams) const;
+
+	static void SetTraceResult(FLineOfSight& Entry, const FHitResult* Hit);
+
+	/** the original weapon LOS rule, see AShooterAIController::HasWeaponLOSToEnemy */
+	static bool IsVisible(const FLineOfSight& Entry, const APawn* Viewer, const APawn* Target, bool bAnyEnemy);
+
+	TMap<FPairKey, FLineOfSight> Cache;
+
+	/** pairs of async traces in flight, by trace id */
+	TMap<uint32, FPairKey> PendingTraces;
+
+	/** id of next async trace */
+	uint32 NextTraceId;
+
+	/** frame NumSyncTraces counts for */
+	uint64 SyncTraceFrame;
+
+	/** synchronous traces done in SyncTraceFrame */
+	int32 NumSyncTraces;
+
+	/** handle of OnWorldPostActorTick registration */
+	FDelegateHandle PostActorTickHandle;
+
+	/** bound once and shared by all async traces */
+	FTraceDelegate TraceDelegate;
+};
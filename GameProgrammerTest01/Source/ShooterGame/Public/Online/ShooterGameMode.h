@@ -8,9 +8,25 @@
 
 class AShooterAIController;
 class AShooterPlayerState;
-class AShooterPickup;
 class FUniqueNetId;
 
+/** Spawn point data cached by AShooterGameMode::CacheSpawnPoints */
+struct FShooterSpawnPoint
+{
+	TWeakObjectPtr<APlayerStart> PlayerStart;
+
+	FVector Location;
+
+	/** Team of an AShooterTeamStart, INDEX_NONE for other starts */
+	int32 SpawnTeam = INDEX_NONE;
+
+	bool bIsTeamStart = false;
+
+	bool bAllowPlayers = true;
+
+	bool bAllowBots = true;
+};
+
 UCLASS(config=Game)
 class AShooterGameMode : public AGameMode
 {
@@ -28,6 +44,9 @@ class AShooterGameMode : public AGameMode
 	/** Initialize the game. This is called before actors' PreInitializeComponents. */
 	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
 
+	/** stops watching streaming levels for spawn points */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/** Accept or reject a player attempting to join the server.  Fails login if you set the ErrorMessage to a non-empty string. */
 	virtual void PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage) override;
 
@@ -73,6 +92,18 @@ class AShooterGameMode : public AGameMode
 	/** hides the onscreen hud and restarts the map */
 	virtual void RestartGame() override;
 
+	/** keeps bot controllers through seamless travel too, their PlayerStates are kept with the players' */
+	virtual void GetSeamlessTravelActorList(bool bToTransition, TArray<AActor*>& ActorList) override;
+
+	/** unpossesses the bots' pawns when a seamless travel starts */
+	virtual void ProcessServerTravel(const FString& URL, bool bAbsolute = false) override;
+
+	/** starts waiting for the players still travelling from the previous match */
+	virtual void PostSeamlessTravel() override;
+
+	/** a player or bot arrived from the previous match */
+	virtual void HandleSeamlessTravelPlayer(AController*& C) override;
+
 	/** Creates AIControllers for all bots */
 	void CreateBotControllers();
 
@@ -122,6 +153,12 @@ protected:
 
 	bool bAllowBots;		
 
+	/** set after a seamless travel until every travelling player has arrived */
+	bool bWaitingForTravellingPlayers;
+
+	/** the match is playable once no player is still travelling to it */
+	void CheckTravellingPlayersArrived();
+
 	/** spawning all bots for this game */
 	void StartBots();
 
@@ -134,11 +171,74 @@ protected:
 	/** check if PlayerState is a winner */
 	virtual bool IsWinner(AShooterPlayerState* PlayerState) const;
 
+	/** nearest enemy beyond this distance doesn't make a spawn point any better */
+	UPROPERTY(config)
+	float SpawnSafeEnemyDistance;
+
+	/** deaths within this distance of a spawn point count against it */
+	UPROPERTY(config)
+	float SpawnRecentDeathRadius;
+
+	/** seconds a death counts against nearby spawn points */
+	UPROPERTY(config)
+	float SpawnRecentDeathTime;
+
+	/** score lost for a death right at the spawn point, relative to 1 for a safe enemy distance */
+	UPROPERTY(config)
+	float SpawnRecentDeathWeight;
+
+	/** random score added to each spawn point, so equally good ones are picked at random */
+	UPROPERTY(config)
+	float SpawnRandomWeight;
+
+	/** death location for spawn scoring */
+	struct FRecentDeath
+	{
+		FVector Location;
+		float Time;
+	};
+
+	/** capsule of the pawn class spawned for players or bots */
+	struct FSpawnCapsule
+	{
+		float Radius = 0.f;
+		float HalfHeight = 0.f;
+	};
+
+	/** all spawn points of the map, see CacheSpawnPoints */
+	TArray<FShooterSpawnPoint> SpawnPoints;
+
+	/** "Play from Here" start in PIE, always used when set */
+	TWeakObjectPtr<APlayerStart> PIEStart;
+
+	FSpawnCapsule PlayerSpawnCapsule;
+
+	FSpawnCapsule BotSpawnCapsule;
+
+	/** deaths in the last SpawnRecentDeathTime seconds, oldest first */
+	TArray<FRecentDeath> RecentDeaths;
+
+	/** set when a streaming level is added or removed, the spawn points are cached again on the next ChoosePlayerStart */
+	bool bSpawnPointsDirty;
+
+	FDelegateHandle LevelAddedHandle;
+
+	FDelegateHandle LevelRemovedHandle;
+
+	/** caches spawn points and the capsules of the spawned pawn classes */
+	void CacheSpawnPoints();
+
+	/** marks the spawn points dirty when a level of this world streams in or out */
+	void OnLevelChanged(ULevel* Level, UWorld* World);
+
 	/** check if player can use spawnpoint */
-	virtual bool IsSpawnpointAllowed(APlayerStart* SpawnPoint, AController* Player) const;
+	virtual bool IsSpawnpointAllowed(const FShooterSpawnPoint& SpawnPoint, AController* Player) const;
+
+	/** check if a pawn spawned at spawnpoint would overlap another one */
+	bool IsSpawnpointOccupied(const FShooterSpawnPoint& SpawnPoint, bool bForBot) const;
 
-	/** check if player should use spawnpoint */
-	virtual bool IsSpawnpointPreferred(APlayerStart* SpawnPoint, AController* Player) const;
+	/** how good spawnpoint is for player: far from enemies and away from recent deaths. Only compared between spawnpoints of one ChoosePlayerStart call */
+	virtual float ScoreSpawnpoint(const FShooterSpawnPoint& SpawnPoint, AController* Player, const struct FShooterPawnQueryFilter& EnemyFilter) const;
 
 	/** Returns game session class to use */
 	virtual TSubclassOf<AGameSession> GetGameSessionClass() const override;	
@@ -156,7 +256,4 @@ public:
 	/** get the name of the bots count option used in server travel URL */
 	static FString GetBotsCountOptionName();
 
-	UPROPERTY()
-	TArray<AShooterPickup*> LevelPickups;
-
 };
@@ -15,22 +15,34 @@ class AShooterGameState : public AGameState
 
 public:
 
-	/** number of teams in current game (doesn't deprecate when no players are left in a team) */
+	/** number of teams in current game (doesn't deprecate when no players are left in a team). Push based, change it with SetNumTeams() */
 	UPROPERTY(Transient, Replicated)
 	int32 NumTeams;
 
-	/** accumulated score per team */
+	/** accumulated score per team. Push based, change it with AddTeamScore() */
 	UPROPERTY(Transient, Replicated)
 	TArray<int32> TeamScores;
 
-	/** time left for warmup / match */
+	/** time left for warmup / match. Push based, change it with SetRemainingTime() */
 	UPROPERTY(Transient, Replicated)
 	int32 RemainingTime;
 
-	/** is timer paused? */
+	/** is timer paused? Push based, change it with SetTimerPaused() */
 	UPROPERTY(Transient, Replicated)
 	bool bTimerPaused;
 
+	/** [server] set number of teams */
+	void SetNumTeams(int32 InNumTeams);
+
+	/** [server] add points to team score, growing the score list if needed */
+	void AddTeamScore(int32 TeamIndex, int32 Points);
+
+	/** [server] set time left for warmup / match */
+	void SetRemainingTime(int32 InRemainingTime);
+
+	/** [server] pause or resume the match timer */
+	void SetTimerPaused(bool bInTimerPaused);
+
 	/** gets ranked PlayerState map for specific team */
 	void GetRankedMap(int32 TeamIndex, RankedPlayerMap& OutRankedMap) const;	
 
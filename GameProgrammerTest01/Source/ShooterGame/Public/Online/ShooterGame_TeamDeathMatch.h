@@ -39,7 +39,7 @@ protected:
 	virtual bool IsWinner(AShooterPlayerState* PlayerState) const override;
 
 	/** check team constraints */
-	virtual bool IsSpawnpointAllowed(APlayerStart* SpawnPoint, AController* Player) const;
+	virtual bool IsSpawnpointAllowed(const FShooterSpawnPoint& SpawnPoint, AController* Player) const override;
 
 	/** initialization for bot after spawning */
 	virtual void InitBot(AShooterAIController* AIC, int32 BotNum) override;	
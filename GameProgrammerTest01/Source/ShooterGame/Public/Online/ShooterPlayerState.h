@@ -4,6 +4,9 @@
 
 #include "ShooterPlayerState.generated.h"
 
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnShooterPlayerStateScoreChanged, AShooterPlayerState*);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnShooterPlayerStateTeamChanged, AShooterPlayerState*);
+
 UCLASS()
 class AShooterPlayerState : public APlayerState
 {
@@ -86,6 +89,13 @@ class AShooterPlayerState : public APlayerState
 	void SetMatchId(const FString& CurrentMatchId);
 
 	virtual void CopyProperties(class APlayerState* PlayerState) override;
+
+	/** Global notification when kills, deaths or score of a player change. Needed for replication graph. */
+	SHOOTERGAME_API static FOnShooterPlayerStateScoreChanged NotifyScoreChanged;
+
+	/** Global notification when a player changes team. Needed for replication graph. */
+	SHOOTERGAME_API static FOnShooterPlayerStateTeamChanged NotifyTeamChanged;
+
 protected:
 
 	/** Set the mesh colors based on the current teamnum variable */
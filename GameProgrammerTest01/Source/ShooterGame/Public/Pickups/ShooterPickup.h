@@ -20,6 +20,9 @@ protected:
 	/** initial setup */
 	virtual void BeginPlay() override;
 
+	/** leave the pickup registry */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
 	/** FX component */
 	UPROPERTY(VisibleDefaultsOnly, Category=Effects)
@@ -66,6 +69,9 @@ protected:
 	/** handle touches */
 	void PickupOnTouch(class AShooterCharacter* Pawn);
 
+	/** tell the pickup registry whether this can be picked up */
+	void UpdatePickupRegistry();
+
 	/** show and enable pickup */
 	virtual void RespawnPickup();
 
@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ShooterServerWorldSubsystem.h"
+#include "Pickups/ShooterPickup.h"
+#include "ShooterPickupRegistry.generated.h"
+
+/**
+ * Pickups of the level that can be picked up right now, grouped by pickup class.
+ *
+ * Pickups add themselves when they become active and remove themselves when taken or destroyed, so queries only see
+ * available pickups of the class they ask for and don't need to cast.
+ */
+UCLASS()
+class UShooterPickupRegistry : public UShooterServerWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	/** returns the registry of given world, exists on servers only */
+	static UShooterPickupRegistry* Get(const UWorld* World);
+
+	/** updates whether Pickup can be picked up */
+	void SetPickupAvailable(AShooterPickup* Pickup, bool bAvailable);
+
+	/** nearest available pickup of PickupType to Location that passes Filter */
+	template<typename PickupType>
+	PickupType* FindNearestAvailable(const FVector& Location, TFunctionRef<bool(PickupType*)> Filter) const
+	{
+		PickupType* BestPickup = nullptr;
+		float BestDistSq = MAX_FLT;
+
+		for (const TPair<const UClass*, TArray<TWeakObjectPtr<AShooterPickup>>>& Bucket : AvailablePickups)
+		{
+			if (!Bucket.Key->IsChildOf(PickupType::StaticClass()))
+			{
+				continue;
+			}
+
+			for (const TWeakObjectPtr<AShooterPickup>& WeakPickup : Bucket.Value)
+			{
+				PickupType* Pickup = static_cast<PickupType*>(WeakPickup.Get());
+				if (Pickup)
+				{
+					const float DistSq = (Pickup->GetActorLocation() - Location).SizeSquared();
+					if (DistSq < BestDistSq && Filter(Pickup))
+					{
+						BestDistSq = DistSq;
+						BestPickup = Pickup;
+					}
+				}
+			}
+		}
+
+		return BestPickup;
+	}
+
+private:
+
+	/** available pickups by their class */
+	TMap<const UClass*, TArray<TWeakObjectPtr<AShooterPickup>>> AvailablePickups;
+};
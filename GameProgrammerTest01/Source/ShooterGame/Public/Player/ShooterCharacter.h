@@ -40,6 +40,9 @@ class AShooterCharacter : public ACharacter
 	/** [client] called when replication is paused for this actor */
 	virtual void OnReplicationPausedChanged(bool bIsReplicationPaused) override;
 
+	/** [server] set by the replication graph while it culls this pawn with the map's PVS, which replaces the occlusion traces */
+	void SetReplicationCulledByPVS(bool bCulled) { bReplicationCulledByPVS = bCulled; }
+
 	/**
 	* Add camera pitch to first person mesh.
 	*
@@ -341,6 +344,9 @@ protected:
 	/** current firing state */
 	uint8 bWantsToFire : 1;
 
+	/** replication occlusion is handled by the replication graph's PVS node */
+	uint8 bReplicationCulledByPVS : 1;
+
 	/** when low health effects should start */
 	float LowHealthPercentage;
 
@@ -460,7 +466,7 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Health)
 	uint32 bIsDying : 1;
 
-	// Current health of the Pawn
+	// Current health of the Pawn. Push based: mark it dirty whenever it changes
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Replicated, Category = Health)
 	float Health;
 
@@ -0,0 +1,146 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ShooterServerWorldSubsystem.h"
+#include "ShooterPawnSpatialIndex.generated.h"
+
+/**
+ * Uniform grid over pawn locations in the XY plane. Entries are sorted by cell on Build, so a cell is a contiguous
+ * range of Entries. Entries added between builds are kept in a short unsorted list that every query scans.
+ */
+struct FShooterPawnGrid
+{
+	struct FEntry
+	{
+		TWeakObjectPtr<APawn> Pawn;
+		FVector Location;
+		int32 TeamNum = INDEX_NONE;
+		FIntPoint Cell;
+	};
+
+	explicit FShooterPawnGrid(float InCellSize = 2500.f);
+
+	/** Replaces all entries, InEntries is consumed */
+	void Build(TArray<FEntry>& InEntries, float InCellSize);
+
+	/** Adds an entry that queries see until the next Build */
+	void Add(const FEntry& Entry);
+
+	/** Changes the team of Pawn's entry, if it has one */
+	void SetTeamNum(const APawn* Pawn, int32 TeamNum);
+
+	void Reset();
+
+	/** Entries within Radius of Origin that pass Filter, unsorted */
+	void FindInRadius(const FVector& Origin, float Radius, TFunctionRef<bool(const FEntry&)> Filter, TArray<const FEntry*>& OutEntries) const;
+
+	/** Up to MaxResults entries within MaxRadius of Origin that pass Filter, closest first */
+	void FindNearest(const FVector& Origin, int32 MaxResults, float MaxRadius, TFunctionRef<bool(const FEntry&)> Filter, TArray<const FEntry*>& OutEntries) const;
+
+	int32 Num() const { return Entries.Num() + AddedEntries.Num(); }
+
+private:
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	struct FCellRange
+	{
+		int32 Start;
+		int32 Num;
+	};
+
+	float CellSize;
+
+	/** Sorted by cell */
+	TArray<FEntry> Entries;
+
+	TMap<FIntPoint, FCellRange> Cells;
+
+	/** Bounds of occupied cells */
+	FIntPoint MinCell;
+	FIntPoint MaxCell;
+
+	TArray<FEntry> AddedEntries;
+};
+
+/** Filter for UShooterPawnSpatialIndex queries */
+struct FShooterPawnQueryFilter
+{
+	/** Only pawns of this class */
+	TSubclassOf<APawn> PawnClass;
+
+	/** Only pawns of this team, INDEX_NONE for any */
+	int32 TeamNum = INDEX_NONE;
+
+	/** Skip pawns of this team, INDEX_NONE to skip none */
+	int32 ExcludeTeamNum = INDEX_NONE;
+
+	const APawn* IgnorePawn = nullptr;
+
+	/** Skip dead AShooterCharacters */
+	bool bAliveOnly = false;
+
+	/** Living AShooterCharacters that may be enemies of Controller: everyone else, or other teams in team games */
+	static FShooterPawnQueryFilter MakeEnemyFilter(const AController* Controller);
+};
+
+/**
+ * Spatial index of the world's pawns for proximity queries (bot targeting, spawn point checks, explosion victims),
+ * so they don't have to iterate every pawn.
+ *
+ * The grid is rebuilt once per frame before actors tick, with the locations pawns ended the previous frame at. Pawns
+ * spawned during the frame are added right away. Queries compare against those indexed locations, callers that need
+ * exact results pad their query radius and test the live location of what comes back.
+ */
+UCLASS()
+class UShooterPawnSpatialIndex : public UShooterServerWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** returns the index of given world, exists on servers only */
+	static UShooterPawnSpatialIndex* Get(const UWorld* World);
+
+	/** Pawns within Radius of Origin, unsorted */
+	void FindPawnsInRadius(const FVector& Origin, float Radius, const FShooterPawnQueryFilter& Filter, TArray<APawn*>& OutPawns) const;
+
+	/** Up to MaxResults pawns within MaxRadius of Origin, closest first */
+	void FindNearestPawns(const FVector& Origin, int32 MaxResults, const FShooterPawnQueryFilter& Filter, TArray<APawn*>& OutPawns, float MaxRadius = MAX_FLT) const;
+
+	/** Largest collision cylinder of the indexed pawns, to pad queries that are tested against pawn extents */
+	float GetMaxPawnRadius() const { return MaxPawnRadius; }
+	float GetMaxPawnHalfHeight() const { return MaxPawnHalfHeight; }
+
+	/** picks up the team of a pawn that was indexed before it got its PlayerState */
+	void OnPawnPossessed(APawn* Pawn);
+
+private:
+
+	/** rebuilds the grid from all pawns of the world */
+	void OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/** adds pawns spawned since the last rebuild */
+	void OnActorSpawned(AActor* Actor);
+
+	/** fills in grid entry for pawn and grows the max pawn extents */
+	void MakeEntry(APawn* Pawn, FShooterPawnGrid::FEntry& OutEntry);
+
+	bool PassesFilter(const FShooterPawnGrid::FEntry& Entry, const FShooterPawnQueryFilter& Filter) const;
+
+	FShooterPawnGrid Grid;
+
+	float MaxPawnRadius;
+
+	float MaxPawnHalfHeight;
+
+	/** handle of OnWorldPreActorTick registration */
+	FDelegateHandle PreActorTickHandle;
+
+	/** handle of the world's actor spawned registration */
+	FDelegateHandle ActorSpawnedHandle;
+};
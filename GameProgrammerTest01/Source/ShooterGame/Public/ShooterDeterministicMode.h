@@ -0,0 +1,52 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+
+class APlayerState;
+class UWorld;
+
+/**
+ * Reproducible bot matches for benchmarks, enabled with -ShooterSeed=N on a dedicated server, for example
+ * ShooterServer /Game/Maps/Highrise?game=FFA?bots=8 -ShooterSeed=42 (the server doesn't render or play audio).
+ *
+ * Every match then runs with a fixed timestep of 1 / -ShooterSimFPS (default 30) seconds, as fast as the CPU allows.
+ * Gameplay randomness (weapon spread, spawn and team choice) comes from one stream reseeded with N at the start of
+ * each match, and engine randomness (navmesh random points, behavior tree waits) from FMath, seeded the same way.
+ * The pickup search (BTTask_FindPickup) finds its path synchronously, as async path results land on a frame that
+ * depends on worker thread timing. Other bot nav queries are synchronous anyway, and async line traces (bot LOS,
+ * explosions) always complete by the next frame. Kills are logged with their game time, so two runs with the same
+ * seed can be diffed.
+ */
+class FShooterDeterministicMode
+{
+public:
+
+	/** reads the command line, called at module startup */
+	static void Initialize();
+
+	static bool IsEnabled() { return bEnabled; }
+
+	/** applies the fixed timestep and reseeds, called when a match is set up */
+	static void BeginMatch();
+
+	/** gameplay random numbers, seeded in deterministic mode */
+	static int32 Rand();
+	static float FRand();
+	static int32 RandHelper(int32 Max);
+
+	/** logs a kill in deterministic mode */
+	static void LogKill(const UWorld* World, const APlayerState* Killer, const APlayerState* Victim);
+
+private:
+
+	static bool bEnabled;
+
+	static int32 Seed;
+
+	static float SimFPS;
+
+	static FRandomStream Stream;
+};
@@ -8,6 +8,7 @@
 #include "ParticleDefinitions.h"
 #include "SoundDefinitions.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 #include "ShooterGameMode.h"
 #include "ShooterGameState.h"
 #include "ShooterCharacter.h"
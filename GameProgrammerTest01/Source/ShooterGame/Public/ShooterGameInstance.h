@@ -118,6 +118,12 @@ public:
 	/** Begin a hosted quick match */
 	void BeginHostingQuickMatch();
 
+	/** Starts loading a map package in the background, so travelling to it finds it loaded. Replaces the previous preload. */
+	void PreloadMap(const FString& MapPackageName);
+
+	/** Drops the preloaded map, garbage collection frees it unless the current world uses it */
+	void ReleasePreloadedMap();
+
 	/** Initiates the session searching */
 	bool FindSessions(ULocalPlayer* PlayerOwner, bool bIsDedicatedServer, bool bLANMatch);
 
@@ -133,6 +139,9 @@ public:
 	/** Gets the current state of the GameInstance */
 	const FName GetCurrentState() const;
 
+	/** Platform time the main menu state last began */
+	double GetMainMenuStateStartTime() const { return MainMenuStateStartTime; }
+
 	/**
 	* Creates the message menu, clears other menus and sets the KingState to Message.
 	*
@@ -233,6 +242,38 @@ private:
 	/** If true, enable splitscreen when map starts loading */
 	bool bPendingEnableSplitscreen;
 
+	/** Platform time the main menu state last began */
+	double MainMenuStateStartTime;
+
+	/** Map loaded ahead of travel, kept alive until a map load picks it up */
+	UPROPERTY()
+	UWorld* PreloadedMapWorld;
+
+	/** Package name of the map asked to preload, empty when none */
+	FString PreloadMapName;
+
+	/** Platform time the preload started, 0 when it didn't */
+	double PreloadStartTime;
+
+	/** Whether the map asked to preload was already in memory, so loading it is no baseline for the time saved */
+	bool bPreloadMapAlreadyLoaded;
+
+	/** Map being loaded, and whether it was preloaded or already in memory */
+	FString LoadingMapName;
+	bool bLoadingPreloadedMap;
+	bool bLoadingAlreadyLoadedMap;
+	double MapLoadStartTime;
+
+	/** Last load time of each map without preloading, to report the time saved */
+	TMap<FString, double> MapLoadMsWithoutPreload;
+
+	/** Whether the map load in progress is a seamless travel */
+	bool bSeamlessTravelling;
+
+	/** Assets of a map that seamless travel restarts, kept loaded through the transition */
+	UPROPERTY()
+	TArray<UObject*> SeamlessTravelAssets;
+
 	/** Whether the user has an active license to play the game */
 	bool bIsLicensed;
 
@@ -282,6 +323,15 @@ private:
 	
 	void OnPreLoadMap(const FString& MapName);
 	void OnPostLoadMap(UWorld*);
+	void OnMapPreloaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result);
+	void OnSeamlessTravelStart(UWorld* World, const FString& MapName);
+
+	/** Disk size of a package and its hard dependencies that aren't in memory yet, INDEX_NONE if the asset registry doesn't know the package's size */
+	static int64 GetUnloadedPackageSize(FName PackageName);
+
+	/** Loaded assets of a package's hard dependencies, other than maps */
+	static void GetLoadedDependencyAssets(FName PackageName, TArray<UObject*>& OutAssets);
+
 	void OnPostDemoPlay();
 
 	virtual void HandleDemoPlaybackFailure( EDemoPlayFailure::Type FailureType, const FString& ErrorString ) override;
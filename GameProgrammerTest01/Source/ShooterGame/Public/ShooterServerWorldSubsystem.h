@@ -0,0 +1,20 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterServerWorldSubsystem.generated.h"
+
+/**
+ * Base of world subsystems that only serve server side gameplay (bots, spawning, damage, pickups).
+ * They are created for game worlds of servers and standalone games, never for clients or editor worlds.
+ */
+UCLASS(Abstract)
+class UShooterServerWorldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+};
@@ -0,0 +1,57 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Times the phases between process start, or a travel, and the game being playable.
+ *
+ * The cold start report runs from process start until the menu takes input or a pawn is possessed on clients, or the first
+ * loaded map on dedicated servers. Every later travel starts a travel report that runs until the next possessed pawn
+ * frame (client) or until the map is loaded (server). Travel from the menu starts it when the loading screen comes up,
+ * before the map to load is known, so it covers session work too. A seamless travel between matches starts its report on the
+ * last frame of the match, and on servers it runs until every travelling player has arrived. Reports go to the log as
+ * a table and are appended to ShooterStartupTiming.csv in the profiling directory.
+ */
+class FShooterStartupTimer
+{
+public:
+
+	/** starts a timed phase of the current report */
+	static void BeginPhase(const FString& Name);
+
+	/** ends the most recent phase called Name */
+	static void EndPhase(const FString& Name);
+
+	/** adds a phase that was timed elsewhere */
+	static void AddPhase(const FString& Name, double StartTime, double EndTime);
+
+	/** a travel starts, this begins a travel report unless one is running. MapName may be empty if it isn't known yet */
+	static void BeginTravel(const FString& MapName);
+
+	/** the game is playable, ends the current report */
+	static void Playable(const TCHAR* What);
+
+private:
+
+	struct FPhase
+	{
+		FString Name;
+		double StartTime;
+		double EndTime;
+	};
+
+	/** writes the current report and clears it */
+	static void WriteReport(const TCHAR* What);
+
+	static TArray<FPhase> Phases;
+
+	/** name of the current report, empty when none is running */
+	static FString ReportName;
+
+	/** the current report is a travel report that doesn't have its map name yet */
+	static bool bTravelMapPending;
+
+	static double ReportStartTime;
+};
@@ -14,6 +14,34 @@
 #define LOGIN_REQUIRED_FOR_ONLINE_PLAY 0
 #endif
 
+/**
+ * Times a net driver's work of each frame: tick dispatch (receive), and optionally tick flush (send), each including
+ * the driver's post tick handler. Binds raw delegates to itself, removed again when it is destroyed.
+ */
+struct FShooterNetDriverTickTimer
+{
+	~FShooterNetDriverTickTimer();
+
+	void Register(UWorld* InWorld, UNetDriver* NetDriver, bool bIncludeFlush);
+	void Unregister();
+
+	/** time measured since the last call */
+	double ConsumeSeconds();
+
+private:
+	void OnStart(float DeltaSeconds);
+	void OnEnd();
+
+	TWeakObjectPtr<UWorld> World;
+	FDelegateHandle TickDispatchHandle;
+	FDelegateHandle PostTickDispatchHandle;
+	FDelegateHandle TickFlushHandle;
+	FDelegateHandle PostTickFlushHandle;
+
+	double StartTime = 0.0;
+	double Seconds = 0.0;
+};
+
 UCLASS()
 class UShooterTestControllerBase : public UGauntletTestController, public TSharedFromThis<UShooterTestControllerBase>
 {
@@ -74,4 +102,11 @@ protected:
 	virtual AShooterGameSession* GetGameSession() const;
 	virtual bool IsInGame() const;
 	virtual ULocalPlayer* GetFirstLocalPlayer() const;
+
+	// Perf Sampling
+	/** game thread time of the last frame in ms: frame time minus the time spent idle waiting for the next frame */
+	static float GetGameThreadFrameMs();
+
+	/** sample at Fraction (0-1) of SortedSamples, 0 if there are none */
+	static float GetPercentile(const TArray<float>& SortedSamples, float Fraction);
 };
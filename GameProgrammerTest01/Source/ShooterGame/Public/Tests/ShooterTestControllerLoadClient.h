@@ -0,0 +1,45 @@
+// Copyright Epic Games, Inc.All Rights Reserved.
+#pragma once
+
+#include "Tests/ShooterTestControllerBase.h"
+#include "ShooterTestControllerLoadClient.generated.h"
+
+class AShooterCharacter;
+
+/**
+ * Headless client of the network load test, the server runs UShooterTestControllerLoadServer.
+ *
+ * Launched with the server address as its map (ShooterClient 127.0.0.1 -nullrhi ...), so it connects directly without
+ * online services. While it has a pawn it strafes in circles, fires in bursts and jetpacks now and then, each client
+ * out of phase with the others. Ends after LoadClientDuration seconds in game.
+ */
+UCLASS()
+class UShooterTestControllerLoadClient : public UShooterTestControllerBase
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnInit() override;
+	virtual void OnPostMapChange(UWorld* World) override;
+
+protected:
+	virtual void OnTick(float TimeDelta) override;
+
+private:
+	/** settings, from the command line */
+	float Duration;
+	float Timeout;
+
+	/** time in game */
+	float GameTime;
+
+	/** offsets this client's script from the others */
+	float Phase;
+
+	/** pawn being driven and what it's doing */
+	TWeakObjectPtr<AShooterCharacter> DrivenPawn;
+	uint8 bFiring : 1;
+	uint8 bJetpacking : 1;
+
+	void DrivePawn(AShooterCharacter* Pawn, float TimeDelta);
+};
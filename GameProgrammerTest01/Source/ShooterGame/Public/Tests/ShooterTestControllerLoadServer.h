@@ -0,0 +1,64 @@
+// Copyright Epic Games, Inc.All Rights Reserved.
+#pragma once
+
+#include "Tests/ShooterTestControllerBase.h"
+#include "ShooterTestControllerLoadServer.generated.h"
+
+/**
+ * Dedicated server side of the network load test, clients run UShooterTestControllerLoadClient.
+ *
+ * Waits for the connection counts in LoadSteps (default 16,32,64,100) one after another. At each it lets LoadSettle
+ * seconds pass, then measures for LoadStepDuration seconds: server tick time, replication graph time per frame,
+ * outgoing bandwidth per connection and the share of connection frames spent saturated. Each step is logged and
+ * written to ShooterLoadTest.csv in the profiling directory. The test ends after the last step, or fails if a step
+ * isn't reached within LoadStepTimeout seconds.
+ *
+ * To compare replication settings, run it once per setting and diff the CSVs, e.g. push model off and on with
+ * -ini:Engine:[SystemSettings]:net.IsPushModelEnabled=0 and =1 on the ShooterServer command line.
+ */
+UCLASS()
+class UShooterTestControllerLoadServer : public UShooterTestControllerBase
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnInit() override;
+	virtual void OnPostMapChange(UWorld* World) override;
+
+protected:
+	virtual void OnTick(float TimeDelta) override;
+
+private:
+	/** settings, from the command line */
+	TArray<int32> Steps;
+	float SettleTime;
+	float StepDuration;
+	float StepTimeout;
+
+	/** step being waited for or measured */
+	int32 StepIdx;
+	float StepTime;
+	uint8 bMeasuring : 1;
+
+	/** measurements of the current step */
+	TArray<float> TickMs;
+	uint64 StartRepGraphCycles;
+	int32 NumFrames;
+	int64 OutBytesPerSecondSum;
+	int32 MaxOutBytesPerSecond;
+	int32 NumConnectionFrames;
+	int32 NumSaturatedConnectionFrames;
+
+	/** results of all steps, CSV lines */
+	TArray<FString> Results;
+
+	int32 GetNumConnections() const;
+
+	/** replication graph time of the world's net driver, see FShooterRepGraphProfiler */
+	uint64 GetRepGraphCycles() const;
+
+	void StartStep();
+	void SampleFrame();
+	void FinishStep();
+	void WriteResults() const;
+};
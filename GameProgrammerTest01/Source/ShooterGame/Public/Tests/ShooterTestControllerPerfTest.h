@@ -0,0 +1,59 @@
+// Copyright Epic Games, Inc.All Rights Reserved.
+#pragma once
+
+#include "Tests/ShooterTestControllerBase.h"
+#include "ShooterTestControllerPerfTest.generated.h"
+
+/**
+ * Performance test for a dedicated server with bots and a client joined to it, run with the same controller on both.
+ *
+ * Once the match is in progress it waits PerfWarmup seconds, then samples every frame for PerfDuration seconds while
+ * the CSV profiler captures. It logs p50/p95/p99 of game thread time (frame time minus idle time), net tick time
+ * (net driver tick dispatch and flush) and used physical memory, then fails if any budget given on the command line
+ * is exceeded: GameThreadP95BudgetMs, GameThreadP99BudgetMs, NetTickP95BudgetMs and MemoryBudgetMB (checked against
+ * p99, 0 or missing: not checked).
+ */
+UCLASS()
+class UShooterTestControllerPerfTest : public UShooterTestControllerBase
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnInit() override;
+	virtual void OnPostMapChange(UWorld* World) override;
+
+protected:
+	virtual void OnTick(float TimeDelta) override;
+
+private:
+	/** settings, from the command line */
+	float WarmupTime;
+	float CaptureTime;
+	float Timeout;
+	float GameThreadP95BudgetMs;
+	float GameThreadP99BudgetMs;
+	float NetTickP95BudgetMs;
+	float MemoryBudgetMB;
+
+	/** time the match has been in progress, or spent capturing */
+	float MatchTime;
+
+	uint8 bCapturing : 1;
+
+	/** one element per captured frame */
+	TArray<float> GameThreadMs;
+	TArray<float> NetTickMs;
+	TArray<float> MemoryMB;
+
+	/** net driver time of the current frame */
+	FShooterNetDriverTickTimer NetTickTimer;
+
+	bool IsMatchInProgress() const;
+
+	void StartCapture();
+	void SampleFrame(float TimeDelta);
+	void FinishCapture();
+
+	/** logs p50/p95/p99 of Samples, returns false if its p95 or p99 is over a non-zero budget */
+	static bool ReportMetric(const TCHAR* Name, TArray<float>& Samples, float P95Budget, float P99Budget);
+};
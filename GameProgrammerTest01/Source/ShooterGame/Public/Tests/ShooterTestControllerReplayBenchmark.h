@@ -0,0 +1,63 @@
+// Copyright Epic Games, Inc.All Rights Reserved.
+#pragma once
+
+#include "Tests/ShooterTestControllerBase.h"
+#include "Async/Future.h"
+#include "ShooterTestControllerReplayBenchmark.generated.h"
+
+/**
+ * Client CPU benchmark that plays back a recorded match, with the same controller recording it.
+ *
+ * Recording, on a dedicated server: ShooterServer /Game/Maps/Highrise?game=FFA?bots=32 -ShooterSeed=42
+ * -gauntlet=ShooterTestControllerReplayBenchmark records the first match (RoundTime, 5 minutes) as ReplayName
+ * (default ShooterBenchmark) and ends the test when the match ends.
+ *
+ * Playback, on a client: ShooterClient -nullrhi -nosound -gauntlet=ShooterTestControllerReplayBenchmark plays
+ * ReplayName at a fixed timestep of 1 / ReplayBenchmarkFPS (default 30) seconds, as fast as the CPU allows, under a
+ * CSV profiler capture that also gets a per frame replay receive time. At the end it writes
+ * ShooterReplayBenchmark.csv to the profiling directory with p50/p95/p99 of game thread, replay receive (demo net
+ * driver tick dispatch) and animation time (from the capture's exclusive Animation column).
+ */
+UCLASS()
+class UShooterTestControllerReplayBenchmark : public UShooterTestControllerBase
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnInit() override;
+	virtual void OnPostMapChange(UWorld* World) override;
+
+protected:
+	virtual void OnTick(float TimeDelta) override;
+
+private:
+	/** settings, from the command line */
+	FString ReplayName;
+	float BenchmarkFPS;
+	float Timeout;
+
+	uint8 bStarted : 1;
+	uint8 bCapturing : 1;
+	uint8 bWaitingForCaptureFile : 1;
+
+	/** name of the CSV profiler capture file, set once it is written */
+	TSharedFuture<FString> CaptureFile;
+
+	/** one element per played back frame */
+	TArray<float> GameThreadMs;
+	TArray<float> ReplayReceiveMs;
+
+	/** replay receive time of the current frame */
+	FShooterNetDriverTickTimer ReceiveTimer;
+
+	void TickRecording();
+	void TickPlayback();
+
+	void StartCapture();
+	void SampleFrame();
+	void FinishCapture();
+	void WriteResults(const FString& CaptureFilename);
+
+	/** samples of the capture column named Column, from a CSV profiler file */
+	static TArray<float> ReadCsvProfileColumn(const FString& Filename, const FString& Column);
+};
@@ -0,0 +1,97 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ShooterServerWorldSubsystem.h"
+#include "WorldCollision.h"
+#include "ShooterExplosionResolver.generated.h"
+
+class UDamageType;
+
+/**
+ * Resolves radial damage for every explosion queued during a frame in one pass.
+ *
+ * Replaces per-explosion UGameplayStatics::ApplyRadialDamage calls: instead of a synchronous visibility trace per
+ * victim component, candidate pawns for all pending explosions come from UShooterPawnSpatialIndex, other damageable
+ * actors (props, simulating physics bodies) from the same sphere overlap ApplyRadialDamage does, occlusion traces are
+ * issued as a single async batch, and damage is applied through the regular TakeDamage path (and thus
+ * AShooterGameMode::ModifyDamage/CanDealDamage) once the batch completes. Damage falloff and the physics impulse are
+ * applied by AActor::InternalTakeRadialDamage exactly as before.
+ */
+UCLASS()
+class UShooterExplosionResolver : public UShooterServerWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * [server] queue radial damage to be resolved at the end of this frame
+	 *
+	 * @param BaseDamage		Damage at the explosion origin.
+	 * @param Origin			Explosion origin.
+	 * @param Radius			Outer radius of the explosion, damage falls off linearly to zero.
+	 * @param DamageTypeClass	Class of damage to apply.
+	 * @param DamageCauser		Actor that caused the explosion; ignored by the queries.
+	 * @param InstigatedBy		Controller credited with the damage.
+	 */
+	void QueueRadialDamage(float BaseDamage, const FVector& Origin, float Radius, TSubclassOf<UDamageType> DamageTypeClass, AActor* DamageCauser, AController* InstigatedBy);
+
+	/** returns the resolver of given world, if batching is enabled */
+	static UShooterExplosionResolver* Get(const UWorld* World);
+
+private:
+
+	/** explosion waiting to be resolved */
+	struct FPendingExplosion
+	{
+		FVector Origin;
+		float BaseDamage;
+		float Radius;
+		TSubclassOf<UDamageType> DamageTypeClass;
+		TWeakObjectPtr<AActor> DamageCauser;
+		TWeakObjectPtr<AController> InstigatedBy;
+	};
+
+	/** occlusion test from explosion origin to a single victim component */
+	struct FOcclusionTest
+	{
+		int32 ExplosionIndex;
+		TWeakObjectPtr<AActor> Victim;
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		FHitResult Hit;
+		bool bVisible;
+	};
+
+	/** all explosions from one frame, plus their in-flight occlusion traces */
+	struct FExplosionBatch
+	{
+		TArray<FPendingExplosion> Explosions;
+		TArray<FOcclusionTest> Tests;
+		int32 NumPendingTraces;
+	};
+
+	/** end of frame: gathers victims and issues occlusion traces for queued explosions */
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/** async trace result for one occlusion test */
+	void OnOcclusionTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum, uint32 BatchId);
+
+	/** applies damage for a batch whose traces all completed */
+	void ApplyBatchDamage(FExplosionBatch& Batch);
+
+	/** explosions queued this frame */
+	TArray<FPendingExplosion> QueuedExplosions;
+
+	/** batches waiting for trace results */
+	TMap<uint32, FExplosionBatch> PendingBatches;
+
+	/** id of next batch */
+	uint32 NextBatchId;
+
+	/** handle of OnWorldPostActorTick registration */
+	FDelegateHandle PostActorTickHandle;
+};
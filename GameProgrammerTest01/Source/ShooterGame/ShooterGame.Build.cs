@@ -47,6 +47,7 @@ public class ShooterGame : ModuleRules
 				"Json",
 				"ApplicationCore",
 				"ReplicationGraph",
+				"NetCore",
 				"PakFile",
 				"RHI",
 				"PhysicsCore",
@@ -78,6 +78,8 @@ class FShooterGameLoadingScreenModule : public IShooterGameLoadingScreenModule
 public:
 	virtual void StartupModule() override
 	{		
+		StartupStartTime = FPlatformTime::Seconds();
+
 		// Load for cooker reference
 		LoadObject<UObject>(NULL, TEXT("/Game/UI/Menu/LoadingScreen.LoadingScreen") );
 
@@ -94,6 +96,8 @@ public:
 			GetMoviePlayer()->SetupLoadingScreen(LoadingScreen);
 		}
 		*/
+
+		StartupEndTime = FPlatformTime::Seconds();
 	}
 	
 	virtual bool IsGameModule() const override
@@ -109,6 +113,16 @@ public:
 
 		GetMoviePlayer()->SetupLoadingScreen(LoadingScreen);
 	}
+
+	virtual void GetStartupTimes(double& OutStartTime, double& OutEndTime) const override
+	{
+		OutStartTime = StartupStartTime;
+		OutEndTime = StartupEndTime;
+	}
+
+private:
+	double StartupStartTime = 0.0;
+	double StartupEndTime = 0.0;
 };
 
 IMPLEMENT_GAME_MODULE(FShooterGameLoadingScreenModule, ShooterGameLoadingScreen);
@@ -12,6 +12,9 @@ class IShooterGameLoadingScreenModule : public IModuleInterface
 public:
 	/** Kicks off the loading screen for in game loading (not startup) */
 	virtual void StartInGameLoadingScreen() = 0;
+
+	/** Platform time at the start and end of this module's startup */
+	virtual void GetStartupTimes(double& OutStartTime, double& OutEndTime) const = 0;
 };
 
 #endif // __SHOOTERGAMELOADINGSCREEN_H__
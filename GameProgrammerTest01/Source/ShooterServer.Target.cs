@@ -11,6 +11,11 @@ public class ShooterServerTarget : TargetRules
 		Type = TargetType.Server;
 		bUsesSteam = true;
 
+		// Replicated ShooterGame properties are push based, only compare them after they've been marked dirty.
+		// This changes engine modules too, so the server can't share the installed engine's build environment
+		bWithPushModel = true;
+		BuildEnvironment = TargetBuildEnvironment.Unique;
+
 		ExtraModuleNames.Add("ShooterGame");
 	}
 }